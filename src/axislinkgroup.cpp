@@ -0,0 +1,161 @@
+/*
+ * CuteCharts - Linked axes across charts
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QValueAxis>
+
+#include <QtCore/QTimer>
+
+#include "chartview.h"
+
+#include "axislinkgroup.h"
+
+AxisLinkGroup::AxisLinkGroup(Axes axes, QObject* parent)
+    : QObject(parent)
+    , m_axes(axes)
+{
+    // Bursts of range changes during a drag end up in one update per frame
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(16);
+    connect(m_timer, &QTimer::timeout, this, &AxisLinkGroup::propagate);
+}
+
+void AxisLinkGroup::addView(ChartView* view, const Transform& transform)
+{
+    if (!view)
+        return;
+    if (m_axes.testFlag(X))
+        addAxis(view->axisX(), Qt::Horizontal, transform);
+    if (m_axes.testFlag(Y))
+        addAxis(view->axisY(), Qt::Vertical, transform);
+    connect(view, &ChartView::axisReplaced, this, &AxisLinkGroup::memberReplaced, Qt::UniqueConnection);
+}
+
+void AxisLinkGroup::removeView(ChartView* view)
+{
+    if (!view)
+        return;
+    disconnect(view, &ChartView::axisReplaced, this, &AxisLinkGroup::memberReplaced);
+    removeAxis(view->axisX());
+    removeAxis(view->axisY());
+}
+
+void AxisLinkGroup::addAxis(QValueAxis* axis, Qt::Orientation orientation, const Transform& transform)
+{
+    if (!axis || qFuzzyIsNull(transform.scale))
+        return;
+    for (const Member& member : qAsConst(m_members)) {
+        if (member.axis == axis)
+            return;
+    }
+
+    m_members.append(Member{ axis, orientation, transform });
+    connect(axis, &QValueAxis::rangeChanged, this, [this, axis](qreal min, qreal max) {
+        memberRangeChanged(axis, min, max);
+    });
+    connect(axis, &QObject::destroyed, this, [this, axis]() {
+        removeAxis(axis);
+    });
+}
+
+void AxisLinkGroup::removeAxis(QValueAxis* axis)
+{
+    if (!axis)
+        return;
+    for (int i = m_members.size() - 1; i >= 0; --i) {
+        // A destroyed axis has already dropped out of its QPointer
+        if (m_members[i].axis == axis || !m_members[i].axis)
+            m_members.removeAt(i);
+    }
+    disconnect(axis, nullptr, this, nullptr);
+    if (m_pending_x.source == axis)
+        m_pending_x.source = nullptr;
+    if (m_pending_y.source == axis)
+        m_pending_y.source = nullptr;
+}
+
+void AxisLinkGroup::memberReplaced(Qt::Orientation orientation, QValueAxis* previous, QValueAxis* replacement)
+{
+    Q_UNUSED(orientation)
+    for (const Member& member : qAsConst(m_members)) {
+        if (member.axis != previous)
+            continue;
+        const Member linked = member;
+        removeAxis(previous);
+        addAxis(replacement, linked.orientation, linked.transform);
+        return;
+    }
+}
+
+void AxisLinkGroup::setRange(Qt::Orientation orientation, qreal min, qreal max)
+{
+    Pending& next = pending(orientation);
+    next.active = true;
+    next.source = nullptr;
+    next.min = min;
+    next.max = max;
+    propagate();
+}
+
+void AxisLinkGroup::memberRangeChanged(QValueAxis* axis, qreal min, qreal max)
+{
+    // Ranges set by propagate() itself must not travel around the group again
+    if (m_applying)
+        return;
+
+    for (const Member& member : qAsConst(m_members)) {
+        if (member.axis != axis)
+            continue;
+        Pending& next = pending(member.orientation);
+        next.active = true;
+        next.source = axis;
+        next.min = (min - member.transform.offset) / member.transform.scale;
+        next.max = (max - member.transform.offset) / member.transform.scale;
+        if (!m_timer->isActive())
+            m_timer->start();
+        return;
+    }
+}
+
+void AxisLinkGroup::propagate()
+{
+    m_timer->stop();
+    m_applying = true;
+    for (Qt::Orientation orientation : { Qt::Horizontal, Qt::Vertical }) {
+        Pending& next = pending(orientation);
+        if (!next.active)
+            continue;
+        next.active = false;
+
+        for (const Member& member : qAsConst(m_members)) {
+            if (!member.axis || member.orientation != orientation || member.axis == next.source)
+                continue;
+            qreal min = next.min * member.transform.scale + member.transform.offset;
+            qreal max = next.max * member.transform.scale + member.transform.offset;
+            if (min > max)
+                qSwap(min, max);
+            // The axis keeps its extent, unchanged members cost nothing
+            if (qFuzzyCompare(member.axis->min(), min) && qFuzzyCompare(member.axis->max(), max))
+                continue;
+            member.axis->setRange(min, max);
+        }
+        emit rangeChanged(orientation, next.min, next.max);
+    }
+    m_applying = false;
+}
@@ -0,0 +1,131 @@
+/*
+ * CuteCharts - Linked axes across charts
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+
+class QTimer;
+class QValueAxis;
+
+class ChartView;
+
+/**
+ * @brief Keeps the ranges of value axes in several charts in step
+ *
+ * Members are single axes, addView() adds the x and/or y axis of a ChartView
+ * and follows the view when it replaces them for an axis transform.
+ * A range change of one member is converted into group coordinates through
+ * the member transform and applied to all other members of the same
+ * orientation. Changes are coalesced and propagated at most once per frame,
+ * members already showing the target range are skipped and the ranges set
+ * by the group itself are not propagated again.
+ */
+class AxisLinkGroup : public QObject {
+    Q_OBJECT
+
+public:
+    enum Axis {
+        X = 1,
+        Y = 2,
+        Both = X | Y
+    };
+    Q_DECLARE_FLAGS(Axes, Axis)
+
+    /**
+     * @brief Maps group coordinates to member coordinates: value * scale + offset
+     */
+    struct Transform {
+        qreal scale = 1;
+        qreal offset = 0;
+    };
+
+    /**
+     * @brief Create an empty group
+     * @param axes Which axes of added views are linked
+     * @param parent Parent object
+     */
+    explicit AxisLinkGroup(Axes axes = X, QObject* parent = nullptr);
+
+    /**
+     * @brief Link the axes of a view selected by axes()
+     * @param view Chart view, its axes have to exist already
+     * @param transform Applied to both axes of the view
+     */
+    void addView(ChartView* view, const Transform& transform = Transform());
+    void removeView(ChartView* view);
+
+    /**
+     * @brief Link a single axis
+     * @param axis Value axis
+     * @param orientation Qt::Horizontal joins the x members, Qt::Vertical the y members
+     * @param transform Mapping from group to axis coordinates, scale must not be zero
+     */
+    void addAxis(QValueAxis* axis, Qt::Orientation orientation, const Transform& transform = Transform());
+    void removeAxis(QValueAxis* axis);
+
+    Axes axes() const { return m_axes; }
+
+    /**
+     * @brief Set the range of all members of one orientation at once
+     * @param orientation Qt::Horizontal or Qt::Vertical
+     * @param min Lower bound in group coordinates
+     * @param max Upper bound in group coordinates
+     */
+    void setRange(Qt::Orientation orientation, qreal min, qreal max);
+
+signals:
+    /**
+     * @brief Emitted after a range was propagated, in group coordinates
+     */
+    void rangeChanged(Qt::Orientation orientation, qreal min, qreal max);
+
+private:
+    struct Member {
+        QPointer<QValueAxis> axis;
+        Qt::Orientation orientation;
+        Transform transform;
+    };
+
+    struct Pending {
+        bool active = false;
+        QValueAxis* source = nullptr;
+        qreal min = 0, max = 0;
+    };
+
+    void memberRangeChanged(QValueAxis* axis, qreal min, qreal max);
+
+    /**
+     * @brief Hand the links of an axis a view has replaced over to its successor
+     */
+    void memberReplaced(Qt::Orientation orientation, QValueAxis* previous, QValueAxis* replacement);
+
+    void propagate();
+    Pending& pending(Qt::Orientation orientation) { return orientation == Qt::Horizontal ? m_pending_x : m_pending_y; }
+
+    Axes m_axes;
+    QVector<Member> m_members;
+    Pending m_pending_x, m_pending_y;
+    QTimer* m_timer;
+    bool m_applying = false;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(AxisLinkGroup::Axes)
@@ -0,0 +1,308 @@
+/*
+ * CuteCharts - Logarithmic and custom axis transforms
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+
+#include "axistransform.h"
+
+namespace {
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/**
+ * @brief Smallest 1, 2 or 5 times a power of ten that splits span into at most count steps
+ */
+double niceStep(double span, int count)
+{
+    const double raw = span / qMax(1, count);
+    const double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+    const double fraction = raw / magnitude;
+    if (fraction <= 1)
+        return magnitude;
+    if (fraction <= 2)
+        return 2 * magnitude;
+    if (fraction <= 5)
+        return 5 * magnitude;
+    return 10 * magnitude;
+}
+
+QVector<double> linearTicks(double min, double max, int count)
+{
+    QVector<double> ticks;
+    if (!std::isfinite(min) || !std::isfinite(max) || !(max > min))
+        return ticks;
+
+    const double step = niceStep(max - min, count);
+    const double first = std::ceil(min / step - 1e-9);
+    const double last = std::floor(max / step + 1e-9);
+    for (double i = first; i <= last; ++i) {
+        const double value = i * step;
+        ticks << (std::abs(value) < step * 1e-9 ? 0 : value);
+    }
+    return ticks;
+}
+
+/**
+ * @brief Keep every n-th tick so that at most count remain
+ */
+void thin(QVector<double>& ticks, int count)
+{
+    if (count < 1 || ticks.size() <= count)
+        return;
+    const qsizetype stride = (ticks.size() + count - 1) / count;
+    QVector<double> kept;
+    for (qsizetype i = 0; i < ticks.size(); i += stride)
+        kept << ticks[i];
+    ticks = kept;
+}
+
+/**
+ * @brief Smallest value of {0, +-c * 10^k} not below value
+ */
+double symlogCeil(double value, double constant)
+{
+    if (value > 0)
+        return constant * std::pow(10.0, std::max(0.0, std::ceil(std::log10(value / constant) - 1e-9)));
+    if (-value < constant)
+        return 0;
+    return -constant * std::pow(10.0, std::floor(std::log10(-value / constant) + 1e-9));
+}
+
+/**
+ * @brief Candidate of {0, +-c * 10^k} following value
+ */
+double symlogNext(double value, double constant)
+{
+    if (value > 0)
+        return value * 10;
+    if (value == 0)
+        return constant;
+    return -value > constant * (1 + 1e-9) ? value / 10 : 0;
+}
+}
+
+template <typename Visitor>
+void AxisTransform::visit(Visitor&& visitor) const
+{
+    switch (m_type) {
+    case Type::Linear:
+        visitor([](double value) { return value; });
+        break;
+    case Type::Log10:
+        visitor([](double value) { return value > 0 ? std::log10(value) : NaN; });
+        break;
+    case Type::Symlog: {
+        const double constant = m_constant;
+        visitor([constant](double value) { return std::copysign(std::log10(1 + std::abs(value) / constant), value); });
+        break;
+    }
+    case Type::Custom:
+        visitor([this](double value) { return m_forward(value); });
+        break;
+    }
+}
+
+AxisTransform AxisTransform::log10()
+{
+    AxisTransform transform;
+    transform.m_type = Type::Log10;
+    return transform;
+}
+
+AxisTransform AxisTransform::symlog(double constant)
+{
+    AxisTransform transform;
+    transform.m_type = Type::Symlog;
+    transform.m_constant = constant > 0 ? constant : 1;
+    return transform;
+}
+
+AxisTransform AxisTransform::custom(Function forward, Function inverse)
+{
+    AxisTransform transform;
+    if (!forward || !inverse)
+        return transform;
+    transform.m_type = Type::Custom;
+    transform.m_forward = std::move(forward);
+    transform.m_inverse = std::move(inverse);
+    return transform;
+}
+
+double AxisTransform::map(double value) const
+{
+    double result = value;
+    visit([&](auto function) { result = function(value); });
+    return result;
+}
+
+double AxisTransform::unmap(double value) const
+{
+    switch (m_type) {
+    case Type::Linear:
+        return value;
+    case Type::Log10:
+        return std::pow(10.0, value);
+    case Type::Symlog:
+        return std::copysign(m_constant * (std::pow(10.0, std::abs(value)) - 1), value);
+    case Type::Custom:
+        return m_inverse(value);
+    }
+    return value;
+}
+
+void AxisTransform::map(const double* values, double* result, qsizetype count) const
+{
+    visit([&](auto function) {
+        ChartTools::ParallelFor(count, [values, result, function](qsizetype begin, qsizetype end, int) {
+            for (qsizetype i = begin; i < end; ++i)
+                result[i] = function(values[i]);
+        },
+            65536);
+    });
+}
+
+QList<QPointF> AxisTransform::map(const QList<QPointF>& points, const AxisTransform& x, const AxisTransform& y, QPointF* clip)
+{
+    if (clip)
+        *clip = QPointF(NaN, NaN);
+    if (x.isLinear() && y.isLinear())
+        return points;
+
+    const qsizetype count = points.size();
+    QList<QPointF> result(count);
+    const QPointF* source = points.constData();
+    QPointF* target = result.data();
+
+    // One pass per coordinate, each recording its lowest finite value and whether anything fell outside
+    auto pass = [&](const AxisTransform& transform, bool vertical) {
+        std::vector<double> lowest(size_t(ChartTools::WorkerCount()), std::numeric_limits<double>::infinity());
+        std::vector<qsizetype> outside(lowest.size(), 0);
+        transform.visit([&](auto function) {
+            ChartTools::ParallelFor(count, [&, function](qsizetype begin, qsizetype end, int worker) {
+                double low = lowest[size_t(worker)];
+                qsizetype bad = 0;
+                for (qsizetype i = begin; i < end; ++i) {
+                    const double value = function(vertical ? source[i].y() : source[i].x());
+                    if (vertical)
+                        target[i].setY(value);
+                    else
+                        target[i].setX(value);
+                    if (std::isfinite(value))
+                        low = std::min(low, value);
+                    else
+                        ++bad;
+                }
+                lowest[size_t(worker)] = low;
+                outside[size_t(worker)] += bad;
+            },
+                65536);
+        });
+
+        if (std::all_of(outside.cbegin(), outside.cend(), [](qsizetype bad) { return bad == 0; }))
+            return NaN;
+
+        double floor = *std::min_element(lowest.cbegin(), lowest.cend());
+        if (!std::isfinite(floor))
+            floor = 0;
+        ChartTools::ParallelFor(count, [&](qsizetype begin, qsizetype end, int) {
+            for (qsizetype i = begin; i < end; ++i) {
+                if (vertical && !std::isfinite(target[i].y()))
+                    target[i].setY(floor);
+                else if (!vertical && !std::isfinite(target[i].x()))
+                    target[i].setX(floor);
+            }
+        },
+            65536);
+        return floor;
+    };
+
+    const double clipX = pass(x, false);
+    const double clipY = pass(y, true);
+    if (clip)
+        *clip = QPointF(clipX, clipY);
+    return result;
+}
+
+void AxisTransform::niceRange(double& min, double& max) const
+{
+    if (!std::isfinite(min) || !std::isfinite(max))
+        return;
+
+    if (m_type == Type::Log10) {
+        min = std::floor(min);
+        max = std::ceil(max);
+        if (max <= min)
+            max = min + 1;
+        return;
+    }
+
+    double lower = unmap(min), upper = unmap(max);
+    if (!(upper > lower)) {
+        lower -= 0.5;
+        upper += 0.5;
+    }
+    if (m_type == Type::Symlog) {
+        lower = -symlogCeil(-lower, m_constant);
+        upper = symlogCeil(upper, m_constant);
+    } else {
+        const double step = niceStep(upper - lower, 5);
+        lower = std::floor(lower / step) * step;
+        upper = std::ceil(upper / step) * step;
+    }
+
+    const double mappedMin = map(lower), mappedMax = map(upper);
+    if (std::isfinite(mappedMin) && std::isfinite(mappedMax)) {
+        min = mappedMin;
+        max = mappedMax;
+    }
+}
+
+QVector<double> AxisTransform::ticks(double min, double max, int count) const
+{
+    QVector<double> ticks;
+    if (!std::isfinite(min) || !std::isfinite(max) || !(max > min))
+        return ticks;
+
+    if (m_type == Type::Log10) {
+        // Decades, every n-th one on multiples of n so labels stay put while panning
+        const double first = std::ceil(min - 1e-9), last = std::floor(max + 1e-9);
+        const double stride = std::max(1.0, std::ceil((last - first + 1) / qMax(1, count)));
+        for (double k = std::ceil(first / stride) * stride; k <= last; k += stride)
+            ticks << std::pow(10.0, k);
+    } else if (m_type == Type::Symlog) {
+        const double lower = unmap(min), upper = unmap(max);
+        for (double value = symlogCeil(lower, m_constant); value <= upper + std::abs(upper) * 1e-9; value = symlogNext(value, m_constant))
+            ticks << value;
+    }
+    // Less than two decades in view, round data values read better
+    if (ticks.size() < 2)
+        return linearTicks(unmap(min), unmap(max), count);
+
+    thin(ticks, count);
+    return ticks;
+}
+
+QString AxisTransform::label(double value)
+{
+    return QString::number(value, 'g', 6);
+}
@@ -0,0 +1,136 @@
+/*
+ * CuteCharts - Logarithmic and custom axis transforms
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QPointF>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <functional>
+
+/**
+ * @brief Monotone mapping between data values and axis values
+ *
+ * Qt Charts only knows linear value axes. A transformed axis is therefore a
+ * plain QValueAxis in transformed units, and the series hold transformed
+ * points; the chart maps those to pixels linearly as usual. Zooming and
+ * panning only change the axis range, the transformed points stay valid.
+ *
+ * Log10 is undefined for values <= 0, those map to NaN. Symlog is
+ * sign(v) * log10(1 + |v| / c): linear around zero, logarithmic beyond c.
+ * Custom transforms have to be increasing.
+ */
+class AxisTransform {
+public:
+    enum class Type {
+        Linear = 0,
+        Log10 = 1,
+        Symlog = 2,
+        Custom = 3
+    };
+
+    using Function = std::function<double(double)>;
+
+    AxisTransform() = default;
+
+    static AxisTransform log10();
+
+    /**
+     * @brief Symmetric logarithm
+     * @param constant Half width of the linear region around zero
+     */
+    static AxisTransform symlog(double constant = 1);
+
+    /**
+     * @brief Arbitrary increasing transform
+     * @param forward Data value to axis value
+     * @param inverse Axis value to data value
+     */
+    static AxisTransform custom(Function forward, Function inverse);
+
+    inline Type type() const { return m_type; }
+    inline bool isLinear() const { return m_type == Type::Linear; }
+    inline double constant() const { return m_constant; }
+
+    double map(double value) const;
+    double unmap(double value) const;
+
+    inline QPointF map(const QPointF& point, const AxisTransform& y) const { return QPointF(map(point.x()), y.map(point.y())); }
+    inline QPointF unmap(const QPointF& point, const AxisTransform& y) const { return QPointF(unmap(point.x()), y.unmap(point.y())); }
+
+    /**
+     * @brief Map a whole buffer
+     *
+     * The type is resolved once, the loop body is a single expression the
+     * compiler can vectorize, and large buffers are split over the thread pool.
+     * @param values Input values
+     * @param result Output, may be the same buffer as values
+     * @param count Number of values
+     */
+    void map(const double* values, double* result, qsizetype count) const;
+
+    /**
+     * @brief Map points through an x and a y transform
+     *
+     * Coordinates outside the domain of their transform are clipped to the
+     * lowest finite mapped value of that coordinate, so the result keeps the
+     * indices of the input.
+     * @param points Data points
+     * @param x Transform of the x coordinates
+     * @param y Transform of the y coordinates
+     * @param clip Receives the clip values, or NaN where all values were finite
+     * @return Points in axis units
+     */
+    static QList<QPointF> map(const QList<QPointF>& points, const AxisTransform& x, const AxisTransform& y, QPointF* clip = nullptr);
+
+    /**
+     * @brief Widen a range in axis units to round data values
+     *
+     * Log10 snaps to decades, symlog to zero and powers of ten times the
+     * constant, all others to a 1-2-5 step of the data values.
+     */
+    void niceRange(double& min, double& max) const;
+
+    /**
+     * @brief Round data values for the labels of a range in axis units
+     * @param min Lower end in axis units
+     * @param max Upper end in axis units
+     * @param count Approximate number of ticks wanted
+     * @return Data values, ascending
+     */
+    QVector<double> ticks(double min, double max, int count = 6) const;
+
+    /**
+     * @brief Label text for a data value
+     */
+    static QString label(double value);
+
+private:
+    /**
+     * @brief Call visitor once with the forward mapping as a plain callable
+     */
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const;
+
+    Type m_type = Type::Linear;
+    double m_constant = 1;
+    Function m_forward, m_inverse;
+};
@@ -0,0 +1,492 @@
+/*
+ * CuteCharts - Box and whisker statistics from raw samples
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCore/QtMath>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "parallel.h"
+
+#include "boxwhisker.h"
+
+namespace {
+
+constexpr int SelectBins = 4096;
+constexpr qsizetype GatherLimit = qsizetype(1) << 22;
+
+struct Moments {
+    qsizetype count = 0;
+    qreal mean = 0, m2 = 0;
+    qreal min = std::numeric_limits<qreal>::max();
+    qreal max = std::numeric_limits<qreal>::lowest();
+
+    void add(qreal sample)
+    {
+        ++count;
+        const qreal delta = sample - mean;
+        mean += delta / count;
+        m2 += delta * (sample - mean);
+        min = qMin(min, sample);
+        max = qMax(max, sample);
+    }
+
+    // Chan et al., pairwise combination of partial results
+    void merge(const Moments& other)
+    {
+        if (other.count == 0)
+            return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const qsizetype total = count + other.count;
+        const qreal delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * count / qreal(total) * other.count;
+        count = total;
+        min = qMin(min, other.min);
+        max = qMax(max, other.max);
+    }
+
+    qreal stddev() const { return count > 1 ? std::sqrt(m2 / (count - 1)) : 0; }
+};
+
+using Rank = std::pair<qsizetype, int>; ///< Rank within the current range and the output slot
+
+/**
+ * Collect the samples for which target() returns a slot in [0, slots)
+ */
+template <typename Target>
+std::vector<std::vector<qreal>> gather(const qreal* samples, qsizetype count, int slots, const Target& target)
+{
+    const int workers = ChartTools::WorkerCount();
+    std::vector<std::vector<std::vector<qreal>>> partial(workers);
+    ChartTools::ParallelFor(count, [samples, slots, &target, &partial](qsizetype begin, qsizetype end, int worker) {
+        std::vector<std::vector<qreal>>& local = partial[worker];
+        local.resize(size_t(slots));
+        for (qsizetype i = begin; i < end; ++i) {
+            const int slot = target(samples[i]);
+            if (slot >= 0)
+                local[size_t(slot)].push_back(samples[i]);
+        }
+    },
+        65536);
+
+    std::vector<std::vector<qreal>> result(static_cast<size_t>(slots));
+    for (const std::vector<std::vector<qreal>>& local : partial) {
+        for (size_t slot = 0; slot < local.size(); ++slot)
+            result[slot].insert(result[slot].end(), local[slot].begin(), local[slot].end());
+    }
+    return result;
+}
+
+/**
+ * Select order statistics of the samples within [lo, hi), or [lo, hi] if closed
+ *
+ * One parallel pass histograms the range. Bins holding a requested rank are
+ * either gathered and resolved with nth_element(), or refined recursively if
+ * they are still too large.
+ */
+void selectRanks(const qreal* samples, qsizetype count, qreal lo, qreal hi, bool closed, const std::vector<Rank>& ranks, qreal* out, int depth)
+{
+    if (ranks.empty())
+        return;
+
+    auto inRange = [lo, hi, closed](qreal value) {
+        return value >= lo && (value < hi || (closed && value == hi));
+    };
+
+    if (lo == hi) {
+        for (const Rank& rank : ranks)
+            out[rank.second] = lo;
+        return;
+    }
+
+    const qreal width = (hi - lo) / SelectBins;
+    if (depth > 8 || !(width > 0) || lo + width == lo) {
+        std::vector<qreal> values = gather(samples, count, 1, [&inRange](qreal value) { return inRange(value) ? 0 : -1; }).front();
+        for (const Rank& rank : ranks) {
+            std::nth_element(values.begin(), values.begin() + rank.first, values.end());
+            out[rank.second] = values[size_t(rank.first)];
+        }
+        return;
+    }
+
+    auto edge = [lo, hi, width](int bin) { return bin >= SelectBins ? hi : lo + bin * width; };
+    auto binOf = [&inRange, &edge, lo, width](qreal value) -> int {
+        if (!inRange(value))
+            return -1;
+        int bin = qBound(0, int((value - lo) / width), SelectBins - 1);
+        // Make the bin agree with the edges, which also bound the next recursion level
+        while (bin > 0 && value < edge(bin))
+            --bin;
+        while (bin < SelectBins - 1 && value >= edge(bin + 1))
+            ++bin;
+        return bin;
+    };
+
+    const int workers = ChartTools::WorkerCount();
+    std::vector<std::vector<qsizetype>> partial(workers);
+    ChartTools::ParallelFor(count, [samples, &partial, &binOf](qsizetype begin, qsizetype end, int worker) {
+        std::vector<qsizetype>& local = partial[worker];
+        local.assign(SelectBins, 0);
+        for (qsizetype i = begin; i < end; ++i) {
+            const int bin = binOf(samples[i]);
+            if (bin >= 0)
+                ++local[size_t(bin)];
+        }
+    },
+        65536);
+
+    std::vector<qsizetype> histogram(SelectBins, 0);
+    for (const std::vector<qsizetype>& local : partial) {
+        for (size_t bin = 0; bin < local.size(); ++bin)
+            histogram[bin] += local[bin];
+    }
+
+    // Locate every rank, grouped by bin
+    std::vector<std::pair<int, std::vector<Rank>>> targets;
+    for (const Rank& rank : ranks) {
+        qsizetype below = 0;
+        int bin = 0;
+        while (bin < SelectBins - 1 && below + histogram[size_t(bin)] <= rank.first)
+            below += histogram[size_t(bin++)];
+
+        auto it = std::find_if(targets.begin(), targets.end(), [bin](const auto& target) { return target.first == bin; });
+        if (it == targets.end())
+            it = targets.emplace(targets.end(), bin, std::vector<Rank>());
+        it->second.push_back({ rank.first - below, rank.second });
+    }
+
+    std::vector<int> small;
+    for (const auto& target : targets) {
+        if (histogram[size_t(target.first)] <= GatherLimit)
+            small.push_back(target.first);
+        else
+            selectRanks(samples, count, edge(target.first), edge(target.first + 1), closed && target.first == SelectBins - 1, target.second, out, depth + 1);
+    }
+    if (small.empty())
+        return;
+
+    std::vector<std::vector<qreal>> values = gather(samples, count, int(small.size()), [&binOf, &small](qreal value) {
+        const int bin = binOf(value);
+        for (size_t slot = 0; slot < small.size(); ++slot) {
+            if (small[slot] == bin)
+                return int(slot);
+        }
+        return -1;
+    });
+    for (size_t slot = 0; slot < small.size(); ++slot) {
+        std::vector<qreal>& bin = values[slot];
+        for (const auto& target : targets) {
+            if (target.first != small[slot])
+                continue;
+            for (const Rank& rank : target.second) {
+                std::nth_element(bin.begin(), bin.begin() + rank.first, bin.end());
+                out[rank.second] = bin[size_t(rank.first)];
+            }
+        }
+    }
+}
+
+// Sort samples into outlier lists and find the whiskers in one pass
+void classify(const qreal* samples, qsizetype count, BoxWhisker& box)
+{
+    const qreal iqr = box.upper_quantile - box.lower_quantile;
+    const qreal lowerInner = box.lower_quantile - 1.5 * iqr, upperInner = box.upper_quantile + 1.5 * iqr;
+    const qreal lowerOuter = box.lower_quantile - 3 * iqr, upperOuter = box.upper_quantile + 3 * iqr;
+
+    struct Partial {
+        QList<qreal> mild, extreme;
+        qreal low = std::numeric_limits<qreal>::max();
+        qreal high = std::numeric_limits<qreal>::lowest();
+    };
+    std::vector<Partial> partial(ChartTools::WorkerCount());
+
+    ChartTools::ParallelFor(count, [=, &partial](qsizetype begin, qsizetype end, int worker) {
+        Partial& local = partial[worker];
+        for (qsizetype i = begin; i < end; ++i) {
+            const qreal value = samples[i];
+            if (!std::isfinite(value))
+                continue;
+            if (value < lowerOuter || value > upperOuter) {
+                local.extreme << value;
+            } else if (value < lowerInner || value > upperInner) {
+                local.mild << value;
+            } else {
+                local.low = qMin(local.low, value);
+                local.high = qMax(local.high, value);
+            }
+        }
+    },
+        65536);
+
+    // Chunks are contiguous and ordered by worker, so outliers keep the input order
+    qreal low = std::numeric_limits<qreal>::max(), high = std::numeric_limits<qreal>::lowest();
+    for (const Partial& local : partial) {
+        box.mild_outliers << local.mild;
+        box.extreme_outliers << local.extreme;
+        low = qMin(low, local.low);
+        high = qMax(high, local.high);
+    }
+    box.lower_whisker = low <= high ? low : box.lower_quantile;
+    box.upper_whisker = low <= high ? high : box.upper_quantile;
+}
+
+}
+
+BoxWhisker BoxWhiskerBuilder::compute(const qreal* samples, qsizetype count)
+{
+    BoxWhisker box;
+    if (!samples || count <= 0)
+        return box;
+
+    std::vector<Moments> partial(ChartTools::WorkerCount());
+    ChartTools::ParallelFor(count, [samples, &partial](qsizetype begin, qsizetype end, int worker) {
+        Moments& local = partial[worker];
+        for (qsizetype i = begin; i < end; ++i) {
+            if (std::isfinite(samples[i]))
+                local.add(samples[i]);
+        }
+    },
+        65536);
+
+    Moments moments;
+    for (const Moments& local : partial)
+        moments.merge(local);
+    if (moments.count == 0)
+        return box;
+
+    // Linear interpolation between the two closest order statistics
+    const qreal probabilities[3] = { 0.25, 0.5, 0.75 };
+    std::vector<Rank> ranks;
+    for (int i = 0; i < 3; ++i) {
+        const qsizetype rank = qsizetype(std::floor((moments.count - 1) * probabilities[i]));
+        ranks.push_back({ rank, 2 * i });
+        ranks.push_back({ qMin(moments.count - 1, rank + 1), 2 * i + 1 });
+    }
+    qreal order[6];
+    selectRanks(samples, count, moments.min, moments.max, true, ranks, order, 0);
+
+    qreal quartiles[3];
+    for (int i = 0; i < 3; ++i) {
+        const qreal position = (moments.count - 1) * probabilities[i];
+        quartiles[i] = order[2 * i] + (position - std::floor(position)) * (order[2 * i + 1] - order[2 * i]);
+    }
+
+    box.lower_quantile = quartiles[0];
+    box.median = quartiles[1];
+    box.upper_quantile = quartiles[2];
+    box.mean = moments.mean;
+    box.stddev = moments.stddev();
+    box.count = int(qMin<qsizetype>(moments.count, std::numeric_limits<int>::max()));
+    classify(samples, count, box);
+    return box;
+}
+
+BoxWhiskerBuilder::BoxWhiskerBuilder(int tailSize)
+    : m_tail_size(qMax(1, tailSize))
+{
+}
+
+void BoxWhiskerBuilder::reset()
+{
+    *this = BoxWhiskerBuilder(m_tail_size);
+}
+
+void BoxWhiskerBuilder::addSample(qreal sample)
+{
+    if (!std::isfinite(sample))
+        return;
+
+    ++m_count;
+    const qreal delta = sample - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (sample - m_mean);
+
+    m_digest.addSample(sample);
+
+    if (m_smallest.size() < size_t(m_tail_size)) {
+        m_smallest.push(sample);
+    } else if (sample < m_smallest.top()) {
+        m_smallest.pop();
+        m_smallest.push(sample);
+    }
+    if (m_largest.size() < size_t(m_tail_size)) {
+        m_largest.push(sample);
+    } else if (sample > m_largest.top()) {
+        m_largest.pop();
+        m_largest.push(sample);
+    }
+}
+
+void BoxWhiskerBuilder::addSamples(const qreal* samples, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        addSample(samples[i]);
+}
+
+BoxWhisker BoxWhiskerBuilder::result() const
+{
+    auto drain = [](auto heap) {
+        std::vector<qreal> values;
+        values.reserve(heap.size());
+        for (; !heap.empty(); heap.pop())
+            values.push_back(heap.top());
+        std::sort(values.begin(), values.end());
+        return values;
+    };
+
+    const std::vector<qreal> smallest = drain(m_smallest);
+
+    // All samples are still in the tail, no need to estimate anything
+    if (m_count <= m_tail_size)
+        return compute(smallest.data(), qsizetype(smallest.size()));
+
+    const std::vector<qreal> largest = drain(m_largest);
+
+    BoxWhisker box;
+    box.lower_quantile = m_digest.quantile(0.25);
+    box.median = m_digest.quantile(0.5);
+    box.upper_quantile = m_digest.quantile(0.75);
+    box.mean = m_mean;
+    box.stddev = m_count > 1 ? std::sqrt(m_m2 / (m_count - 1)) : 0;
+    box.count = int(qMin<qsizetype>(m_count, std::numeric_limits<int>::max()));
+
+    const qreal iqr = box.upper_quantile - box.lower_quantile;
+    const qreal lowerInner = box.lower_quantile - 1.5 * iqr, upperInner = box.upper_quantile + 1.5 * iqr;
+    const qreal lowerOuter = box.lower_quantile - 3 * iqr, upperOuter = box.upper_quantile + 3 * iqr;
+
+    box.lower_whisker = lowerInner;
+    for (qreal value : smallest) {
+        if (value < lowerOuter) {
+            box.extreme_outliers << value;
+        } else if (value < lowerInner) {
+            box.mild_outliers << value;
+        } else {
+            box.lower_whisker = value;
+            break;
+        }
+    }
+
+    box.upper_whisker = upperInner;
+    for (auto it = largest.rbegin(); it != largest.rend(); ++it) {
+        if (*it > upperOuter) {
+            box.extreme_outliers << *it;
+        } else if (*it > upperInner) {
+            box.mild_outliers << *it;
+        } else {
+            box.upper_whisker = *it;
+            break;
+        }
+    }
+    return box;
+}
+
+TDigest::TDigest(qreal compression)
+    : m_compression(qMax<qreal>(20, compression))
+{
+}
+
+void TDigest::addSample(qreal sample)
+{
+    if (!std::isfinite(sample))
+        return;
+
+    if (m_count == 0) {
+        m_min = m_max = sample;
+    } else {
+        m_min = qMin(m_min, sample);
+        m_max = qMax(m_max, sample);
+    }
+    ++m_count;
+    m_buffer.push_back(sample);
+    if (m_buffer.size() >= size_t(5 * m_compression))
+        flush();
+}
+
+void TDigest::flush() const
+{
+    if (m_buffer.empty())
+        return;
+
+    std::vector<Centroid> all;
+    all.reserve(m_centroids.size() + m_buffer.size());
+    all.insert(all.end(), m_centroids.begin(), m_centroids.end());
+    for (qreal sample : m_buffer)
+        all.push_back({ sample, 1 });
+    m_buffer.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    qreal total = 0;
+    for (const Centroid& centroid : all)
+        total += centroid.weight;
+
+    // k1 scale function, a centroid may span at most one unit of k
+    const qreal normalizer = m_compression / (2 * M_PI);
+    auto scale = [normalizer](qreal q) { return normalizer * std::asin(2 * qBound<qreal>(0, q, 1) - 1); };
+
+    m_centroids.clear();
+    Centroid current = all.front();
+    qreal before = 0;
+    qreal limit = scale(0) + 1;
+    for (size_t i = 1; i < all.size(); ++i) {
+        const Centroid& next = all[i];
+        if (scale((before + current.weight + next.weight) / total) <= limit) {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        } else {
+            before += current.weight;
+            m_centroids.push_back(current);
+            limit = scale(before / total) + 1;
+            current = next;
+        }
+    }
+    m_centroids.push_back(current);
+}
+
+qreal TDigest::quantile(qreal p) const
+{
+    if (m_count == 0)
+        return 0;
+    flush();
+
+    const qreal total = m_count;
+    const qreal target = qBound<qreal>(0, p, 1) * total;
+    if (m_centroids.size() == 1)
+        return m_centroids.front().mean;
+
+    // Centroids are anchored at the middle of their weight, min and max at the ends
+    qreal before = 0;
+    qreal previousCenter = 0, previousMean = m_min;
+    for (const Centroid& centroid : m_centroids) {
+        const qreal center = before + centroid.weight / 2;
+        if (target < center) {
+            const qreal t = center > previousCenter ? (target - previousCenter) / (center - previousCenter) : 0;
+            return previousMean + t * (centroid.mean - previousMean);
+        }
+        previousCenter = center;
+        previousMean = centroid.mean;
+        before += centroid.weight;
+    }
+    const qreal t = total > previousCenter ? (target - previousCenter) / (total - previousCenter) : 0;
+    return previousMean + t * (m_max - previousMean);
+}
@@ -21,6 +21,9 @@
 #include <QtCore/QList>
 
 #include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
 
 struct BoxWhisker {
     QList<qreal> mild_outliers, extreme_outliers;
@@ -36,3 +39,101 @@ struct BoxWhisker {
     inline qreal UpperNotch() const { return median + (1.58 * (upper_quantile - lower_quantile) / sqrt(count)); }
     inline qreal LowerNotch() const { return median - (1.58 * (upper_quantile - lower_quantile) / sqrt(count)); }
 };
+
+/**
+ * @brief Merging t-digest for streaming quantile estimates in bounded memory
+ *
+ * Dunning and Ertl, Computing extremely accurate quantiles using t-digests
+ * (2019). Samples are buffered and merged into centroids whose size shrinks
+ * towards both tails, so quantiles are most accurate near the extremes and a
+ * few far outliers cannot distort the centre of the distribution.
+ */
+class TDigest {
+public:
+    /**
+     * @brief Create an empty digest
+     * @param compression Upper bound for the number of centroids, roughly
+     */
+    explicit TDigest(qreal compression = 200);
+
+    void addSample(qreal sample);
+
+    /**
+     * @brief Estimate a quantile
+     * @param p Probability in [0, 1]
+     * @return Interpolated quantile, 0 if the digest is empty
+     */
+    qreal quantile(qreal p) const;
+
+    qsizetype count() const { return m_count; }
+
+private:
+    struct Centroid {
+        qreal mean;
+        qreal weight;
+    };
+
+    void flush() const;
+
+    qreal m_compression;
+    qsizetype m_count = 0;
+    qreal m_min = 0, m_max = 0;
+    mutable std::vector<Centroid> m_centroids;
+    mutable std::vector<qreal> m_buffer;
+};
+
+/**
+ * @brief Compute BoxWhisker statistics from raw samples
+ *
+ * compute() is exact. Quartiles are interpolated between order statistics,
+ * which are selected by parallel histogram passes over the unmodified data
+ * followed by nth_element() on the few samples of the target bins, so the
+ * input is never sorted or copied as a whole.
+ *
+ * A builder object instead accumulates samples of unbounded streams in fixed
+ * memory: quartiles are t-digest estimates, mean and deviation are exact, and the
+ * tailSize smallest and largest samples are kept to classify outliers and
+ * place the whiskers. Outliers beyond the kept tails are not reported and
+ * the whisker falls back to the fence then. While fewer than tailSize samples
+ * were added the result is exact.
+ *
+ * Samples beyond 1.5 times the interquartile range outside of the box are
+ * mild outliers, beyond 3 times extreme outliers. Non finite samples are ignored.
+ */
+class BoxWhiskerBuilder {
+public:
+    /**
+     * @brief Exact statistics of a sample set
+     * @param samples Values
+     * @param count Number of values
+     * @return The statistics
+     */
+    static BoxWhisker compute(const qreal* samples, qsizetype count);
+    static BoxWhisker compute(const QList<qreal>& samples) { return compute(samples.constData(), samples.size()); }
+
+    /**
+     * @brief Create a streaming builder
+     * @param tailSize Number of smallest and largest samples kept for outliers and whiskers
+     */
+    explicit BoxWhiskerBuilder(int tailSize = 1024);
+
+    void addSample(qreal sample);
+    void addSamples(const qreal* samples, qsizetype count);
+    void reset();
+
+    qsizetype count() const { return m_count; }
+
+    /**
+     * @brief Statistics of all samples added so far
+     * @return The statistics
+     */
+    BoxWhisker result() const;
+
+private:
+    int m_tail_size;
+    qsizetype m_count = 0;
+    qreal m_mean = 0, m_m2 = 0;
+    TDigest m_digest;
+    std::priority_queue<qreal> m_smallest; ///< Max heap, top is the largest of the kept small samples
+    std::priority_queue<qreal, std::vector<qreal>, std::greater<qreal>> m_largest;
+};
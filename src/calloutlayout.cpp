@@ -0,0 +1,506 @@
+/*
+ * CuteCharts - Placement of peak callouts without overlaps
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QChart>
+#include <QtCharts/QValueAxis>
+#include <QtCharts/QXYSeries>
+
+#include <algorithm>
+#include <cmath>
+
+#include "peakcallout.h"
+#include "peakpicker.h"
+
+#include "calloutlayout.h"
+
+namespace {
+/**
+ * @brief Uniform grid over the plot area holding the placed label rectangles
+ */
+class LabelGrid {
+public:
+    LabelGrid(const QRectF& area, qreal cell)
+        : m_area(area)
+        , m_cell(cell)
+        , m_columns(qMax(1, int(std::ceil(area.width() / cell))))
+        , m_rows(qMax(1, int(std::ceil(area.height() / cell))))
+        , m_cells(m_columns * m_rows)
+    {
+    }
+
+    bool isFree(const QRectF& rect) const
+    {
+        bool free = true;
+        forCells(rect, [&](int cell) {
+            for (int index : m_cells[cell]) {
+                if (m_rects[index].intersects(rect)) {
+                    free = false;
+                    return false;
+                }
+            }
+            return true;
+        });
+        return free;
+    }
+
+    void insert(const QRectF& rect)
+    {
+        const int index = m_rects.size();
+        m_rects.append(rect);
+        forCells(rect, [&](int cell) {
+            m_cells[cell].append(index);
+            return true;
+        });
+    }
+
+private:
+    template <typename Function>
+    void forCells(const QRectF& rect, Function function) const
+    {
+        const int left = qBound(0, int((rect.left() - m_area.left()) / m_cell), m_columns - 1);
+        const int right = qBound(0, int((rect.right() - m_area.left()) / m_cell), m_columns - 1);
+        const int top = qBound(0, int((rect.top() - m_area.top()) / m_cell), m_rows - 1);
+        const int bottom = qBound(0, int((rect.bottom() - m_area.top()) / m_cell), m_rows - 1);
+        for (int row = top; row <= bottom; ++row) {
+            for (int column = left; column <= right; ++column) {
+                if (!function(row * m_columns + column))
+                    return;
+            }
+        }
+    }
+
+    QRectF m_area;
+    qreal m_cell;
+    int m_columns, m_rows;
+    QVector<QVector<int>> m_cells;
+    QVector<QRectF> m_rects;
+};
+
+const qreal GridCell = 32;
+const qreal AnchorGap = 12;
+const int Levels = 4;
+}
+
+CalloutLayout::CalloutLayout(QChart* chart, QObject* parent)
+    : QObject(parent)
+    , m_chart(chart)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(16);
+    connect(&m_timer, &QTimer::timeout, this, &CalloutLayout::relayout);
+    if (m_chart)
+        connect(m_chart, &QChart::plotAreaChanged, this, &CalloutLayout::scheduleLayout);
+}
+
+CalloutLayout::~CalloutLayout()
+{
+    clear();
+}
+
+PeakCallOut* CalloutLayout::addSeriesCallout(QXYSeries* series)
+{
+    if (!series || !m_chart)
+        return nullptr;
+
+    PeakCallOut* callout = new PeakCallOut(m_chart);
+    callout->setSeries(series);
+    if (m_has_font)
+        callout->setFont(m_font);
+    callout->setColor(series->color());
+    callout->setText(series->name(), seriesMaximum(series));
+    callout->setZValue(11);
+    // Only the first callout of a series needs the connections
+    const bool known = hasCallout(series);
+    m_items.append(Item{ callout, series, true });
+    if (!known) {
+        connect(series, &QAbstractSeries::visibleChanged, this, &CalloutLayout::invalidate);
+        connect(series, &QXYSeries::colorChanged, this, [this, series](const QColor& color) {
+            for (const Item& item : qAsConst(m_items)) {
+                if (item.callout && item.series == series)
+                    item.callout->setColor(color);
+            }
+        });
+        connect(series, &QXYSeries::nameChanged, this, [this, series]() {
+            for (const Item& item : qAsConst(m_items)) {
+                if (item.callout && item.seriesAnchor && item.series == series)
+                    item.callout->setText(series->name(), item.callout->anchor());
+            }
+            invalidate();
+        });
+        connect(series, &QXYSeries::pointsReplaced, this, [this, series]() { invalidateAnchor(series); });
+        connect(series, &QXYSeries::pointAdded, this, [this, series]() { invalidateAnchor(series); });
+        connect(series, &QXYSeries::pointReplaced, this, [this, series]() { invalidateAnchor(series); });
+        connect(series, &QXYSeries::pointRemoved, this, [this, series]() { invalidateAnchor(series); });
+        connect(series, &QXYSeries::pointsRemoved, this, [this, series]() { invalidateAnchor(series); });
+        connect(series, &QObject::destroyed, this, [this, series]() { removeCallouts(series); });
+    }
+
+    invalidate();
+    return callout;
+}
+
+void CalloutLayout::addCallout(PeakCallOut* callout)
+{
+    if (!callout)
+        return;
+    if (m_has_font)
+        callout->setFont(m_font);
+    callout->update();
+    m_items.append(Item{ callout, callout->series(), false });
+    invalidate();
+}
+
+void CalloutLayout::removeCallouts(const QAbstractSeries* series)
+{
+    for (int i = m_items.size() - 1; i >= 0; --i) {
+        if (m_items[i].series != series && m_items[i].callout)
+            continue;
+        delete m_items[i].callout.data();
+        m_items.removeAt(i);
+    }
+    m_anchors.remove(series);
+    ++m_generation;
+}
+
+void CalloutLayout::clear()
+{
+    for (const Item& item : qAsConst(m_items))
+        delete item.callout.data();
+    m_items.clear();
+    m_anchors.clear();
+    qDeleteAll(m_peak_labels);
+    m_peak_labels.clear();
+    m_used_peak_labels = 0;
+    ++m_generation;
+}
+
+bool CalloutLayout::hasCallout(const QAbstractSeries* series) const
+{
+    for (const Item& item : m_items) {
+        if (item.callout && item.series == series)
+            return true;
+    }
+    return false;
+}
+
+void CalloutLayout::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    ++m_generation;
+    relayout();
+}
+
+void CalloutLayout::setFont(const QFont& font)
+{
+    m_font = font;
+    m_has_font = true;
+    for (const Item& item : qAsConst(m_items)) {
+        if (!item.callout)
+            continue;
+        item.callout->setFont(font);
+        item.callout->update();
+    }
+    for (PeakCallOut* label : qAsConst(m_peak_labels)) {
+        if (!label)
+            continue;
+        label->setFont(font);
+        label->update();
+    }
+    invalidate();
+}
+
+void CalloutLayout::setPeakPicker(PeakPicker* picker)
+{
+    if (m_picker)
+        disconnect(m_picker, nullptr, this, nullptr);
+    m_picker = picker;
+    if (m_picker)
+        connect(m_picker, &PeakPicker::peaksChanged, this, &CalloutLayout::invalidate);
+    invalidate();
+}
+
+void CalloutLayout::setMaximumPeakLabels(int count)
+{
+    m_max_peak_labels = qMax(0, count);
+    invalidate();
+}
+
+void CalloutLayout::setLabelTransform(const AxisTransform& transform)
+{
+    m_label_transform = transform;
+    invalidate();
+}
+
+void CalloutLayout::trackAxis(QValueAxis* axis)
+{
+    if (axis)
+        connect(axis, &QValueAxis::rangeChanged, this, &CalloutLayout::scheduleLayout, Qt::UniqueConnection);
+}
+
+void CalloutLayout::scheduleLayout()
+{
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void CalloutLayout::relayout()
+{
+    m_timer.stop();
+    if (!m_chart)
+        return;
+
+    const QRectF area = m_chart->plotArea();
+    LabelGrid grid(area, GridCell);
+
+    struct Candidate {
+        PeakCallOut* callout;
+        QPointF anchor;
+    };
+    QVector<Candidate> candidates;
+    candidates.reserve(m_items.size());
+
+    for (int i = m_items.size() - 1; i >= 0; --i) {
+        if (!m_items[i].callout)
+            m_items.removeAt(i);
+    }
+
+    for (const Item& item : qAsConst(m_items)) {
+        PeakCallOut* callout = item.callout;
+        QAbstractSeries* series = callout->series();
+        if (item.seriesAnchor) {
+            QXYSeries* xy = qobject_cast<QXYSeries*>(series);
+            const QPointF anchor = xy ? seriesMaximum(xy) : callout->anchor();
+            if (anchor != callout->anchor())
+                callout->setAnchor(anchor);
+        }
+
+        bool show = m_enabled && (!series || series->isVisible());
+        const QPointF anchor = m_chart->mapToPosition(callout->anchor(), series && series->chart() == m_chart ? series : nullptr);
+        if (show && !area.contains(anchor))
+            show = false;
+        if (!show) {
+            callout->setVisible(false);
+            continue;
+        }
+
+        if (callout->isPinned()) {
+            callout->setPos(anchor + callout->pinnedOffset());
+            grid.insert(callout->labelRect());
+            callout->setVisible(true);
+            continue;
+        }
+        candidates.append(Candidate{ callout, anchor });
+    }
+
+    // Important and high peaks claim the best slots
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.callout->priority() != b.callout->priority())
+            return a.callout->priority() > b.callout->priority();
+        return a.anchor.y() < b.anchor.y();
+    });
+
+    // Peak labels come after the callouts, most prominent first
+    int used = 0;
+    if (m_picker && m_enabled && m_max_peak_labels > 0) {
+        struct Found {
+            QXYSeries* series;
+            Peak peak;
+            QPointF anchor;
+        };
+        QVector<Found> found;
+        const QList<QXYSeries*> watched = m_picker->series();
+        for (QXYSeries* series : watched) {
+            if (!series->isVisible() || series->chart() != m_chart)
+                continue;
+            // Peaks are sorted by prominence, each series offers at most the cap
+            int taken = 0;
+            const QVector<Peak> peaks = m_picker->peaks(series);
+            for (const Peak& peak : peaks) {
+                const QPointF anchor = m_chart->mapToPosition(peak.position, series);
+                if (!area.contains(anchor))
+                    continue;
+                found.append(Found{ series, peak, anchor });
+                if (++taken >= m_max_peak_labels)
+                    break;
+            }
+        }
+        std::stable_sort(found.begin(), found.end(), [](const Found& a, const Found& b) {
+            return a.peak.prominence > b.peak.prominence;
+        });
+        if (found.size() > m_max_peak_labels)
+            found.resize(m_max_peak_labels);
+
+        for (const Found& peak : qAsConst(found)) {
+            PeakCallOut* label = peakLabel(used++);
+            label->setSeries(peak.series);
+            label->setColor(peak.series->color());
+            label->setText(QString::number(m_label_transform.unmap(peak.peak.position.x()), 'f', 2), peak.peak.position);
+            label->setPriority(peak.peak.prominence);
+            candidates.append(Candidate{ label, peak.anchor });
+        }
+    }
+    for (int i = used; i < m_peak_labels.size(); ++i) {
+        if (m_peak_labels[i])
+            m_peak_labels[i]->setVisible(false);
+    }
+    m_used_peak_labels = used;
+
+    for (const Candidate& candidate : qAsConst(candidates)) {
+        const QSizeF size = candidate.callout->labelSize();
+        const QPointF& anchor = candidate.anchor;
+        bool placed = false;
+
+        for (int side = 0; side < 2 && !placed; ++side) {
+            for (int level = 0; level < Levels && !placed; ++level) {
+                const qreal step = level * (size.height() + 4);
+                const qreal top = side == 0 ? anchor.y() - AnchorGap - size.height() - step : anchor.y() + AnchorGap + step;
+                for (qreal shift : { 0.0, -0.5, 0.5, -1.0, 1.0 }) {
+                    const QRectF rect(anchor.x() - size.width() / 2 + shift * (size.width() + 4), top, size.width(), size.height());
+                    if (!area.contains(rect) || !grid.isFree(rect))
+                        continue;
+                    grid.insert(rect);
+                    candidate.callout->placeLabel(rect);
+                    placed = true;
+                    break;
+                }
+            }
+        }
+        candidate.callout->setVisible(placed);
+    }
+    emit laidOut();
+}
+
+CalloutLayout::Placement CalloutLayout::placement() const
+{
+    Placement placement;
+    if (!m_chart)
+        return placement;
+
+    placement.area = m_chart->plotArea();
+    placement.generation = m_generation;
+    placement.labels.reserve(m_items.size() + m_used_peak_labels);
+    for (const Item& item : m_items) {
+        if (!item.callout)
+            continue;
+        Placement::Label label;
+        label.callout = item.callout;
+        label.position = item.callout->pos();
+        label.visible = item.callout->isVisible();
+        label.pinned = item.callout->isPinned();
+        placement.labels.append(label);
+    }
+    for (int i = 0; i < m_used_peak_labels && i < m_peak_labels.size(); ++i) {
+        PeakCallOut* callout = m_peak_labels[i];
+        if (!callout)
+            continue;
+        Placement::Label label;
+        label.callout = callout;
+        label.position = callout->pos();
+        label.visible = callout->isVisible();
+        label.peak = i;
+        label.series = callout->series();
+        label.text = callout->text();
+        label.anchor = callout->anchor();
+        label.priority = callout->priority();
+        placement.labels.append(label);
+    }
+    return placement;
+}
+
+bool CalloutLayout::restorePlacement(const Placement& placement)
+{
+    if (!m_chart || placement.generation != m_generation || placement.area != m_chart->plotArea())
+        return false;
+    // A label moved by the user since changes the free slots
+    for (const Placement::Label& label : placement.labels) {
+        if (!label.callout || label.callout->isPinned() != label.pinned)
+            return false;
+        if (label.peak >= 0 && !label.series)
+            return false;
+    }
+
+    m_timer.stop();
+    int used = 0;
+    for (const Placement::Label& label : placement.labels) {
+        PeakCallOut* callout = label.callout;
+        if (label.peak >= 0) {
+            callout->setSeries(label.series);
+            if (QXYSeries* series = qobject_cast<QXYSeries*>(label.series.data()))
+                callout->setColor(series->color());
+            callout->setText(label.text, label.anchor);
+            callout->setPriority(label.priority);
+            used = qMax(used, label.peak + 1);
+        }
+        callout->setPos(label.position);
+        callout->setVisible(label.visible);
+    }
+    for (int i = used; i < m_peak_labels.size(); ++i) {
+        if (m_peak_labels[i])
+            m_peak_labels[i]->setVisible(false);
+    }
+    m_used_peak_labels = used;
+    return true;
+}
+
+PeakCallOut* CalloutLayout::peakLabel(int index)
+{
+    while (m_peak_labels.size() <= index)
+        m_peak_labels.append(nullptr);
+    if (!m_peak_labels[index]) {
+        PeakCallOut* label = new PeakCallOut(m_chart);
+        // Pooled labels change their peak on every pass, dragging them makes no sense
+        label->setFlag(QGraphicsItem::ItemIsMovable, false);
+        label->setZValue(11);
+        if (m_has_font)
+            label->setFont(m_font);
+        m_peak_labels[index] = label;
+    }
+    return m_peak_labels[index];
+}
+
+QPointF CalloutLayout::seriesMaximum(QXYSeries* series)
+{
+    auto it = m_anchors.constFind(series);
+    if (it != m_anchors.cend())
+        return it.value();
+
+    QPointF maximum;
+    const QList<QPointF> points = series->points();
+    if (!points.isEmpty()) {
+        maximum = points.first();
+        for (const QPointF& point : points) {
+            if (point.y() > maximum.y())
+                maximum = point;
+        }
+    }
+    m_anchors.insert(series, maximum);
+    return maximum;
+}
+
+void CalloutLayout::invalidateAnchor(const QAbstractSeries* series)
+{
+    m_anchors.remove(series);
+    invalidate();
+}
+
+void CalloutLayout::invalidate()
+{
+    ++m_generation;
+    scheduleLayout();
+}
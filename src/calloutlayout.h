@@ -0,0 +1,215 @@
+/*
+ * CuteCharts - Placement of peak callouts without overlaps
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QRectF>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include <QtGui/QFont>
+
+#include "axistransform.h"
+
+class QAbstractSeries;
+class QChart;
+class QValueAxis;
+class QXYSeries;
+
+class PeakCallOut;
+class PeakPicker;
+
+/**
+ * @brief Owns the callouts of a chart and decides where their labels go
+ *
+ * Every pass maps the anchors to the plot area and places the labels one by
+ * one, highest priority and highest anchor first. A label tries a few slots
+ * above its anchor, then below; slots are checked against the labels already
+ * placed through a uniform grid over the plot area, so a pass is linear in the
+ * number of callouts. Labels without a free slot are hidden until the view
+ * changes. Labels moved by the user stay where they are and block their slot.
+ *
+ * With a PeakPicker attached, the most prominent peaks inside the plot area
+ * get labels as well, drawn from a small pool of callouts; at most
+ * maximumPeakLabels() are shown, so zooming in reveals smaller peaks.
+ *
+ * Passes run after zoom, resize and visibility changes, at most once per frame.
+ * The outcome of a pass can be taken as a Placement and put back later, for
+ * instance when the zoom history returns to a viewport it has seen before.
+ */
+class CalloutLayout : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Where the last pass put the labels
+     *
+     * Only valid for the plot area and the generation it was taken with; the
+     * generation changes with anything but the axis ranges and the plot area.
+     */
+    struct Placement {
+        struct Label {
+            QPointer<PeakCallOut> callout;
+            QPointF position;
+            bool visible = false;
+            bool pinned = false;
+            // Pooled peak labels change their content on every pass
+            int peak = -1;
+            QPointer<QAbstractSeries> series;
+            QString text;
+            QPointF anchor;
+            qreal priority = 0;
+        };
+
+        QRectF area;
+        quint64 generation = 0;
+        QVector<Label> labels;
+
+        inline bool isValid() const { return generation != 0; }
+    };
+
+    explicit CalloutLayout(QChart* chart, QObject* parent = nullptr);
+    ~CalloutLayout() override;
+
+    /**
+     * @brief Add a callout with the name of a series at its maximum
+     *
+     * The maximum is cached and only searched again after the points changed.
+     * @param series Series to label
+     * @return The callout, owned by the layout
+     */
+    PeakCallOut* addSeriesCallout(QXYSeries* series);
+
+    /**
+     * @brief Take over a callout with an anchor of its own
+     * @param callout Callout created on the chart of this layout
+     */
+    void addCallout(PeakCallOut* callout);
+
+    /**
+     * @brief Delete all callouts of a series
+     */
+    void removeCallouts(const QAbstractSeries* series);
+
+    /**
+     * @brief Delete all callouts
+     */
+    void clear();
+
+    bool hasCallout(const QAbstractSeries* series) const;
+    inline int count() const { return m_items.size(); }
+
+    /**
+     * @brief Show or hide all callouts
+     */
+    void setEnabled(bool enabled);
+    inline bool isEnabled() const { return m_enabled; }
+
+    void setFont(const QFont& font);
+
+    /**
+     * @brief Label the peaks found by a picker, nullptr removes the peak labels
+     */
+    void setPeakPicker(PeakPicker* picker);
+
+    /**
+     * @brief Number of peak labels shown at once
+     */
+    void setMaximumPeakLabels(int count);
+    inline int maximumPeakLabels() const { return m_max_peak_labels; }
+
+    /**
+     * @brief Transform of the x axis, peak labels show the data value
+     */
+    void setLabelTransform(const AxisTransform& transform);
+
+    /**
+     * @brief Run a pass whenever the range of an axis changes
+     */
+    void trackAxis(QValueAxis* axis);
+
+    /**
+     * @brief Outcome of the last pass
+     */
+    Placement placement() const;
+
+    /**
+     * @brief Put the labels where an earlier pass placed them, skipping the pending pass
+     * @param placement Placement taken for the current axis ranges
+     * @return False if the placement is outdated, a pass is then still due
+     */
+    bool restorePlacement(const Placement& placement);
+
+public slots:
+    /**
+     * @brief Run a pass on the next frame
+     */
+    void scheduleLayout();
+
+    /**
+     * @brief Run a pass now
+     */
+    void relayout();
+
+signals:
+    /**
+     * @brief Emitted after every pass
+     */
+    void laidOut();
+
+private:
+    struct Item {
+        QPointer<PeakCallOut> callout;
+        const QAbstractSeries* series = nullptr; ///< Kept to find the callouts of a destroyed series
+        bool seriesAnchor = false;
+    };
+
+    /**
+     * @brief Cached point of maximum y of a series
+     */
+    QPointF seriesMaximum(QXYSeries* series);
+
+    void invalidateAnchor(const QAbstractSeries* series);
+
+    /**
+     * @brief Outdate earlier placements and schedule a pass
+     */
+    void invalidate();
+
+    /**
+     * @brief Pooled callout for a peak label, created on demand
+     */
+    PeakCallOut* peakLabel(int index);
+
+    QPointer<QChart> m_chart;
+    QPointer<PeakPicker> m_picker;
+    QVector<Item> m_items;
+    QVector<QPointer<PeakCallOut>> m_peak_labels;
+    QHash<const QAbstractSeries*, QPointF> m_anchors;
+    QTimer m_timer;
+    QFont m_font;
+    int m_max_peak_labels = 40;
+    int m_used_peak_labels = 0;
+    quint64 m_generation = 1;
+    AxisTransform m_label_transform;
+    bool m_enabled = true, m_has_font = false;
+};
@@ -10,6 +10,7 @@
 
 #include "chartaxismanager.h"
 #include "chartviewprivate.h"
+#include "tickengine.h"
 
 #include <QtCharts/QChart>
 #include <QtCharts/QXYSeries>
@@ -83,7 +84,7 @@ void ChartAxisManager::setXRange(qreal min, qreal max, bool nice)
             m_xAxis->setMin(min);
             m_xAxis->setMax(max);
         }
-        m_xAxis->setTickInterval(ChartTools::CustomCeil(max + min) / 10.0);
+        m_xAxis->setTickInterval(calculateTickInterval(min, max));
 
         m_xMin = min;
         m_xMax = max;
@@ -110,7 +111,7 @@ void ChartAxisManager::setYRange(qreal min, qreal max, bool nice)
             m_yAxis->setMin(min);
             m_yAxis->setMax(max);
         }
-        m_yAxis->setTickInterval(ChartTools::CustomCeil(max + min) / 10.0);
+        m_yAxis->setTickInterval(calculateTickInterval(min, max));
 
         m_yMin = min;
         m_yMax = max;
@@ -364,7 +365,7 @@ void ChartAxisManager::scaleAxis(QPointer<QValueAxis> axis, qreal& min, qreal& m
         }
     }
 
-    int ticks = ChartTools::ScaleToNormalizedRange(max - min) / int(ChartTools::ScaleToNormalizedRange(max - min) / 5) + 1;
+    int ticks = qMax(2, TickEngine::compute(min, max, 6).count);
     axis->setTickCount(ticks);
     axis->setRange(min, max);
 
@@ -380,8 +381,7 @@ qreal ChartAxisManager::calculateTickInterval(qreal min, qreal max) const
         return 1.0;
     }
 
-    // Use ChartTools for consistent tick intervals
-    return ChartTools::CustomCeil(range) / 10.0;
+    return TickEngine::compute(min, max, 11).interval;
 }
 
 void ChartAxisManager::updateAxisAppearance()
@@ -46,6 +46,152 @@
 
 #include "chartconfig.h"
 
+namespace {
+bool readValue(const QJsonValue& value, bool& field)
+{
+    if (value.isBool())
+        field = value.toBool();
+    else if (value.isDouble())
+        field = value.toDouble() != 0;
+    else
+        return false;
+    return true;
+}
+
+bool readValue(const QJsonValue& value, int& field)
+{
+    if (!value.isDouble())
+        return false;
+    field = value.toInt(qRound(value.toDouble()));
+    return true;
+}
+
+bool readValue(const QJsonValue& value, qreal& field)
+{
+    if (!value.isDouble())
+        return false;
+    field = value.toDouble();
+    return true;
+}
+
+bool readValue(const QJsonValue& value, QString& field)
+{
+    if (!value.isString())
+        return false;
+    field = value.toString();
+    return true;
+}
+
+template <typename T>
+void readField(const QJsonObject& json, const char* key, T& field, QStringList* errors)
+{
+    const auto value = json.constFind(QLatin1String(key));
+    if (value == json.constEnd())
+        return;
+    if (!readValue(*value, field) && errors)
+        errors->append(QStringLiteral("%1 has an unexpected type, using the default").arg(QLatin1String(key)));
+}
+
+template <typename T>
+void checkField(bool valid, const char* key, T& field, const T& fallback, QStringList* errors)
+{
+    if (valid)
+        return;
+    if (errors)
+        errors->append(QStringLiteral("%1 is out of range, using the default").arg(QLatin1String(key)));
+    field = fallback;
+}
+}
+
+#define CUTECHARTS_CONFIG_READ(type, name, key, value) readField(json, key, config.name, errors);
+#define CUTECHARTS_CONFIG_WRITE(type, name, key, value) json[QLatin1String(key)] = name;
+#define CUTECHARTS_CONFIG_DIFF(type, name, key, value) changes[name##Field] = !(name == other.name);
+
+ChartAxisConfig ChartAxisConfig::fromJson(const QJsonObject& json, QStringList* errors)
+{
+    ChartAxisConfig config;
+    CUTECHARTS_AXIS_CONFIG_FIELDS(CUTECHARTS_CONFIG_READ)
+    config.present = !json.isEmpty();
+    config.validate(errors);
+    return config;
+}
+
+QJsonObject ChartAxisConfig::toJson() const
+{
+    QJsonObject json;
+    CUTECHARTS_AXIS_CONFIG_FIELDS(CUTECHARTS_CONFIG_WRITE)
+    return json;
+}
+
+void ChartAxisConfig::validate(QStringList* errors)
+{
+    checkField(tickType == 0 || tickType == 1, "TickType", tickType, 0, errors);
+    checkField(tickCount >= 2, "TickCount", tickCount, 5, errors);
+    checkField(minorTickCount >= 0, "MinorTickCount", minorTickCount, 0, errors);
+    checkField(tickInterval > 0, "TickInterval", tickInterval, qreal(1), errors);
+    // An empty range is kept, the axis shows it as it did before
+    if (present && !(max > min) && errors)
+        errors->append(QStringLiteral("Min is not below Max"));
+}
+
+ChartAxisConfig::Changes ChartAxisConfig::diff(const ChartAxisConfig& other) const
+{
+    Changes changes;
+    CUTECHARTS_AXIS_CONFIG_FIELDS(CUTECHARTS_CONFIG_DIFF)
+    return changes;
+}
+
+ChartConfig ChartConfig::fromJson(const QJsonObject& json, QStringList* errors)
+{
+    ChartConfig config;
+    CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_READ)
+    config.xAxis = ChartAxisConfig::fromJson(json["xAxis"].toObject(), errors);
+    config.yAxis = ChartAxisConfig::fromJson(json["yAxis"].toObject(), errors);
+
+    config.extra = json;
+#define CUTECHARTS_CONFIG_REMOVE(type, name, key, value) config.extra.remove(QLatin1String(key));
+    CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_REMOVE)
+#undef CUTECHARTS_CONFIG_REMOVE
+    config.extra.remove("xAxis");
+    config.extra.remove("yAxis");
+
+    config.validate(errors);
+    return config;
+}
+
+QJsonObject ChartConfig::toJson() const
+{
+    QJsonObject json = extra;
+    CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_WRITE)
+    if (xAxis.present)
+        json["xAxis"] = xAxis.toJson();
+    if (yAxis.present)
+        json["yAxis"] = yAxis.toJson();
+    return json;
+}
+
+void ChartConfig::validate(QStringList* errors)
+{
+    checkField(xSize > 0, "xSize", xSize, 600, errors);
+    checkField(ySize > 0, "ySize", ySize, 400, errors);
+    checkField(scaling >= 1, "Scaling", scaling, 2, errors);
+    checkField(lineWidth >= 0, "lineWidth", lineWidth, qreal(4), errors);
+    checkField(markerSize >= 0, "markerSize", markerSize, qreal(8), errors);
+    checkField(theme >= 0 && theme <= 8, "Theme", theme, 0, errors);
+    checkField(alignment == Qt::AlignTop || alignment == Qt::AlignBottom || alignment == Qt::AlignLeft || alignment == Qt::AlignRight,
+        "Alignment", alignment, int(Qt::AlignRight), errors);
+}
+
+ChartConfig::Changes ChartConfig::diff(const ChartConfig& other) const
+{
+    Changes result;
+    std::bitset<FieldCount>& changes = result.chart;
+    CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_DIFF)
+    result.xAxis = xAxis.present != other.xAxis.present ? ChartAxisConfig::Changes().set() : xAxis.diff(other.xAxis);
+    result.yAxis = yAxis.present != other.yAxis.present ? ChartAxisConfig::Changes().set() : yAxis.diff(other.yAxis);
+    return result;
+}
+
 ChartConfigDialog::ChartConfigDialog(QWidget* widget)
     : QDialog(widget)
 {
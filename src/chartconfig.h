@@ -20,10 +20,14 @@
 #pragma once
 
 #include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
 
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QDialog>
 
+#include <bitset>
+
 class QCheckBox;
 class QComboBox;
 class QLineEdit;
@@ -34,6 +38,142 @@ class QDialogButtonBox;
 
 class AxisConfig;
 
+/* Every config field is listed once: type, member, JSON key and default.
+ * Members, JSON (de)serialization and change tracking are generated from it. */
+#define CUTECHARTS_AXIS_CONFIG_FIELDS(X)                      \
+    X(QString, title, "Title", QString())                     \
+    X(qreal, min, "Min", 0.0)                                 \
+    X(qreal, max, "Max", 10.0)                                \
+    X(bool, showAxis, "showAxis", true)                       \
+    X(int, tickType, "TickType", 0)                           \
+    X(qreal, tickAnchor, "TickAnchor", 0.0)                   \
+    X(QString, tickFormat, "TickFormat", QStringLiteral("%2.2f")) \
+    X(qreal, tickInterval, "TickInterval", 1.0)               \
+    X(int, tickCount, "TickCount", 5)                         \
+    X(int, minorTickCount, "MinorTickCount", 0)               \
+    X(bool, minorVisible, "MinorVisible", false)              \
+    X(bool, majorVisible, "MajorVisible", true)               \
+    X(QString, titleFont, "TitleFont", QString())             \
+    X(QString, ticksFont, "TicksFont", QString())
+
+#define CUTECHARTS_CHART_CONFIG_FIELDS(X)                     \
+    X(QString, title, "Title", QString())                     \
+    X(bool, legend, "Legend", false)                          \
+    X(bool, scalingLocked, "ScalingLocked", false)            \
+    X(bool, annotation, "Annotation", false)                  \
+    X(int, xSize, "xSize", 600)                               \
+    X(int, ySize, "ySize", 400)                               \
+    X(int, scaling, "Scaling", 2)                             \
+    X(qreal, lineWidth, "lineWidth", 4.0)                     \
+    X(qreal, markerSize, "markerSize", 8.0)                   \
+    X(int, theme, "Theme", 0)                                 \
+    X(bool, cropImage, "cropImage", true)                     \
+    X(bool, transparentImage, "transparentImage", true)       \
+    X(bool, emphasizeAxis, "emphasizeAxis", true)             \
+    X(bool, noGrid, "noGrid", true)                           \
+    X(int, alignment, "Alignment", int(Qt::AlignRight))       \
+    X(QString, keyFont, "KeyFont", QString())                 \
+    X(QString, titleFont, "TitleFont", QString())
+
+#define CUTECHARTS_CONFIG_MEMBER(type, name, key, value) type name = value;
+#define CUTECHARTS_CONFIG_FIELD(type, name, key, value) name##Field,
+
+/**
+ * @brief Typed configuration of one value axis
+ */
+struct ChartAxisConfig {
+    enum Field {
+        CUTECHARTS_AXIS_CONFIG_FIELDS(CUTECHARTS_CONFIG_FIELD)
+            FieldCount
+    };
+    using Changes = std::bitset<FieldCount>;
+
+    CUTECHARTS_AXIS_CONFIG_FIELDS(CUTECHARTS_CONFIG_MEMBER)
+
+    bool present = false; ///< False if the JSON the config was read from had no such axis
+
+    /**
+     * @brief Read an axis config, missing keys keep their defaults
+     * @param json Axis object
+     * @param errors Receives type and range errors, may be nullptr
+     * @return The validated config
+     */
+    static ChartAxisConfig fromJson(const QJsonObject& json, QStringList* errors = nullptr);
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Fix out of range values
+     * @param errors Receives a message per fixed value, may be nullptr
+     */
+    void validate(QStringList* errors = nullptr);
+
+    /**
+     * @brief Compare field by field
+     * @param other Config to compare with
+     * @return One bit per differing field
+     */
+    Changes diff(const ChartAxisConfig& other) const;
+
+    static Changes fontFields() { return Changes().set(titleFontField).set(ticksFontField); }
+};
+
+/**
+ * @brief Typed chart configuration
+ *
+ * The source of truth for ChartView; JSON is only read and written at the
+ * API and persistence boundaries. Keys unknown to the struct are kept in
+ * extra and written back unchanged.
+ */
+struct ChartConfig {
+    enum Field {
+        CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_FIELD)
+            FieldCount
+    };
+
+    struct Changes {
+        std::bitset<FieldCount> chart;
+        ChartAxisConfig::Changes xAxis, yAxis;
+
+        bool any() const { return chart.any() || xAxis.any() || yAxis.any(); }
+        bool test(Field field) const { return chart.test(field); }
+        static Changes all()
+        {
+            Changes changes;
+            changes.chart.set();
+            changes.xAxis.set();
+            changes.yAxis.set();
+            return changes;
+        }
+    };
+
+    CUTECHARTS_CHART_CONFIG_FIELDS(CUTECHARTS_CONFIG_MEMBER)
+
+    ChartAxisConfig xAxis, yAxis;
+    QJsonObject extra;
+
+    /**
+     * @brief Read a chart config, missing keys keep their defaults
+     * @param json Config object
+     * @param errors Receives type and range errors, may be nullptr
+     * @return The validated config
+     */
+    static ChartConfig fromJson(const QJsonObject& json, QStringList* errors = nullptr);
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Fix out of range values
+     * @param errors Receives a message per fixed value, may be nullptr
+     */
+    void validate(QStringList* errors = nullptr);
+
+    /**
+     * @brief Compare field by field, axes included
+     * @param other Config to compare with
+     * @return Bits of the differing fields
+     */
+    Changes diff(const ChartConfig& other) const;
+};
+
 class ChartConfigDialog : public QDialog {
     Q_OBJECT
 
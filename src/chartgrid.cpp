@@ -0,0 +1,319 @@
+/*
+ * CuteCharts - Small multiples of charts in one scene
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QChart>
+#include <QtCharts/QLegend>
+#include <QtCharts/QValueAxis>
+#include <QtCharts/QXYSeries>
+
+#include <QtGui/QContextMenuEvent>
+
+#include <QtWidgets/QGraphicsGridLayout>
+#include <QtWidgets/QGraphicsScene>
+#include <QtWidgets/QGraphicsWidget>
+#include <QtWidgets/QMenu>
+
+#include <limits>
+
+#include "axislinkgroup.h"
+#include "chartview.h"
+#include "tools.h"
+
+#include "chartgrid.h"
+
+ChartGrid::ChartGrid(int rows, int columns, QWidget* parent)
+    : QGraphicsView(parent)
+    , m_rows(qMax(1, rows))
+    , m_columns(qMax(1, columns))
+    , m_config(ChartConfig::fromJson(DefaultConfig))
+{
+    QGraphicsScene* scene = new QGraphicsScene(this);
+    setScene(scene);
+    setRenderHint(QPainter::Antialiasing);
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    m_container = new QGraphicsWidget;
+    m_layout = new QGraphicsGridLayout;
+    m_layout->setContentsMargins(0, 0, 0, 0);
+    m_layout->setSpacing(0);
+    m_container->setLayout(m_layout);
+    scene->addItem(m_container);
+
+    m_panels.resize(m_rows * m_columns);
+    for (int row = 0; row < m_rows; ++row) {
+        for (int column = 0; column < m_columns; ++column) {
+            Panel& panel = m_panels[row * m_columns + column];
+
+            panel.chart = new QChart;
+            panel.chart->setAnimationOptions(QChart::NoAnimation);
+            panel.chart->setBackgroundRoundness(0);
+            panel.chart->setMargins(QMargins(2, 2, 2, 2));
+            panel.chart->legend()->setVisible(false);
+
+            panel.x = new QValueAxis;
+            panel.y = new QValueAxis;
+            panel.chart->addAxis(panel.x, Qt::AlignBottom);
+            panel.chart->addAxis(panel.y, Qt::AlignLeft);
+
+            m_layout->addItem(panel.chart, row, column);
+        }
+    }
+    setLinks(m_links);
+    applyConfig(ChartConfig::Changes::all());
+}
+
+const ChartGrid::Panel* ChartGrid::panel(int row, int column) const
+{
+    if (row < 0 || row >= m_rows || column < 0 || column >= m_columns)
+        return nullptr;
+    return &m_panels[row * m_columns + column];
+}
+
+QChart* ChartGrid::chart(int row, int column) const
+{
+    const Panel* cell = panel(row, column);
+    return cell ? cell->chart : nullptr;
+}
+
+QValueAxis* ChartGrid::xAxis(int row, int column) const
+{
+    const Panel* cell = panel(row, column);
+    return cell ? cell->x : nullptr;
+}
+
+QValueAxis* ChartGrid::yAxis(int row, int column) const
+{
+    const Panel* cell = panel(row, column);
+    return cell ? cell->y : nullptr;
+}
+
+void ChartGrid::addSeries(int row, int column, QAbstractSeries* series)
+{
+    const Panel* cell = panel(row, column);
+    if (!cell || !series)
+        return;
+
+    cell->chart->addSeries(series);
+    series->attachAxis(cell->x);
+    series->attachAxis(cell->y);
+}
+
+void ChartGrid::setPanelTitle(int row, int column, const QString& title)
+{
+    if (const Panel* cell = panel(row, column))
+        cell->chart->setTitle(title);
+}
+
+void ChartGrid::setLinks(Links links)
+{
+    m_links = links;
+    qDeleteAll(m_groups);
+    m_groups.clear();
+
+    // One group per column for x and one per row for y
+    if (m_links.testFlag(LinkColumns)) {
+        for (int column = 0; column < m_columns; ++column) {
+            AxisLinkGroup* group = new AxisLinkGroup(AxisLinkGroup::X, this);
+            for (int row = 0; row < m_rows; ++row)
+                group->addAxis(m_panels[row * m_columns + column].x, Qt::Horizontal);
+            m_groups.append(group);
+        }
+    }
+    if (m_links.testFlag(LinkRows)) {
+        for (int row = 0; row < m_rows; ++row) {
+            AxisLinkGroup* group = new AxisLinkGroup(AxisLinkGroup::Y, this);
+            for (int column = 0; column < m_columns; ++column)
+                group->addAxis(m_panels[row * m_columns + column].y, Qt::Vertical);
+            m_groups.append(group);
+        }
+    }
+}
+
+void ChartGrid::rescale()
+{
+    struct Extent {
+        qreal min = std::numeric_limits<qreal>::max();
+        qreal max = std::numeric_limits<qreal>::lowest();
+
+        void add(qreal value)
+        {
+            min = qMin(min, value);
+            max = qMax(max, value);
+        }
+        void add(const Extent& other)
+        {
+            min = qMin(min, other.min);
+            max = qMax(max, other.max);
+        }
+        bool valid() const { return min <= max; }
+    };
+
+    QVector<Extent> x(m_panels.size()), y(m_panels.size());
+    for (int i = 0; i < m_panels.size(); ++i) {
+        for (QAbstractSeries* series : m_panels[i].chart->series()) {
+            QXYSeries* xy = qobject_cast<QXYSeries*>(series);
+            if (!xy || !xy->isVisible())
+                continue;
+            for (const QPointF& point : xy->points()) {
+                x[i].add(point.x());
+                y[i].add(point.y());
+            }
+        }
+    }
+
+    // Linked axes all get the union of their panels
+    if (m_links.testFlag(LinkColumns)) {
+        for (int column = 0; column < m_columns; ++column) {
+            Extent shared;
+            for (int row = 0; row < m_rows; ++row)
+                shared.add(x[row * m_columns + column]);
+            for (int row = 0; row < m_rows; ++row)
+                x[row * m_columns + column] = shared;
+        }
+    }
+    if (m_links.testFlag(LinkRows)) {
+        for (int row = 0; row < m_rows; ++row) {
+            Extent shared;
+            for (int column = 0; column < m_columns; ++column)
+                shared.add(y[row * m_columns + column]);
+            for (int column = 0; column < m_columns; ++column)
+                y[row * m_columns + column] = shared;
+        }
+    }
+
+    // Linked members already get the shared range, so the groups have nothing to do
+    for (int i = 0; i < m_panels.size(); ++i) {
+        if (x[i].valid()) {
+            m_panels[i].x->setRange(x[i].min, x[i].max);
+            m_panels[i].x->applyNiceNumbers();
+        }
+        if (y[i].valid()) {
+            m_panels[i].y->setRange(y[i].min, y[i].max);
+            m_panels[i].y->applyNiceNumbers();
+        }
+    }
+}
+
+void ChartGrid::setChartConfig(const QJsonObject& config)
+{
+    ChartConfig next = ChartConfig::fromJson(config);
+    const ChartConfig::Changes changes = next.diff(m_config);
+    m_config = std::move(next);
+    applyConfig(changes);
+}
+
+QJsonObject ChartGrid::chartConfig() const
+{
+    return m_config.toJson();
+}
+
+void ChartGrid::applyConfig(const ChartConfig::Changes& changes)
+{
+    const ChartConfig& config = m_config;
+
+    // Fonts are parsed once and shared implicitly by all panels
+    QFont titleFont, keyFont, xTitleFont, xTicksFont, yTitleFont, yTicksFont;
+    titleFont.fromString(config.titleFont);
+    keyFont.fromString(config.keyFont);
+    xTitleFont.fromString(config.xAxis.titleFont);
+    xTicksFont.fromString(config.xAxis.ticksFont);
+    yTitleFont.fromString(config.yAxis.titleFont);
+    yTicksFont.fromString(config.yAxis.ticksFont);
+
+    // A new theme resets fonts and axis appearance of a chart
+    const bool theme = changes.test(ChartConfig::themeField);
+    const bool xAxis = theme || (config.xAxis.present && changes.xAxis.any());
+    const bool yAxis = theme || (config.yAxis.present && changes.yAxis.any());
+
+    auto updateAxis = [](QValueAxis* axis, const ChartAxisConfig& axisConfig, const QFont& title, const QFont& ticks) {
+        axis->setVisible(axisConfig.showAxis);
+        axis->setTickType(axisConfig.tickType == 0 ? QValueAxis::TicksDynamic : QValueAxis::TicksFixed);
+        axis->setTickAnchor(axisConfig.tickAnchor);
+        axis->setLabelFormat(axisConfig.tickFormat);
+        axis->setTickInterval(axisConfig.tickInterval);
+        axis->setTickCount(axisConfig.tickCount);
+        axis->setMinorTickCount(axisConfig.minorTickCount);
+        axis->setMinorGridLineVisible(axisConfig.minorVisible);
+        axis->setTitleFont(title);
+        axis->setLabelsFont(ticks);
+    };
+
+    for (const Panel& panel : qAsConst(m_panels)) {
+        if (theme) {
+            if (config.theme < 8) {
+                panel.chart->setTheme(static_cast<QChart::ChartTheme>(config.theme));
+            } else {
+                panel.chart->setBackgroundBrush(QBrush(Qt::transparent));
+                panel.chart->setTitleBrush(QBrush(Qt::black));
+                for (QValueAxis* axis : { panel.x, panel.y }) {
+                    axis->setTitleBrush(QBrush(Qt::black));
+                    axis->setLabelsBrush(QBrush(Qt::black));
+                }
+            }
+        }
+
+        if (theme || changes.test(ChartConfig::titleFontField))
+            panel.chart->setTitleFont(titleFont);
+
+        if (theme || changes.test(ChartConfig::keyFontField) || changes.test(ChartConfig::legendField) || changes.test(ChartConfig::alignmentField)) {
+            panel.chart->legend()->setFont(keyFont);
+            panel.chart->legend()->setVisible(config.legend);
+            panel.chart->legend()->setAlignment(Qt::Alignment(config.alignment));
+        }
+
+        if (xAxis)
+            updateAxis(panel.x, config.xAxis, xTitleFont, xTicksFont);
+        if (yAxis)
+            updateAxis(panel.y, config.yAxis, yTitleFont, yTicksFont);
+    }
+}
+
+void ChartGrid::plotSettings()
+{
+    if (!m_dialog) {
+        m_dialog = new ChartConfigDialog(this);
+        connect(m_dialog, &ChartConfigDialog::ConfigChanged, this, [this](const QJsonObject& config) {
+            setChartConfig(ChartTools::MergeJsonObject(chartConfig(), config));
+            emit configurationChanged();
+        });
+        connect(m_dialog, &ChartConfigDialog::ScaleAxis, this, &ChartGrid::rescale);
+    }
+    m_dialog->setChartConfig(chartConfig());
+    m_dialog->show();
+    m_dialog->raise();
+    m_dialog->activateWindow();
+}
+
+void ChartGrid::resizeEvent(QResizeEvent* event)
+{
+    QGraphicsView::resizeEvent(event);
+    const QSizeF size = viewport()->size();
+    m_container->setGeometry(QRectF(QPointF(0, 0), size));
+    setSceneRect(QRectF(QPointF(0, 0), size));
+}
+
+void ChartGrid::contextMenuEvent(QContextMenuEvent* event)
+{
+    QMenu menu(this);
+    menu.addAction(tr("Plot Settings"), this, &ChartGrid::plotSettings);
+    menu.addAction(tr("Rescale Axis"), this, &ChartGrid::rescale);
+    menu.exec(event->globalPos());
+}
@@ -0,0 +1,144 @@
+/*
+ * CuteCharts - Small multiples of charts in one scene
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QVector>
+#include <QtWidgets/QGraphicsView>
+
+#include "chartconfig.h"
+
+class QAbstractSeries;
+class QChart;
+class QGraphicsGridLayout;
+class QGraphicsWidget;
+class QValueAxis;
+
+class AxisLinkGroup;
+
+/**
+ * @brief A rows x columns grid of charts sharing one scene and one view
+ *
+ * All panels are QChart items of a single QGraphicsScene, so the whole grid
+ * is painted in one pass of one viewport. Theme, fonts and axis appearance
+ * come from one shared ChartConfig and one lazily created config dialog;
+ * panel titles, axis titles and ranges stay per panel. X axes can be linked
+ * within a column and y axes within a row through AxisLinkGroup.
+ */
+class ChartGrid : public QGraphicsView {
+    Q_OBJECT
+
+public:
+    enum Link {
+        NoLink = 0,
+        LinkColumns = 1, ///< Panels of a column share the x range
+        LinkRows = 2 ///< Panels of a row share the y range
+    };
+    Q_DECLARE_FLAGS(Links, Link)
+
+    /**
+     * @brief Create a grid of empty panels
+     * @param rows Number of rows, at least one
+     * @param columns Number of columns, at least one
+     * @param parent Parent widget
+     */
+    ChartGrid(int rows, int columns, QWidget* parent = nullptr);
+
+    int rows() const { return m_rows; }
+    int columns() const { return m_columns; }
+
+    /**
+     * @brief Access a panel
+     * @return The chart, nullptr if the cell does not exist
+     */
+    QChart* chart(int row, int column) const;
+    QValueAxis* xAxis(int row, int column) const;
+    QValueAxis* yAxis(int row, int column) const;
+
+    /**
+     * @brief Add a series to a panel and attach the panel axes
+     * @param row Row of the panel
+     * @param column Column of the panel
+     * @param series Series, the chart takes ownership
+     */
+    void addSeries(int row, int column, QAbstractSeries* series);
+
+    /**
+     * @brief Set the title of a single panel
+     */
+    void setPanelTitle(int row, int column, const QString& title);
+
+    /**
+     * @brief Select which axes follow each other
+     * @param links Combination of Link flags
+     */
+    void setLinks(Links links);
+    Links links() const { return m_links; }
+
+    /**
+     * @brief Apply the shared appearance to all panels
+     *
+     * Only theme, fonts, legend and axis tick settings are used, titles and
+     * ranges are left to the panels.
+     * @param config Chart configuration as written by ChartView
+     */
+    void setChartConfig(const QJsonObject& config);
+    QJsonObject chartConfig() const;
+
+public slots:
+    /**
+     * @brief Fit all axes to the data, linked axes to the union of their panels
+     */
+    void rescale();
+
+    /**
+     * @brief Open the config dialog shared by all panels
+     */
+    void plotSettings();
+
+signals:
+    void configurationChanged();
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+
+private:
+    struct Panel {
+        QChart* chart = nullptr;
+        QValueAxis* x = nullptr;
+        QValueAxis* y = nullptr;
+    };
+
+    const Panel* panel(int row, int column) const;
+    void applyConfig(const ChartConfig::Changes& changes);
+
+    int m_rows, m_columns;
+    QVector<Panel> m_panels;
+    QGraphicsWidget* m_container;
+    QGraphicsGridLayout* m_layout;
+    Links m_links = LinkColumns;
+    QVector<AxisLinkGroup*> m_groups;
+
+    ChartConfig m_config;
+    ChartConfigDialog* m_dialog = nullptr;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ChartGrid::Links)
@@ -19,11 +19,24 @@
 
 #pragma once
 
+#include "axislinkgroup.h"
+#include "axistransform.h"
 #include "boxwhisker.h"
+#include "calloutlayout.h"
 #include "chartconfig.h"
+#include "chartgrid.h"
+#include "chartsnapshot.h"
 #include "chartview.h"
 #include "chartviewprivate.h"
+#include "dataloader.h"
 #include "listchart.h"
+#include "markerlines.h"
 #include "peakcallout.h"
+#include "peakpicker.h"
+#include "samplestore.h"
 #include "series.h"
+#include "serieslistmodel.h"
+#include "seriesregistry.h"
+#include "tickengine.h"
 #include "tools.h"
+#include "zoomhistory.h"
@@ -0,0 +1,438 @@
+/*
+ * CuteCharts - Binary chart snapshots
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QScatterSeries>
+#include <QtCharts/QXYSeries>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "axistransform.h"
+#include "chartview.h"
+#include "listchart.h"
+#include "parallel.h"
+#include "series.h"
+
+#include "chartsnapshot.h"
+
+namespace {
+const char Magic[8] = { 'C', 'U', 'T', 'E', 'S', 'N', 'A', 'P' };
+
+struct Block {
+    qreal* values;
+    qsizetype count;
+    const uchar* data = nullptr;
+    qsizetype size = 0;
+    QByteArray encoded;
+};
+
+QByteArray encodeBlock(const qreal* values, qsizetype count)
+{
+    QByteArray planes(count * 8, Qt::Uninitialized);
+    uchar* out = reinterpret_cast<uchar*>(planes.data());
+    quint64 previous = 0;
+    for (qsizetype i = 0; i < count; ++i) {
+        quint64 bits;
+        std::memcpy(&bits, values + i, sizeof(bits));
+        const quint64 delta = bits ^ previous;
+        previous = bits;
+        for (int plane = 0; plane < 8; ++plane)
+            out[plane * count + i] = uchar(delta >> (8 * plane));
+    }
+    return qCompress(planes);
+}
+
+bool decodeBlock(const uchar* data, qsizetype size, qreal* values, qsizetype count)
+{
+    const QByteArray planes = qUncompress(data, size);
+    if (planes.size() != count * 8)
+        return false;
+
+    const uchar* in = reinterpret_cast<const uchar*>(planes.constData());
+    quint64 previous = 0;
+    for (qsizetype i = 0; i < count; ++i) {
+        quint64 delta = 0;
+        for (int plane = 0; plane < 8; ++plane)
+            delta |= quint64(in[plane * count + i]) << (8 * plane);
+        previous ^= delta;
+        std::memcpy(values + i, &previous, sizeof(previous));
+    }
+    return true;
+}
+
+qsizetype blockCount(qsizetype values)
+{
+    return (values + ChartSnapshot::BlockSize - 1) / ChartSnapshot::BlockSize;
+}
+
+ChartSnapshot::Series captureSeries(const ChartView* view, const QAbstractSeries* abstract, int group, bool callout)
+{
+    ChartSnapshot::Series series;
+    const QXYSeries* xy = qobject_cast<const QXYSeries*>(abstract);
+    series.name = xy->name();
+    series.color = xy->color();
+    series.group = group;
+    series.visible = xy->isVisible();
+    series.callout = callout;
+    series.type = xy->type();
+    if (const LineSeries* line = qobject_cast<const LineSeries*>(xy))
+        series.size = line->lineWidth();
+    else if (const QScatterSeries* scatter = qobject_cast<const QScatterSeries*>(xy))
+        series.size = scatter->markerSize();
+
+    // Compact storage is read sample by sample, a 10M sample trace is never expanded to points
+    if (const LineSeries* line = qobject_cast<const LineSeries*>(xy); line && line->hasCompactStorage()) {
+        const SampleStore& samples = line->samples();
+        series.x.resize(samples.size());
+        series.y.resize(samples.size());
+        qreal* x = series.x.data();
+        qreal* y = series.y.data();
+        ChartTools::ParallelFor(samples.size(), [&samples, x, y](qsizetype begin, qsizetype end, int) {
+            for (qsizetype i = begin; i < end; ++i) {
+                x[i] = samples.x(i);
+                y[i] = samples.y(i);
+            }
+        },
+            65536);
+        return series;
+    }
+
+    // Data values, not the transformed points of a log axis
+    const QList<QPointF> points = view->dataPoints(xy);
+    series.x.resize(points.size());
+    series.y.resize(points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        series.x[i] = points[i].x();
+        series.y[i] = points[i].y();
+    }
+    return series;
+}
+
+ChartSnapshot::Transform storeTransform(const AxisTransform& transform)
+{
+    ChartSnapshot::Transform stored;
+    if (transform.type() == AxisTransform::Type::Log10 || transform.type() == AxisTransform::Type::Symlog) {
+        stored.type = int(transform.type());
+        stored.constant = transform.constant();
+    }
+    return stored;
+}
+
+AxisTransform createTransform(const ChartSnapshot::Transform& stored)
+{
+    switch (AxisTransform::Type(stored.type)) {
+    case AxisTransform::Type::Log10:
+        return AxisTransform::log10();
+    case AxisTransform::Type::Symlog:
+        return AxisTransform::symlog(stored.constant);
+    default:
+        return AxisTransform();
+    }
+}
+
+QXYSeries* createSeries(const ChartSnapshot::Series& stored)
+{
+    QXYSeries* series;
+    if (stored.type == QAbstractSeries::SeriesTypeScatter) {
+        ScatterSeries* scatter = new ScatterSeries;
+        if (stored.size > 0)
+            scatter->setMarkerSize(stored.size);
+        series = scatter;
+    } else {
+        LineSeries* line = new LineSeries;
+        if (stored.size > 0)
+            line->setLineWidth(stored.size);
+        series = line;
+    }
+
+    QList<QPointF> points(stored.x.size());
+    QPointF* target = points.data();
+    const qreal* x = stored.x.constData();
+    const qreal* y = stored.y.constData();
+    ChartTools::ParallelFor(points.size(), [target, x, y](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            target[i] = QPointF(x[i], y[i]);
+    },
+        65536);
+    series->replace(points);
+    series->setName(stored.name);
+    series->setColor(stored.color);
+    return series;
+}
+}
+
+ChartSnapshot ChartSnapshot::capture(const ChartView* view)
+{
+    ChartSnapshot snapshot;
+    snapshot.config = view->getChartConfig();
+    snapshot.verticalLines = view->verticalLines();
+    snapshot.horizontalLines = view->horizontalLines();
+    snapshot.xTransform = storeTransform(view->axisTransform(Qt::Horizontal));
+    snapshot.yTransform = storeTransform(view->axisTransform(Qt::Vertical));
+
+    int group = 0;
+    for (QAbstractSeries* series : view->series()) {
+        if (qobject_cast<QXYSeries*>(series))
+            snapshot.series.append(captureSeries(view, series, group++, view->hasCallout(series)));
+    }
+    return snapshot;
+}
+
+ChartSnapshot ChartSnapshot::capture(const ListChart* chart)
+{
+    ListChart* list = const_cast<ListChart*>(chart);
+    ChartSnapshot snapshot = capture(list->chart());
+    snapshot.series.clear();
+
+    for (int group : chart->groups()) {
+        for (QAbstractSeries* series : chart->groupSeries(group)) {
+            if (qobject_cast<QXYSeries*>(series))
+                snapshot.series.append(captureSeries(list->chart(), series, group, list->chart()->hasCallout(series)));
+        }
+    }
+    return snapshot;
+}
+
+void ChartSnapshot::restore(ChartView* view) const
+{
+    // Series added after the transforms are mapped once, the config holds ranges on the mapped axes
+    view->setAxisTransform(Qt::Horizontal, createTransform(xTransform));
+    view->setAxisTransform(Qt::Vertical, createTransform(yTransform));
+    for (const Series& stored : series) {
+        QXYSeries* created = createSeries(stored);
+        view->addSeries(created, stored.callout);
+        created->setVisible(stored.visible);
+    }
+    for (double position : verticalLines)
+        view->addVerticalLine(position);
+    for (double position : horizontalLines)
+        view->addHorizontalLine(position);
+    view->setChartConfig(config);
+}
+
+void ChartSnapshot::restore(ListChart* chart) const
+{
+    chart->chart()->setAxisTransform(Qt::Horizontal, createTransform(xTransform));
+    chart->chart()->setAxisTransform(Qt::Vertical, createTransform(yTransform));
+
+    QSet<int> hidden;
+    for (const Series& stored : series) {
+        QXYSeries* created = createSeries(stored);
+        chart->addSeries(created, stored.group, stored.color, stored.name, stored.callout);
+        if (!stored.visible)
+            hidden.insert(stored.group);
+    }
+    // ListChart hides whole groups
+    chart->setGroupsVisible(hidden.values(), false);
+
+    for (double position : verticalLines)
+        chart->chart()->addVerticalLine(position);
+    for (double position : horizontalLines)
+        chart->chart()->addHorizontalLine(position);
+    chart->chart()->setChartConfig(config);
+}
+
+QByteArray ChartSnapshot::toByteArray() const
+{
+    std::vector<Block> blocks;
+    for (const Series& stored : series) {
+        for (const QVector<qreal>* column : { &stored.x, &stored.y }) {
+            for (qsizetype first = 0; first < column->size(); first += BlockSize)
+                blocks.push_back(Block{ const_cast<qreal*>(column->constData()) + first, qMin<qsizetype>(BlockSize, column->size() - first) });
+        }
+    }
+
+    ChartTools::ParallelFor(qsizetype(blocks.size()), [&blocks](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            blocks[size_t(i)].encoded = encodeBlock(blocks[size_t(i)].values, blocks[size_t(i)].count);
+    },
+        1);
+
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << QJsonDocument(config).toJson(QJsonDocument::Compact) << verticalLines << horizontalLines;
+    stream << qint32(xTransform.type) << xTransform.constant << qint32(yTransform.type) << yTransform.constant;
+    stream << quint32(series.size());
+
+    size_t block = 0;
+    for (const Series& stored : series) {
+        const qsizetype count = qMin(stored.x.size(), stored.y.size());
+        stream << stored.name << stored.color << qint32(stored.group) << stored.visible << stored.callout
+               << qint32(stored.type) << double(stored.size) << quint64(count);
+        QVector<quint64> sizes;
+        for (qsizetype i = 0; i < blockCount(stored.x.size()) + blockCount(stored.y.size()); ++i)
+            sizes << quint64(blocks[block++].encoded.size());
+        stream << quint64(stored.x.size()) << quint64(stored.y.size()) << sizes;
+    }
+
+    QByteArray data;
+    QDataStream file(&data, QIODevice::WriteOnly);
+    file.writeRawData(Magic, sizeof(Magic));
+    file << Version << quint64(header.size());
+    file.writeRawData(header.constData(), header.size());
+    for (const Block& encoded : blocks)
+        file.writeRawData(encoded.encoded.constData(), encoded.encoded.size());
+    return data;
+}
+
+bool ChartSnapshot::fromData(const uchar* data, qint64 size, ChartSnapshot& snapshot, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error)
+            *error = message;
+        return false;
+    };
+
+    const qint64 prefix = sizeof(Magic) + sizeof(quint32) + sizeof(quint64);
+    if (size < prefix || std::memcmp(data, Magic, sizeof(Magic)) != 0)
+        return fail(QStringLiteral("Not a chart snapshot"));
+
+    const QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(qMin<qint64>(size, prefix)));
+    QDataStream file(raw);
+    file.skipRawData(sizeof(Magic));
+    quint32 version;
+    quint64 headerSize;
+    file >> version >> headerSize;
+    if (version > Version)
+        return fail(QStringLiteral("Snapshot version %1 is newer than this program").arg(version));
+    if (headerSize > quint64(size - prefix))
+        return fail(QStringLiteral("Snapshot header is truncated"));
+
+    // The header and the blocks are read in place from the mapped data
+    const QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char*>(data + prefix), int(headerSize));
+    QDataStream stream(header);
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    ChartSnapshot result;
+    QByteArray config;
+    quint32 count;
+    stream >> config >> result.verticalLines >> result.horizontalLines;
+    if (version >= 2) {
+        qint32 xType, yType;
+        stream >> xType >> result.xTransform.constant >> yType >> result.yTransform.constant;
+        result.xTransform.type = xType;
+        result.yTransform.type = yType;
+    }
+    stream >> count;
+    result.config = QJsonDocument::fromJson(config).object();
+
+    QVector<QVector<quint64>> blockSizes;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Series stored;
+        qint32 group, type;
+        double seriesSize;
+        quint64 points, xCount, yCount;
+        QVector<quint64> sizes;
+        stream >> stored.name >> stored.color >> group >> stored.visible >> stored.callout >> type >> seriesSize >> points;
+        stream >> xCount >> yCount >> sizes;
+        if (stream.status() != QDataStream::Ok)
+            break;
+        if (sizes.size() != blockCount(qsizetype(xCount)) + blockCount(qsizetype(yCount)))
+            return fail(QStringLiteral("Snapshot block table is inconsistent"));
+
+        stored.group = group;
+        stored.type = type;
+        stored.size = seriesSize;
+        stored.x.resize(qsizetype(xCount));
+        stored.y.resize(qsizetype(yCount));
+        result.series.append(stored);
+        blockSizes.append(sizes);
+    }
+    if (stream.status() != QDataStream::Ok)
+        return fail(QStringLiteral("Snapshot header is damaged"));
+
+    // All columns exist now, so the block targets stay where they are
+    const uchar* payload = data + prefix + headerSize;
+    const qint64 payloadSize = size - prefix - qint64(headerSize);
+    qint64 offset = 0;
+    std::vector<Block> blocks;
+    for (int i = 0; i < result.series.size(); ++i) {
+        Series& target = result.series[i];
+        int block = 0;
+        for (QVector<qreal>* column : { &target.x, &target.y }) {
+            for (qsizetype first = 0; first < column->size(); first += BlockSize) {
+                const qint64 blockSize = qint64(blockSizes[i][block++]);
+                if (offset + blockSize > payloadSize)
+                    return fail(QStringLiteral("Snapshot data is truncated"));
+                Block entry{ column->data() + first, qMin<qsizetype>(BlockSize, column->size() - first) };
+                entry.data = payload + offset;
+                entry.size = blockSize;
+                blocks.push_back(entry);
+                offset += blockSize;
+            }
+        }
+    }
+
+    std::atomic<bool> damaged{ false };
+    ChartTools::ParallelFor(qsizetype(blocks.size()), [&blocks, &damaged](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i) {
+            const Block& block = blocks[size_t(i)];
+            if (!decodeBlock(block.data, block.size, block.values, block.count))
+                damaged = true;
+        }
+    },
+        1);
+    if (damaged)
+        return fail(QStringLiteral("Snapshot data is damaged"));
+
+    snapshot = std::move(result);
+    return true;
+}
+
+bool ChartSnapshot::save(const QString& fileName, QString* error) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    file.write(toByteArray());
+    if (!file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool ChartSnapshot::load(const QString& fileName, ChartSnapshot& snapshot, QString* error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (const uchar* data = file.map(0, size))
+        return fromData(data, size, snapshot, error);
+
+    const QByteArray content = file.readAll();
+    return fromData(reinterpret_cast<const uchar*>(content.constData()), content.size(), snapshot, error);
+}
@@ -0,0 +1,115 @@
+/*
+ * CuteCharts - Binary chart snapshots
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <QtGui/QColor>
+
+class ChartView;
+class ListChart;
+
+/**
+ * @brief Everything needed to reopen a chart without the analysis behind it
+ *
+ * The file starts with the magic "CUTESNAP", a format version and a header
+ * written with QDataStream: chart config, marker lines, the axis transforms
+ * (since version 2) and per series its
+ * name, colour, group, visibility, callout flag, type, size and the location
+ * of its data blocks. The payload holds the x and y columns in blocks of
+ * BlockSize values. Every value is XORed with its predecessor, the bytes are
+ * regrouped into planes of equal significance and the block is compressed
+ * with qCompress; smooth data leaves the upper planes almost empty. Blocks
+ * are independent, so loading decompresses them in parallel straight from
+ * the memory mapped file.
+ */
+struct ChartSnapshot {
+    static constexpr quint32 Version = 2;
+    static constexpr int BlockSize = 1 << 20;
+
+    struct Series {
+        QString name;
+        QColor color;
+        int group = 0; ///< ListChart index, position in the chart for a ChartView
+        bool visible = true;
+        bool callout = false;
+        int type = 0; ///< QAbstractSeries::SeriesType, line and scatter series are restored
+        qreal size = 0; ///< Line width or marker size, 0 keeps the default
+        QVector<qreal> x, y;
+    };
+
+    /**
+     * @brief Built-in axis transform of the view
+     *
+     * Log10 and symlog are kept with their constant. A custom transform is a
+     * pair of functions that cannot be written to a file, it is stored as
+     * linear and has to be set again after restoring.
+     */
+    struct Transform {
+        int type = 0; ///< AxisTransform::Type
+        double constant = 1; ///< Linear region of symlog
+    };
+
+    QJsonObject config;
+    QVector<double> verticalLines, horizontalLines;
+    Transform xTransform, yTransform;
+    QVector<Series> series;
+
+    /**
+     * @brief Collect the line and scatter series, marker lines and config of a view
+     */
+    static ChartSnapshot capture(const ChartView* view);
+
+    /**
+     * @brief Collect a ListChart including its series groups
+     */
+    static ChartSnapshot capture(const ListChart* chart);
+
+    /**
+     * @brief Set the axis transforms, add the series and marker lines to a view and apply the config
+     */
+    void restore(ChartView* view) const;
+    void restore(ListChart* chart) const;
+
+    /**
+     * @brief Encode the snapshot
+     * @return File contents
+     */
+    QByteArray toByteArray() const;
+
+    /**
+     * @brief Decode a snapshot
+     * @param data File contents, not copied
+     * @param size Number of bytes
+     * @param snapshot Receives the snapshot
+     * @param error Receives a message on failure, may be nullptr
+     * @return True on success
+     */
+    static bool fromData(const uchar* data, qint64 size, ChartSnapshot& snapshot, QString* error = nullptr);
+
+    bool save(const QString& fileName, QString* error = nullptr) const;
+
+    /**
+     * @brief Read a snapshot file through a memory mapping
+     */
+    static bool load(const QString& fileName, ChartSnapshot& snapshot, QString* error = nullptr);
+};
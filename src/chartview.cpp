@@ -17,13 +17,16 @@
  *
  */
 
+#include "calloutlayout.h"
 #include "chartconfig.h"
 #include "chartviewprivate.h"
 #include "peakcallout.h"
 #include "series.h"
+#include "tickengine.h"
 #include "tools.h"
 
 #include <QtCharts/QAreaSeries>
+#include <QtCharts/QCategoryAxis>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLegendMarker>
@@ -54,20 +57,60 @@
 
 #include "chartview.h"
 
+namespace {
+/**
+ * @brief Points whose bounds are the bounds of a series
+ *
+ * Series in compact storage only hold the points of the view, their samples
+ * know the bounds of all data; two mapped corners stand in for them. The
+ * outline of a histogram only covers the current x range, its full range and
+ * highest bar are used instead. Other series have no points to scale to.
+ */
+QVector<QPointF> boundingPoints(QAbstractSeries* series, const AxisTransform& x, const AxisTransform& y)
+{
+    QPointF lower, upper;
+    QVector<QPointF> fallback;
+    if (const HistogramSeries* histogram = qobject_cast<const HistogramSeries*>(series)) {
+        if (histogram->histogram().bins() == 0)
+            return {};
+        lower = QPointF(histogram->histogram().minimum(), 0);
+        upper = QPointF(histogram->histogram().maximum(), histogram->maximumCount());
+    } else if (QXYSeries* xy = qobject_cast<QXYSeries*>(series)) {
+        fallback = xy->points();
+        const LineSeries* line = qobject_cast<const LineSeries*>(series);
+        if (!line || !line->hasCompactStorage() || line->samples().isEmpty())
+            return fallback;
+        lower = QPointF(line->samples().xMin(), line->samples().yMin());
+        upper = QPointF(line->samples().xMax(), line->samples().yMax());
+    } else {
+        return {};
+    }
 
-ChartView::ChartView()
-    : has_legend(false)
+    lower = x.map(lower, y);
+    upper = x.map(upper, y);
+    // Log axes have no place for values <= 0, the points of the view are clipped already
+    if (!std::isfinite(lower.x()) || !std::isfinite(lower.y()) || !std::isfinite(upper.x()) || !std::isfinite(upper.y()))
+        return fallback;
+    return { lower, upper };
+}
+}
+
+ChartView::ChartView(bool lite)
+    : m_lite(lite)
+    , has_legend(false)
     , connected(false)
     , m_x_axis(QString())
     , m_y_axis(QString())
     , m_pending(false)
-    , m_lock_scaling(false)
+    , m_chart_config(std::make_unique<ChartConfig>(ChartConfig::fromJson(DefaultConfig)))
 {
-    m_currentChartConfig = DefaultConfig;
     m_chart = new QChart();
     m_chart_private = new ChartViewPrivate(m_chart, this);
+    m_callouts = new CalloutLayout(m_chart, this);
+    m_chart_private->setCalloutLayout(m_callouts);
 
     connect(m_chart_private, &ChartViewPrivate::zoomChanged, this, &ChartView::zoomChanged);
+    connect(m_chart_private, &ChartViewPrivate::zoomHistoryChanged, this, &ChartView::zoomHistoryChanged);
     connect(m_chart_private, &ChartViewPrivate::zoomRect, this, &ChartView::zoomRect);
     connect(m_chart_private, &ChartViewPrivate::scaleDown, this, &ChartView::scaleDown);
     connect(m_chart_private, &ChartViewPrivate::scaleUp, this, &ChartView::scaleUp);
@@ -77,6 +120,8 @@ ChartView::ChartView()
     connect(m_chart_private, &ChartViewPrivate::rightKey, this, &ChartView::rightKey);
     connect(m_chart_private, &ChartViewPrivate::leftKey, this, &ChartView::leftKey);
 
+    connect(m_chart, &QChart::plotAreaChanged, this, &ChartView::scheduleDecimation);
+
     m_chart->legend()->setVisible(false);
     m_chart->legend()->setAlignment(Qt::AlignRight);
     setUi();
@@ -88,7 +133,7 @@ ChartView::ChartView()
 
 ChartView::~ChartView()
 {
-    qDeleteAll(m_peak_anno);
+    m_callouts->clear();
 }
 
 void ChartView::setAnimationEnabled(bool animation)
@@ -103,7 +148,71 @@ void ChartView::setUi()
 {
     m_name = "chart";
     mCentralLayout = new QGridLayout;
-    QMenu* menu = new QMenu(this);
+
+    m_ignore = new QPushButton(tr("Ignore"));
+    m_ignore->setMaximumWidth(100);
+
+    m_action_button = new QPushButton;
+    m_action_button->setMaximumWidth(100);
+    connect(m_action_button, &QPushButton::clicked, this, &ChartView::applyConfigAction);
+
+    mCentralLayout->addWidget(m_chart_private, 0, 0, 1, 5);
+    mCentralLayout->addWidget(m_action_button, 0, 2, Qt::AlignTop);
+    mCentralLayout->addWidget(m_ignore, 0, 3, Qt::AlignTop);
+
+    // The menu is filled on first use, a lite view gets no tools at all
+    if (!m_lite) {
+        QMenu* menu = new QMenu(this);
+        connect(menu, &QMenu::aboutToShow, this, &ChartView::populateMenu);
+
+        m_config = new QPushButton(tr("Tools"));
+        m_config->setFlat(true);
+        m_config->setIcon(QIcon::fromTheme("applications-system"));
+        m_config->setMaximumWidth(100);
+        m_config->setStyleSheet("QPushButton {background-color: #A3C1DA; color: black;}");
+        m_config->setMenu(menu);
+        mCentralLayout->addWidget(m_config, 0, 4, Qt::AlignTop);
+    }
+
+    m_action_button->setHidden(true);
+    m_ignore->setHidden(true);
+    connect(m_ignore, &QPushButton::clicked, this, [this]() {
+        m_action_button->setHidden(true);
+        m_ignore->setHidden(true);
+        m_apply_action = 0;
+    });
+
+    QWidget* firstPageWidget = new QWidget;
+    m_configure = new QWidget;
+
+    m_centralWidget = new QStackedWidget;
+    m_centralWidget->addWidget(firstPageWidget);
+    m_centralWidget->addWidget(m_configure);
+
+    firstPageWidget->setLayout(mCentralLayout);
+
+    setWidget(m_centralWidget);
+
+    connect(m_chart_private, &ChartViewPrivate::lockZoom, this, [this]() {
+        this->m_chart_config->scalingLocked = true;
+        if (this->m_lock_action)
+            this->m_lock_action->setChecked(true);
+    });
+
+    connect(m_chart_private, &ChartViewPrivate::unlockZoom, this, [this]() {
+        this->m_chart_config->scalingLocked = false;
+        if (this->m_lock_action)
+            this->m_lock_action->setChecked(false);
+    });
+    if (m_config)
+        m_config->setEnabled(m_series.size());
+}
+
+void ChartView::populateMenu()
+{
+    QMenu* menu = m_config->menu();
+    if (!menu->isEmpty())
+        return;
 
     m_configure_series = new QAction(this);
     m_configure_series->setText(tr("Configure"));
@@ -118,8 +227,9 @@ void ChartView::setUi()
     m_lock_action->setText(tr("Lock Scaling"));
     m_lock_action->setCheckable(true);
     connect(m_lock_action, &QAction::triggered, this, [this]() {
-        m_lock_scaling = m_lock_action->isChecked();
+        m_chart_config->scalingLocked = m_lock_action->isChecked();
     });
+    m_lock_action->setChecked(m_chart_config->scalingLocked);
     menu->addAction(m_lock_action);
 
     QAction* scaleAction = new QAction(this);
@@ -148,12 +258,9 @@ void ChartView::setUi()
     connect(exportpng, &QAction::triggered, this, &ChartView::exportPNG);
     menu->addAction(exportpng);
 
-    m_exportMenu = new QMenu(tr("Export Style"));
+    m_exportMenu = new QMenu(tr("Export Style"), menu);
     menu->addMenu(m_exportMenu);
-
-    QAction* defaultAction = new QAction(tr("Default"));
-    defaultAction->setData(DefaultConfig);
-    m_exportMenu->addAction(defaultAction);
+    updateExportMenu();
 
     connect(m_exportMenu, &QMenu::triggered, m_exportMenu, [this](QAction* action) {
         this->setFontConfig(action->data().toJsonObject());
@@ -169,21 +276,25 @@ void ChartView::setUi()
     connect(loadConfig, &QAction::triggered, this, &ChartView::loadFontConfig);
     menu->addAction(loadConfig);
 
-    m_select_strategy = new QMenu(tr("Select Strategy"));
+    m_select_strategy = new QMenu(tr("Select Strategy"), menu);
 
-    m_select_none = new QAction(tr("None"));
+    m_select_none = new QAction(m_select_strategy);
+    m_select_none->setText(tr("None"));
     m_select_none->setData(static_cast<int>(SelectStrategy::None));
     m_select_none->setCheckable(true);
 
-    m_select_horizonal = new QAction(tr("Horizontal"));
+    m_select_horizonal = new QAction(m_select_strategy);
+    m_select_horizonal->setText(tr("Horizontal"));
     m_select_horizonal->setData(static_cast<int>(SelectStrategy::Horizontal));
     m_select_horizonal->setCheckable(true);
 
-    m_select_vertical = new QAction(tr("Vertical"));
+    m_select_vertical = new QAction(m_select_strategy);
+    m_select_vertical->setText(tr("Vertical"));
     m_select_vertical->setData(static_cast<int>(SelectStrategy::Vertical));
     m_select_vertical->setCheckable(true);
 
-    m_select_rectangular = new QAction(tr("Rectangular"));
+    m_select_rectangular = new QAction(m_select_strategy);
+    m_select_rectangular->setText(tr("Rectangular"));
     m_select_rectangular->setData(static_cast<int>(SelectStrategy::Rectangular));
     m_select_rectangular->setCheckable(true);
 
@@ -202,21 +313,25 @@ void ChartView::setUi()
         m_select_rectangular->setChecked(select == SelectStrategy::Rectangular);
     });
 
-    m_zoom_strategy = new QMenu(tr("Zoom Strategy"));
+    m_zoom_strategy = new QMenu(tr("Zoom Strategy"), menu);
 
-    m_zoom_none = new QAction(tr("None"));
+    m_zoom_none = new QAction(m_zoom_strategy);
+    m_zoom_none->setText(tr("None"));
     m_zoom_none->setData(static_cast<int>(ZoomStrategy::None));
     m_zoom_none->setCheckable(true);
 
-    m_zoom_horizonal = new QAction(tr("Horizontal"));
+    m_zoom_horizonal = new QAction(m_zoom_strategy);
+    m_zoom_horizonal->setText(tr("Horizontal"));
     m_zoom_horizonal->setData(static_cast<int>(ZoomStrategy::Horizontal));
     m_zoom_horizonal->setCheckable(true);
 
-    m_zoom_vertical = new QAction(tr("Vertical"));
+    m_zoom_vertical = new QAction(m_zoom_strategy);
+    m_zoom_vertical->setText(tr("Vertical"));
     m_zoom_vertical->setData(static_cast<int>(ZoomStrategy::Vertical));
     m_zoom_vertical->setCheckable(true);
 
-    m_zoom_rectangular = new QAction(tr("Rectangular"));
+    m_zoom_rectangular = new QAction(m_zoom_strategy);
+    m_zoom_rectangular->setText(tr("Rectangular"));
     m_zoom_rectangular->setData(static_cast<int>(ZoomStrategy::Rectangular));
     m_zoom_rectangular->setCheckable(true);
 
@@ -235,45 +350,17 @@ void ChartView::setUi()
         m_zoom_rectangular->setChecked(select == ZoomStrategy::Rectangular);
     });
 
-    m_ignore = new QPushButton(tr("Ignore"));
-    m_ignore->setMaximumWidth(100);
-
-    m_action_button = new QPushButton;
-    m_action_button->setMaximumWidth(100);
-    connect(m_action_button, &QPushButton::clicked, this, &ChartView::applyConfigAction);
-
-    m_config = new QPushButton(tr("Tools"));
-    m_config->setFlat(true);
-    m_config->setIcon(QIcon::fromTheme("applications-system"));
-    m_config->setMaximumWidth(100);
-    m_config->setStyleSheet("QPushButton {background-color: #A3C1DA; color: black;}");
-    m_config->setMenu(menu);
-
-    mCentralLayout->addWidget(m_chart_private, 0, 0, 1, 5);
-    mCentralLayout->addWidget(m_action_button, 0, 2, Qt::AlignTop);
-    mCentralLayout->addWidget(m_ignore, 0, 3, Qt::AlignTop);
-    mCentralLayout->addWidget(m_config, 0, 4, Qt::AlignTop);
-
-    m_action_button->setHidden(true);
-    m_ignore->setHidden(true);
-    connect(m_ignore, &QPushButton::clicked, this, [this]() {
-        m_action_button->setHidden(true);
-        m_ignore->setHidden(true);
-        m_apply_action = 0;
-    });
-
-    QWidget* firstPageWidget = new QWidget;
-    m_configure = new QWidget;
-
-    m_centralWidget = new QStackedWidget;
-    m_centralWidget->addWidget(firstPageWidget);
-    m_centralWidget->addWidget(m_configure);
-
-    firstPageWidget->setLayout(mCentralLayout);
+    // The strategies may have been set before the menu existed
+    updateStrategyActions();
+}
 
-    setWidget(m_centralWidget);
+ChartConfigDialog* ChartView::configDialog()
+{
+    if (m_chartconfigdialog || m_lite)
+        return m_chartconfigdialog;
 
     m_chartconfigdialog = new ChartConfigDialog(this);
+    m_chartconfigdialog->setModal(m_modal);
 
     connect(m_chartconfigdialog, &ChartConfigDialog::ConfigChanged, this, [this](const QJsonObject& config) {
         this->forceChartConfig(config);
@@ -282,26 +369,16 @@ void ChartView::setUi()
     connect(m_chartconfigdialog, &ChartConfigDialog::ScaleAxis, this, &ChartView::forceFormatAxis);
 #pragma message "TODO: connect to ChartConfigDialog::ResetFontConfig"
     // connect(m_chartconfigdialog, &ChartConfigDialog::ResetFontConfig, this, &ChartView::ResetFontConfig);
-
-    connect(m_chart_private, &ChartViewPrivate::lockZoom, this, [this]() {
-        this->m_lock_scaling = true;
-        this->m_lock_action->setChecked(true);
-    });
-
-    connect(m_chart_private, &ChartViewPrivate::unlockZoom, this, [this]() {
-        this->m_lock_scaling = false;
-        this->m_lock_action->setChecked(false);
-    });
-    m_config->setEnabled(m_series.size());
+    return m_chartconfigdialog;
 }
 
-void ChartView::addExportSetting(const QString& name, const QString& description, const QJsonObject& settings)
+void ChartView::updateExportMenu()
 {
-    if (m_stored_exportsettings.contains(name))
+    if (!m_exportMenu)
         return;
-    m_stored_exportsettings.insert(name, QPair<QString, QJsonObject>(description, settings));
+
     m_exportMenu->clear();
-    QAction* defaultAction = new QAction(tr("Default"));
+    QAction* defaultAction = new QAction(tr("Default"), m_exportMenu);
     defaultAction->setData(DefaultConfig);
     m_exportMenu->addAction(defaultAction);
     QHash<QString, QPair<QString, QJsonObject>>::const_iterator i = m_stored_exportsettings.constBegin();
@@ -315,6 +392,14 @@ void ChartView::addExportSetting(const QString& name, const QString& description
     }
 }
 
+void ChartView::addExportSetting(const QString& name, const QString& description, const QJsonObject& settings)
+{
+    if (m_stored_exportsettings.contains(name))
+        return;
+    m_stored_exportsettings.insert(name, QPair<QString, QJsonObject>(description, settings));
+    updateExportMenu();
+}
+
 void ChartView::configure()
 {
     if (m_centralWidget->currentIndex() == 0)
@@ -326,19 +411,32 @@ void ChartView::configure()
 void ChartView::setZoomStrategy(ZoomStrategy strategy)
 {
     m_chart_private->setZoomStrategy(strategy);
-    m_zoom_none->setChecked(strategy == ZoomStrategy::None);
-    m_zoom_horizonal->setChecked(strategy == ZoomStrategy::Horizontal);
-    m_zoom_vertical->setChecked(strategy == ZoomStrategy::Vertical);
-    m_zoom_rectangular->setChecked(strategy == ZoomStrategy::Rectangular);
+    updateStrategyActions();
 }
 
 void ChartView::setSelectStrategy(SelectStrategy strategy)
 {
     m_chart_private->setSelectStrategy(strategy);
-    m_select_none->setChecked(strategy == SelectStrategy::None);
-    m_select_horizonal->setChecked(strategy == SelectStrategy::Horizontal);
-    m_select_vertical->setChecked(strategy == SelectStrategy::Vertical);
-    m_select_rectangular->setChecked(strategy == SelectStrategy::Rectangular);
+    updateStrategyActions();
+}
+
+void ChartView::updateStrategyActions()
+{
+    if (m_zoom_strategy) {
+        const ZoomStrategy zoom = currentZoomStrategy();
+        m_zoom_none->setChecked(zoom == ZoomStrategy::None);
+        m_zoom_horizonal->setChecked(zoom == ZoomStrategy::Horizontal);
+        m_zoom_vertical->setChecked(zoom == ZoomStrategy::Vertical);
+        m_zoom_rectangular->setChecked(zoom == ZoomStrategy::Rectangular);
+    }
+
+    if (m_select_strategy) {
+        const SelectStrategy select = currentSelectStrategy();
+        m_select_none->setChecked(select == SelectStrategy::None);
+        m_select_horizonal->setChecked(select == SelectStrategy::Horizontal);
+        m_select_vertical->setChecked(select == SelectStrategy::Vertical);
+        m_select_rectangular->setChecked(select == SelectStrategy::Rectangular);
+    }
 }
 
 QLineSeries* ChartView::addLinearSeries(qreal m, qreal n, qreal min, qreal max)
@@ -349,7 +447,8 @@ QLineSeries* ChartView::addLinearSeries(qreal m, qreal n, qreal min, qreal max)
     series->append(min, y_min);
     series->append(max, y_max);
     addSeries(series);
-    m_config->setEnabled(m_series.size());
+    if (m_config)
+        m_config->setEnabled(m_series.size());
     return series;
 }
 
@@ -358,32 +457,24 @@ void ChartView::addSeries(QAbstractSeries* series, bool callout)
     if (!m_chart->series().contains(series) || !series) {
         QPointer<QXYSeries> serie = qobject_cast<QXYSeries*>(series);
         if (serie) {
+            if (!m_x_transform.isLinear() || !m_y_transform.isLinear())
+                transformSeries(serie);
             if (serie->points().size() > 5e3)
                 serie->setUseOpenGL(true);
-            if (callout) {
-                qreal x = 0;
-                for (const QPointF& point : serie->points())
-                    x += point.x();
-                x /= double(serie->points().size());
-                QPointF point(x, 1.5);
-
-                QPointer<PeakCallOut> annotation = new PeakCallOut(m_chart);
-                annotation->setSeries(series);
-                annotation->setText(series->name(), point);
-                annotation->setAnchor(point);
-                annotation->setZValue(11);
-                annotation->setVisible(true);
-                connect(series, &QAbstractSeries::visibleChanged, series, [series, annotation]() {
-                    annotation->setVisible(series->isVisible());
-                });
-                connect(serie, &QXYSeries::colorChanged, serie, [serie, annotation]() {
-                    annotation->setColor(serie->color());
+            if (callout)
+                m_callouts->addSeriesCallout(serie);
+            if (m_peak_picker && qobject_cast<QLineSeries*>(serie))
+                m_peak_picker->addSeries(serie);
+            // Compact storage brings its own bounds, the points only cover the view
+            if (LineSeries* line = qobject_cast<LineSeries*>(serie.data())) {
+                connect(line, &LineSeries::samplesChanged, this, &ChartView::formatAxis);
+                connect(line, &LineSeries::samplesChanged, this, &ChartView::scheduleDecimation);
+                // Samples are data values, mapped points must not end up in compact storage
+                connect(line, &LineSeries::aboutToCompact, this, [this, line]() { restoreSeriesData(line); });
+                connect(line, &LineSeries::samplesChanged, this, [this, line]() {
+                    if (!m_x_transform.isLinear() || !m_y_transform.isLinear())
+                        transformSeries(line);
                 });
-                connect(serie, &QXYSeries::nameChanged, serie, [serie, annotation, point]() {
-                    annotation->setText(serie->name(), point);
-                });
-                annotation->setColor(serie->color());
-                m_peak_anno.append(annotation);
             }
         }
         m_chart->addSeries(series);
@@ -394,6 +485,17 @@ void ChartView::addSeries(QAbstractSeries* series, bool callout)
 
             m_XAxis->setLabelFormat("%2.2f");
             m_YAxis->setLabelFormat("%2.2f");
+            m_callouts->trackAxis(m_XAxis);
+            m_callouts->trackAxis(m_YAxis);
+            connect(m_XAxis, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleZoomRecord);
+            connect(m_YAxis, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleZoomRecord);
+            connect(m_XAxis, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleTicks);
+            connect(m_YAxis, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleTicks);
+            connect(m_XAxis, &QValueAxis::rangeChanged, this, &ChartView::scheduleDecimation);
+            if (!m_x_transform.isLinear())
+                replaceAxis(Qt::Horizontal, m_XAxis->min(), m_XAxis->max());
+            if (!m_y_transform.isLinear())
+                replaceAxis(Qt::Vertical, m_YAxis->min(), m_YAxis->max());
 
             m_hasAxis = true;
         } else {
@@ -401,6 +503,39 @@ void ChartView::addSeries(QAbstractSeries* series, bool callout)
             series->attachAxis(m_YAxis);
         }
         m_series << series;
+
+        // Density maps are only drawn by the threaded backend
+        if (QPointer<ScatterSeries> scatter = qobject_cast<ScatterSeries*>(series)) {
+            if (scatter->densityMode())
+                setRenderBackend(RenderBackend::Threaded);
+            connect(scatter, &ScatterSeries::densityChanged, this, [this, scatter]() {
+                if (scatter && scatter->densityMode())
+                    setRenderBackend(RenderBackend::Threaded);
+            });
+        }
+        // Outliers of all boxes are drawn by one scatter series on the same axes
+        if (BoxPlotSeries* boxplot = qobject_cast<BoxPlotSeries*>(series)) {
+            QScatterSeries* outliers = boxplot->outlierSeries();
+            if (outliers && m_XAxis && m_YAxis) {
+                m_chart->addSeries(outliers);
+                outliers->attachAxis(m_XAxis);
+                outliers->attachAxis(m_YAxis);
+                for (QLegendMarker* marker : m_chart->legend()->markers(outliers))
+                    marker->setVisible(false);
+                // The threaded backend has to take over the outliers as well, else Qt Charts draws them on top
+                m_chart_private->trackSeries(outliers);
+            }
+        }
+
+        // Bars follow the zoom, they are re-binned from the base histogram
+        if (HistogramSeries* histogram = qobject_cast<HistogramSeries*>(series)) {
+            if (m_XAxis) {
+                connect(m_XAxis, &QValueAxis::rangeChanged, histogram, &HistogramSeries::setViewRange);
+                histogram->setViewRange(m_XAxis->min(), m_XAxis->max());
+            }
+        }
+        m_chart_private->trackSeries(series);
+        scheduleDecimation();
     }
     connect(series, &QAbstractSeries::nameChanged, series, [this, series]() {
         if (series) {
@@ -456,18 +591,21 @@ void ChartView::addSeries(QAbstractSeries* series, bool callout)
         show = scatter->showInLegend();
     }
     m_chart->legend()->markers(series).first()->setVisible(show);
-    connect(series, &QAbstractSeries::visibleChanged, this, &ChartView::forceFormatAxis);
+    // Hiding many series at once, e.g. a batch of ListChart groups, costs one rescale
+    connect(series, &QAbstractSeries::visibleChanged, this, &ChartView::scheduleFormatAxis);
     if (!connected)
         if (connect(this, &ChartView::axisChanged, this, &ChartView::forceFormatAxis))
             connected = true;
     forceFormatAxis();
-    m_config->setEnabled(m_series.size());
+    if (m_config)
+        m_config->setEnabled(m_series.size());
     emit setUpFinished();
 }
 
 void ChartView::clearChart()
 {
     m_chart->removeAllSeries();
+    m_chart_private->clearZoomHistory();
     emit chartCleared();
 }
 
@@ -527,14 +665,23 @@ void ChartView::scaleAxis(QPointer<QValueAxis> axis, qreal& min, qreal& max)
             min = 0;
     }
 
-    int ticks = ChartTools::ScaleToNormalizedRange(max - min) / int(ChartTools::ScaleToNormalizedRange(max - min) / 5) + 1;
-    axis->setTickCount(ticks);
+    axis->setTickCount(qMax(2, TickEngine::compute(min, max, 6).count));
+    axis->setRange(min, max);
+}
+
+void ChartView::scaleAxis(QPointer<QValueAxis> axis, const AxisTransform& transform, qreal& min, qreal& max)
+{
+    if (transform.isLinear()) {
+        scaleAxis(axis, min, max);
+        return;
+    }
+    transform.niceRange(min, max);
     axis->setRange(min, max);
 }
 
 void ChartView::forceFormatAxis()
 {
-    if (m_lock_scaling || m_chart->series().size() == 0)
+    if (m_chart_config->scalingLocked || m_chart->series().size() == 0)
         return;
     m_pending = true;
 
@@ -543,7 +690,7 @@ void ChartView::forceFormatAxis()
     else if (m_autoscalestrategy == AutoScaleStrategy::SpaceScale)
         spaceScale();
 
-    if (connected)
+    if (connected && m_chartconfigdialog)
         m_chartconfigdialog->setChartConfig(getChartConfig());
 
     m_chart_private->updateZoom();
@@ -557,13 +704,10 @@ void ChartView::spaceScale()
     qreal y_min = 0;
     int start = 0;
     for (QAbstractSeries* series : m_chart->series()) {
-        QPointer<QXYSeries> serie = qobject_cast<QXYSeries*>(series);
-        if (!serie)
-            continue;
-        if (!serie->isVisible())
+        if (!series->isVisible())
             continue;
 
-        QVector<QPointF> points = serie->points();
+        QVector<QPointF> points = boundingPoints(series, m_x_transform, m_y_transform);
         if (start == 0 && points.size()) {
             y_min = points.first().y();
             y_max = points.first().y();
@@ -581,8 +725,8 @@ void ChartView::spaceScale()
         }
     }
 
-    scaleAxis(m_XAxis, x_min, x_max);
-    scaleAxis(m_YAxis, y_min, y_max);
+    scaleAxis(m_XAxis, m_x_transform, x_min, x_max);
+    scaleAxis(m_YAxis, m_y_transform, y_min, y_max);
 
     m_XAxis->setTitleText(m_x_axis);
     m_YAxis->setTitleText(m_y_axis);
@@ -603,13 +747,10 @@ void ChartView::qtNiceNumbersScale()
     int start = 0;
 
     for (QAbstractSeries* series : m_chart->series()) {
-        QPointer<QXYSeries> serie = qobject_cast<QXYSeries*>(series);
-        if (!serie)
-            continue;
-        if (!serie->isVisible())
+        if (!series->isVisible())
             continue;
 
-        QVector<QPointF> points = serie->points();
+        QVector<QPointF> points = boundingPoints(series, m_x_transform, m_y_transform);
         if (start == 0 && points.size()) {
             y_min = points.first().y();
             y_max = points.first().y();
@@ -627,10 +768,18 @@ void ChartView::qtNiceNumbersScale()
         }
     }
 
-    m_XAxis->setRange(x_min, x_max);
-    m_XAxis->applyNiceNumbers();
-    m_YAxis->setRange(y_min, y_max);
-    m_YAxis->applyNiceNumbers();
+    if (m_x_transform.isLinear()) {
+        m_XAxis->setRange(x_min, x_max);
+        m_XAxis->applyNiceNumbers();
+    } else {
+        scaleAxis(m_XAxis, m_x_transform, x_min, x_max);
+    }
+    if (m_y_transform.isLinear()) {
+        m_YAxis->setRange(y_min, y_max);
+        m_YAxis->applyNiceNumbers();
+    } else {
+        scaleAxis(m_YAxis, m_y_transform, y_min, y_max);
+    }
 
     m_XAxis->setTitleText(m_x_axis);
     m_YAxis->setTitleText(m_y_axis);
@@ -643,31 +792,31 @@ void ChartView::qtNiceNumbersScale()
 
 void ChartView::plotSettings()
 {
-    if (!connected)
+    if (!connected || !configDialog())
         return;
-    m_currentChartConfig = getChartConfig();
-    m_chartconfigdialog->setChartConfig(m_currentChartConfig);
+    *m_chart_config = ChartConfig::fromJson(getChartConfig());
+    m_chartconfigdialog->setChartConfig(currentChartConfig());
     m_chartconfigdialog->show();
     m_chartconfigdialog->raise();
     m_chartconfigdialog->activateWindow();
 }
 
-void ChartView::updateAxisConfig(const QJsonObject& config, QAbstractAxis* axis)
+void ChartView::updateAxisConfig(const ChartAxisConfig& config, QAbstractAxis* axis)
 {
-    axis->setTitleText(config["Title"].toString());
+    axis->setTitleText(config.title);
 
-    axis->setMin(config["Min"].toDouble());
-    axis->setMax(config["Max"].toDouble());
-    axis->setVisible(config["showAxis"].toBool());
+    axis->setMin(config.min);
+    axis->setMax(config.max);
+    axis->setVisible(config.showAxis);
     QPointer<QValueAxis> valueaxis = qobject_cast<QValueAxis*>(axis);
     if (valueaxis) {
-        valueaxis->setTickType(config["TickType"].toInt() == 0 ? QValueAxis::TicksDynamic : QValueAxis::TicksFixed);
-        valueaxis->setTickAnchor(config["TickAnchor"].toDouble());
-        valueaxis->setLabelFormat(config["TickFormat"].toString());
-        valueaxis->setTickInterval(config["TickInterval"].toDouble());
-        valueaxis->setTickCount(config["TickCount"].toInt());
-        valueaxis->setMinorTickCount(config["MinorTickCount"].toInt());
-        valueaxis->setMinorGridLineVisible(config["MinorVisible"].toBool());
+        valueaxis->setTickType(config.tickType == 0 ? QValueAxis::TicksDynamic : QValueAxis::TicksFixed);
+        valueaxis->setTickAnchor(config.tickAnchor);
+        valueaxis->setLabelFormat(config.tickFormat);
+        valueaxis->setTickInterval(config.tickInterval);
+        valueaxis->setTickCount(config.tickCount);
+        valueaxis->setMinorTickCount(config.minorTickCount);
+        valueaxis->setMinorGridLineVisible(config.minorVisible);
     }
 }
 
@@ -712,68 +861,56 @@ void ChartView::setChartConfig(const QJsonObject& chartconfig)
     if(!m_XAxis || !m_YAxis)
         return;
 
-    /* Something very strange is going on here, If I did not copy the const QJsonObject,
-       the config get modifed (although const) - GCC and Clang Qt 6.2.3, Manjaro Linux */
-    QJsonObject config = chartconfig;
-    m_lastChartConfig = m_currentChartConfig;
-    m_currentChartConfig = chartconfig;
-
-    m_lock_scaling = config["ScalingLocked"].toBool();
-    m_x_size = config["xSize"].toDouble();
-    m_y_size = config["ySize"].toDouble();
-    m_scaling = config["Scaling"].toDouble();
-
-    m_markerSize = config["markerSize"].toDouble();
-    m_lineWidth = config["lineWidth"].toDouble();
-
-    updateAxisConfig(config["xAxis"].toObject(), m_XAxis);
-    updateAxisConfig(config["yAxis"].toObject(), m_YAxis);
-
-    QFont keyFont;
-    keyFont.fromString(config["KeyFont"].toString());
-    m_chart->legend()->setFont(keyFont);
-
-    if (config["Legend"].toBool()) {
-        m_chart->legend()->setVisible(true);
-        if (config["Alignment"].toInt() == Qt::AlignTop
-            || config["Alignment"].toInt() == Qt::AlignBottom
-            || config["Alignment"].toInt() == Qt::AlignLeft
-            || config["Alignment"].toInt() == Qt::AlignRight)
-            m_chart->legend()->setAlignment(Qt::Alignment(config["Alignment"].toInt()));
-        else
-            m_chart->legend()->setAlignment(Qt::AlignRight);
-        for (PeakCallOut* call : m_peak_anno)
-            call->setFont(keyFont);
-    } else {
-        m_chart->legend()->setVisible(false);
-    }
-    setTitle(config["Title"].toString());
-
-    int Theme = config["Theme"].toInt();
-    if (Theme < 8)
-        m_chart->setTheme(static_cast<QChart::ChartTheme>(Theme));
-    else {
-        for (int i = 0; i < m_series.size(); ++i) {
-            if (!m_series[i])
-                continue;
-
-            if (qobject_cast<QXYSeries*>(m_series[i])) {
-                QXYSeries* series = qobject_cast<QXYSeries*>(m_series[i]);
-                series->setColor(QColor("black"));
-                if (qobject_cast<QScatterSeries*>(series)) {
-                    qobject_cast<QScatterSeries*>(series)->setBorderColor(QColor("black"));
+    // JSON is parsed and validated once, the appliers below only read struct fields
+    QStringList errors;
+    ChartConfig config = ChartConfig::fromJson(chartconfig, &errors);
+    for (const QString& error : qAsConst(errors))
+        qWarning() << "Chart config:" << error;
+
+    // Only the expensive appliers (theme, fonts, series) are limited to changed fields
+    const ChartConfig::Changes changes = m_chart_config_applied ? config.diff(*m_chart_config) : ChartConfig::Changes::all();
+    m_chart_config_applied = true;
+
+    m_lastChartConfig = m_chart_config->toJson();
+    *m_chart_config = std::move(config);
+    const ChartConfig& current = *m_chart_config;
+
+    // Autoscaling, zooming and panning move the axes without touching the stored config,
+    // so the axis blocks are always applied instead of being diffed against it
+    if (current.xAxis.present)
+        updateAxisConfig(current.xAxis, m_XAxis);
+    if (current.yAxis.present)
+        updateAxisConfig(current.yAxis, m_YAxis);
+
+    // A new theme resets all fonts, so legend and fonts have to follow it
+    const bool theme = changes.test(ChartConfig::themeField);
+
+    if (theme) {
+        if (current.theme < 8)
+            m_chart->setTheme(static_cast<QChart::ChartTheme>(current.theme));
+        else {
+            for (int i = 0; i < m_series.size(); ++i) {
+                if (!m_series[i])
+                    continue;
+
+                if (qobject_cast<QXYSeries*>(m_series[i])) {
+                    QXYSeries* series = qobject_cast<QXYSeries*>(m_series[i]);
+                    series->setColor(QColor("black"));
+                    if (qobject_cast<QScatterSeries*>(series)) {
+                        qobject_cast<QScatterSeries*>(series)->setBorderColor(QColor("black"));
+                    }
+                } else if (qobject_cast<QAreaSeries*>(m_series[i])) {
+                    QAreaSeries* series = qobject_cast<QAreaSeries*>(m_series[i]);
+                    QLinearGradient gradient(QPointF(0, 0), QPointF(0, 1));
+                    gradient.setColorAt(0.0, QColor("darkGray"));
+                    gradient.setColorAt(1.0, QColor("lightGray"));
+                    gradient.setCoordinateMode(QGradient::ObjectBoundingMode);
+                    series->setBrush(gradient);
+                    series->setOpacity(0.4);
+                    QPen pen(QColor("darkGray"));
+                    pen.setWidth(3);
+                    series->setPen(pen);
                 }
-            } else if (qobject_cast<QAreaSeries*>(m_series[i])) {
-                QAreaSeries* series = qobject_cast<QAreaSeries*>(m_series[i]);
-                QLinearGradient gradient(QPointF(0, 0), QPointF(0, 1));
-                gradient.setColorAt(0.0, QColor("darkGray"));
-                gradient.setColorAt(1.0, QColor("lightGray"));
-                gradient.setCoordinateMode(QGradient::ObjectBoundingMode);
-                series->setBrush(gradient);
-                series->setOpacity(0.4);
-                QPen pen(QColor("darkGray"));
-                pen.setWidth(3);
-                series->setPen(pen);
             }
             QBrush brush;
             brush.setColor(Qt::transparent);
@@ -785,19 +922,40 @@ void ChartView::setChartConfig(const QJsonObject& chartconfig)
             m_YAxis->setLabelsBrush(QBrush(Qt::black));
         }
     }
-    for (QPointer<PeakCallOut>& call : m_peak_anno) {
-        if (!call)
-            continue;
-        call->setVisible(config["Annotation"].toBool());
-        call->setFont(config["KeyFont"].toString());
+
+    if (theme || changes.test(ChartConfig::keyFontField) || changes.test(ChartConfig::legendField) || changes.test(ChartConfig::alignmentField)) {
+        QFont keyFont;
+        keyFont.fromString(current.keyFont);
+        m_chart->legend()->setFont(keyFont);
+
+        m_chart->legend()->setVisible(current.legend);
+        if (current.legend)
+            m_chart->legend()->setAlignment(Qt::Alignment(current.alignment));
     }
-    setFontConfig(config);
+
+    if (changes.test(ChartConfig::titleField))
+        setTitle(current.title);
+
+    if (changes.test(ChartConfig::annotationField) || changes.test(ChartConfig::keyFontField)) {
+        QFont keyFont;
+        keyFont.fromString(current.keyFont);
+        m_callouts->setFont(keyFont);
+        m_callouts->setEnabled(current.annotation);
+    }
+
+    if (theme || changes.test(ChartConfig::titleFontField) || changes.test(ChartConfig::keyFontField)
+        || (changes.xAxis & ChartAxisConfig::fontFields()).any() || (changes.yAxis & ChartAxisConfig::fontFields()).any())
+        applyFontConfig(current);
+
     m_apply_action = 1;
     m_action_button->setHidden(false);
     m_prevent_notification = true;
 
-    QSignalBlocker block(m_chartconfigdialog);
-    m_chartconfigdialog->setChartConfig(m_currentChartConfig);
+    // A hidden dialog is filled from the current config when it is opened
+    if (changes.any() && m_chartconfigdialog && m_chartconfigdialog->isVisible()) {
+        QSignalBlocker block(m_chartconfigdialog);
+        m_chartconfigdialog->setChartConfig(currentChartConfig());
+    }
 }
 
 void ChartView::applyConfigAction()
@@ -805,7 +963,8 @@ void ChartView::applyConfigAction()
     if (m_apply_action == -1) {
         setChartConfig(m_lastChartConfig);
     } else if (m_apply_action == 1) {
-        setChartConfig(ChartTools::MergeJsonObject(getChartConfig(), m_pendingChartConfig));
+        // The pending config was already merged with the full config in updateChartConfig
+        setChartConfig(m_pendingChartConfig);
     }
     m_action_button->setHidden(true);
     m_ignore->setHidden(true);
@@ -844,6 +1003,27 @@ void ChartView::setFontConfig(const QJsonObject& chartconfig)
     m_chart->legend()->setFont(keyFont);
 }
 
+void ChartView::applyFontConfig(const ChartConfig& config)
+{
+    QFont font;
+    font.fromString(config.xAxis.titleFont);
+    m_XAxis->setTitleFont(font);
+    font.fromString(config.xAxis.ticksFont);
+    m_XAxis->setLabelsFont(font);
+
+    font.fromString(config.yAxis.titleFont);
+    m_YAxis->setTitleFont(font);
+    font.fromString(config.yAxis.ticksFont);
+    m_YAxis->setLabelsFont(font);
+
+    font.fromString(config.titleFont);
+    m_chart->setTitleFont(font);
+
+    QFont keyFont;
+    keyFont.fromString(config.keyFont);
+    m_chart->legend()->setFont(keyFont);
+}
+
 void ChartView::setTitle(const QString& str)
 {
     m_chart->setTitle(str);
@@ -873,21 +1053,20 @@ QJsonObject ChartView::getAxisConfig(const QAbstractAxis* axis) const
     return config;
 }
 
+QJsonObject ChartView::currentChartConfig() const
+{
+    return m_chart_config->toJson();
+}
+
 QJsonObject ChartView::getChartConfig() const
 {
-    QJsonObject chartconfig = m_currentChartConfig;
+    QJsonObject chartconfig = m_chart_config->toJson();
 
     if (m_hasAxis) {
         chartconfig["xAxis"] = getAxisConfig(m_XAxis);
         chartconfig["yAxis"] = getAxisConfig(m_YAxis);
     }
     chartconfig["Legend"] = m_chart->legend()->isVisible();
-    chartconfig["ScalingLocked"] = m_lock_scaling;
-    chartconfig["xSize"] = m_x_size;
-    chartconfig["ySize"] = m_y_size;
-    chartconfig["Scaling"] = m_scaling;
-    chartconfig["lineWidth"] = m_lineWidth;
-    chartconfig["markerSize"] = m_markerSize;
 
     chartconfig["KeyFont"] = m_chart->legend()->font().toString();
     chartconfig["Alignment"] = static_cast<int>(m_chart->legend()->alignment());
@@ -938,6 +1117,10 @@ void ChartView::exportPNG()
     QChart::AnimationOptions animation = m_chart->animationOptions();
     m_chart->setAnimationOptions(QChart::NoAnimation);
 
+    // Exported images are rendered by Qt Charts at full resolution, not from the screen frame
+    RenderBackend backend = m_chart_private->renderBackend();
+    m_chart_private->setRenderBackend(RenderBackend::Native);
+
     // Prepare for export
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
@@ -946,20 +1129,19 @@ void ChartView::exportPNG()
     QSize widgetSize = m_centralWidget->size();
 
     // Resize for export
-    m_chart->resize(m_x_size, m_y_size);
-    m_centralWidget->resize(m_x_size, m_y_size);
+    const ChartConfig& config = *m_chart_config;
+    m_chart->resize(config.xSize, config.ySize);
+    m_centralWidget->resize(config.xSize, config.ySize);
 
-    // Update callouts and scene
-    for (PeakCallOut* call : m_peak_anno) {
-        call->update();
-    }
+    // Lay out the callouts once the chart has settled at the export size
     m_chart->scene()->update();
     QApplication::processEvents();
+    m_callouts->relayout();
 
     // Setup for high-resolution rendering
     int w = m_chart->rect().size().width();
     int h = m_chart->rect().size().height();
-    QImage image(QSize(m_scaling * w, m_scaling * h), QImage::Format_ARGB32);
+    QImage image(QSize(config.scaling * w, config.scaling * h), QImage::Format_ARGB32);
     image.fill(Qt::transparent);
 
     QPainter painter(&image);
@@ -972,7 +1154,7 @@ void ChartView::exportPNG()
     bool yGrid = m_YAxis->isGridLineVisible();
 
     // Hide grid lines if configured
-    if (m_currentChartConfig["noGrid"].toBool()) {
+    if (config.noGrid) {
         m_XAxis->setGridLineVisible(false);
         m_YAxis->setGridLineVisible(false);
     }
@@ -981,7 +1163,7 @@ void ChartView::exportPNG()
     QPen xPen = m_XAxis->linePen();
     QPen yPen = m_YAxis->linePen();
 
-    if (m_currentChartConfig["emphasizeAxis"].toBool()) {
+    if (config.emphasizeAxis) {
         QPen emphasizedPen = m_XAxis->linePen();
         emphasizedPen.setColor(Qt::black);
         emphasizedPen.setWidth(2);
@@ -991,7 +1173,7 @@ void ChartView::exportPNG()
 
     // Handle background transparency
     QBrush brush_backup = m_chart->backgroundBrush();
-    if (m_currentChartConfig["transparentImage"].toBool()) {
+    if (config.transparentImage) {
         QBrush transparentBrush;
         transparentBrush.setColor(Qt::transparent);
         m_chart->setBackgroundBrush(transparentBrush);
@@ -1007,10 +1189,10 @@ void ChartView::exportPNG()
 
             // Apply export-specific settings
             if (auto scatter = qobject_cast<QScatterSeries*>(serie)) {
-                scatter->setMarkerSize(m_markerSize);
+                scatter->setMarkerSize(config.markerSize);
                 scatter->setBorderColor(Qt::transparent);
             } else if (auto line = qobject_cast<LineSeries*>(serie)) {
-                line->setLineWidth(m_lineWidth);
+                line->setLineWidth(config.lineWidth);
             }
 
             // Disable OpenGL for export
@@ -1021,12 +1203,12 @@ void ChartView::exportPNG()
     }
 
     // Render chart to image
-    m_chart->scene()->render(&painter, QRectF(0, 0, m_scaling * w, m_scaling * h), m_chart->rect());
+    m_chart->scene()->render(&painter, QRectF(0, 0, config.scaling * w, config.scaling * h), m_chart->rect());
 
     // Process the image as needed
     QPixmap pixmap;
 
-    if (m_currentChartConfig["cropImage"].toBool()) {
+    if (config.cropImage) {
         QRect region = QRegion(QBitmap::fromImage(image.createMaskFromColor(0x00000000))).boundingRect();
         pixmap = QPixmap::fromImage(image.copy(region));
     } else {
@@ -1052,14 +1234,13 @@ void ChartView::exportPNG()
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     m_centralWidget->resize(widgetSize);
 
-    // Update callouts
-    for (PeakCallOut* call : m_peak_anno) {
-        call->update();
-    }
+    // Callouts follow the restored size
+    m_callouts->scheduleLayout();
 
     // Restore animation settings
     m_chart->setAnimationOptions(animation);
     m_chart_private->setVerticalLineEnabled(verticalLineEnabled);
+    m_chart_private->setRenderBackend(backend);
 
     // Save the image
     m_last_filename = str;
@@ -1106,12 +1287,12 @@ void ChartView::loadFontConfig()
         return;
     auto content = file.readAll();
     QJsonDocument doc = QJsonDocument::fromJson(content);
-    // m_currentChartConfig = doc.object();
     setFontConfig(doc.object());
     QFileInfo info(str);
-    addExportSetting(info.baseName(), str, m_currentChartConfig);
-    emit exportSettingsFileAdded(info.baseName(), str, m_currentChartConfig);
-    m_chartconfigdialog->setChartConfig(currentChartConfig());
+    addExportSetting(info.baseName(), str, currentChartConfig());
+    emit exportSettingsFileAdded(info.baseName(), str, currentChartConfig());
+    if (m_chartconfigdialog)
+        m_chartconfigdialog->setChartConfig(currentChartConfig());
 }
 
 // Moved inline functions from header for header dependency reduction (Claude Generated)
@@ -1128,6 +1309,17 @@ SelectStrategy ChartView::currentSelectStrategy() const
 
 void ChartView::removeSeries(QAbstractSeries* series)
 {
+    if (QXYSeries* xy = qobject_cast<QXYSeries*>(series))
+        restoreSeriesData(xy);
+    // The outliers were added along with the boxes and leave with them
+    if (BoxPlotSeries* boxplot = qobject_cast<BoxPlotSeries*>(series)) {
+        QScatterSeries* outliers = boxplot->outlierSeries();
+        if (outliers && outliers->chart() == m_chart) {
+            m_chart_private->untrackSeries(outliers);
+            m_chart->removeSeries(outliers);
+        }
+    }
+    m_chart_private->untrackSeries(series);
     m_chart->removeSeries(series);
 }
 
@@ -1138,7 +1330,9 @@ QList<QAbstractSeries*> ChartView::series() const
 
 void ChartView::setModal(bool modal)
 {
-    m_chartconfigdialog->setModal(modal);
+    m_modal = modal;
+    if (m_chartconfigdialog)
+        m_chartconfigdialog->setModal(modal);
 }
 
 void ChartView::setAutoScaleStrategy(AutoScaleStrategy strategy)
@@ -1146,10 +1340,20 @@ void ChartView::setAutoScaleStrategy(AutoScaleStrategy strategy)
     m_autoscalestrategy = strategy;
 }
 
+void ChartView::setRenderBackend(RenderBackend backend)
+{
+    m_chart_private->setRenderBackend(backend);
+}
+
+RenderBackend ChartView::renderBackend() const
+{
+    return m_chart_private->renderBackend();
+}
+
 qreal ChartView::YMaxRange() const
 {
     if (m_hasAxis)
-        return m_YAxis->max();
+        return m_y_transform.unmap(m_YAxis->max());
     else
         return 0;
 }
@@ -1157,7 +1361,7 @@ qreal ChartView::YMaxRange() const
 qreal ChartView::YMinRange() const
 {
     if (m_hasAxis)
-        return m_YAxis->min();
+        return m_y_transform.unmap(m_YAxis->min());
     else
         return 0;
 }
@@ -1165,7 +1369,7 @@ qreal ChartView::YMinRange() const
 qreal ChartView::XMaxRange() const
 {
     if (m_hasAxis)
-        return m_XAxis->max();
+        return m_x_transform.unmap(m_XAxis->max());
     else
         return 0;
 }
@@ -1173,7 +1377,7 @@ qreal ChartView::XMaxRange() const
 qreal ChartView::XMinRange() const
 {
     if (m_hasAxis)
-        return m_XAxis->min();
+        return m_x_transform.unmap(m_XAxis->min());
     else
         return 0;
 }
@@ -1182,13 +1386,12 @@ void ChartView::setXRange(qreal xmin, qreal xmax, bool nice)
 {
     if (m_hasAxis) {
         if (nice) {
-            m_XAxis->setMin(ChartTools::NiceScalingMin(xmin));
-            m_XAxis->setMax(ChartTools::NiceScalingMax(xmax));
+            m_XAxis->setMin(m_x_transform.map(ChartTools::NiceScalingMin(xmin)));
+            m_XAxis->setMax(m_x_transform.map(ChartTools::NiceScalingMax(xmax)));
         } else {
-            m_XAxis->setMin(xmin);
-            m_XAxis->setMax(xmax);
+            m_XAxis->setMin(m_x_transform.map(xmin));
+            m_XAxis->setMax(m_x_transform.map(xmax));
         }
-        m_XAxis->setTickInterval(ChartTools::CustomCeil(xmax + xmin) / 10.0);
     }
 }
 
@@ -1196,9 +1399,9 @@ void ChartView::setXMax(qreal xmax, bool nice)
 {
     if (m_hasAxis) {
         if (nice)
-            m_XAxis->setMax(ChartTools::NiceScalingMax(xmax));
+            m_XAxis->setMax(m_x_transform.map(ChartTools::NiceScalingMax(xmax)));
         else
-            m_XAxis->setMax(xmax);
+            m_XAxis->setMax(m_x_transform.map(xmax));
     }
 }
 
@@ -1206,9 +1409,9 @@ void ChartView::setXMin(qreal xmin, bool nice)
 {
     if (m_hasAxis) {
         if (nice)
-            m_XAxis->setMin(ChartTools::NiceScalingMin(xmin));
+            m_XAxis->setMin(m_x_transform.map(ChartTools::NiceScalingMin(xmin)));
         else
-            m_XAxis->setMin(xmin);
+            m_XAxis->setMin(m_x_transform.map(xmin));
     }
 }
 
@@ -1216,14 +1419,13 @@ void ChartView::setYRange(qreal ymin, qreal ymax, bool nice)
 {
     if (m_hasAxis) {
         if (nice) {
-            m_YAxis->setMin(ChartTools::NiceScalingMin(ymin));
-            m_YAxis->setMax(ChartTools::NiceScalingMax(ymax));
+            m_YAxis->setMin(m_y_transform.map(ChartTools::NiceScalingMin(ymin)));
+            m_YAxis->setMax(m_y_transform.map(ChartTools::NiceScalingMax(ymax)));
         } else {
-            m_YAxis->setMin(ymin);
-            m_YAxis->setMax(ymax);
+            m_YAxis->setMin(m_y_transform.map(ymin));
+            m_YAxis->setMax(m_y_transform.map(ymax));
         }
-        m_YAxis->setTickInterval(ChartTools::CustomCeil(ymax + ymin) / 10.0);
-        m_chart_private->updateView(ymin, ymax);
+        m_chart_private->updateView(m_y_transform.map(ymin), m_y_transform.map(ymax));
     }
 }
 
@@ -1231,9 +1433,9 @@ void ChartView::setYMax(qreal ymax, bool nice)
 {
     if (m_hasAxis) {
         if (nice)
-            m_YAxis->setMax(ChartTools::NiceScalingMax(ymax));
+            m_YAxis->setMax(m_y_transform.map(ChartTools::NiceScalingMax(ymax)));
         else
-            m_YAxis->setMax(ymax);
+            m_YAxis->setMax(m_y_transform.map(ymax));
     }
 }
 
@@ -1241,9 +1443,9 @@ void ChartView::setYMin(qreal ymin, bool nice)
 {
     if (m_hasAxis) {
         if (nice)
-            m_YAxis->setMin(ChartTools::NiceScalingMin(ymin));
+            m_YAxis->setMin(m_y_transform.map(ChartTools::NiceScalingMin(ymin)));
         else
-            m_YAxis->setMin(ymin);
+            m_YAxis->setMin(m_y_transform.map(ymin));
     }
 }
 
@@ -1277,6 +1479,318 @@ void ChartView::removeAllVerticalLines()
     m_chart_private->removeAllVerticalLines();
 }
 
+void ChartView::addHorizontalLine(double position_y)
+{
+    m_chart_private->addHorizontalLine(position_y);
+}
+
+void ChartView::removeAllHorizontalLines()
+{
+    m_chart_private->removeAllHorizontalLines();
+}
+
+QVector<double> ChartView::verticalLines() const
+{
+    return m_chart_private->verticalLines();
+}
+
+QVector<double> ChartView::horizontalLines() const
+{
+    return m_chart_private->horizontalLines();
+}
+
+bool ChartView::hasCallout(const QAbstractSeries* series) const
+{
+    return m_callouts->hasCallout(series);
+}
+
+void ChartView::setPeakDetection(bool enabled, const PeakPicker::Options& options, int maxLabels)
+{
+    if (!enabled) {
+        m_callouts->setPeakPicker(nullptr);
+        delete m_peak_picker;
+        m_peak_picker = nullptr;
+        return;
+    }
+
+    if (!m_peak_picker) {
+        m_peak_picker = new PeakPicker(this);
+        m_peak_picker->setAxisTransforms(m_x_transform, m_y_transform);
+        for (const QPointer<QAbstractSeries>& series : qAsConst(m_series)) {
+            if (QLineSeries* line = qobject_cast<QLineSeries*>(series.data()))
+                m_peak_picker->addSeries(line);
+        }
+    }
+    m_peak_picker->setOptions(options);
+    m_callouts->setMaximumPeakLabels(maxLabels);
+    m_callouts->setPeakPicker(m_peak_picker);
+}
+
+void ChartView::setAxisTransform(Qt::Orientation orientation, const AxisTransform& transform)
+{
+    AxisTransform& current = orientation == Qt::Horizontal ? m_x_transform : m_y_transform;
+    const AxisTransform previous = current;
+    current = transform;
+    m_chart_private->setAxisTransform(orientation, transform);
+    if (orientation == Qt::Horizontal)
+        m_callouts->setLabelTransform(transform);
+    if (m_peak_picker)
+        m_peak_picker->setAxisTransforms(m_x_transform, m_y_transform);
+
+    // All points are mapped from the cached data again, a linear chart gets its data back
+    const bool linear = m_x_transform.isLinear() && m_y_transform.isLinear();
+    for (const QPointer<QAbstractSeries>& series : qAsConst(m_series)) {
+        QXYSeries* xy = qobject_cast<QXYSeries*>(series.data());
+        if (!xy)
+            continue;
+        if (linear)
+            restoreSeriesData(xy);
+        else
+            transformSeries(xy);
+    }
+
+    QPointer<QValueAxis> axis = orientation == Qt::Horizontal ? m_XAxis : m_YAxis;
+    if (axis) {
+        qreal min = transform.map(previous.unmap(axis->min()));
+        qreal max = transform.map(previous.unmap(axis->max()));
+        if (!std::isfinite(min) || !std::isfinite(max) || max <= min) {
+            min = axis->min();
+            max = axis->max();
+        }
+        replaceAxis(orientation, min, max);
+    }
+    forceFormatAxis();
+}
+
+void ChartView::zoomBack()
+{
+    m_chart_private->zoomBack();
+}
+
+void ChartView::zoomForward()
+{
+    m_chart_private->zoomForward();
+}
+
+bool ChartView::canZoomBack() const
+{
+    return m_chart_private->canZoomBack();
+}
+
+bool ChartView::canZoomForward() const
+{
+    return m_chart_private->canZoomForward();
+}
+
+void ChartView::clearZoomHistory()
+{
+    m_chart_private->clearZoomHistory();
+}
+
+QList<QPointF> ChartView::dataPoints(const QXYSeries* series) const
+{
+    const LineSeries* line = qobject_cast<const LineSeries*>(series);
+    if (line && line->hasCompactStorage())
+        return line->samples().points();
+    auto it = m_data_points.constFind(series);
+    if (it != m_data_points.cend())
+        return it->points;
+    return series ? series->points() : QList<QPointF>();
+}
+
+void ChartView::transformSeries(QXYSeries* series)
+{
+    auto it = m_data_points.find(series);
+    if (it == m_data_points.end()) {
+        it = m_data_points.insert(series, TransformedSeries{ series->points(), QPointF(), {} });
+
+        // Later changes arrive as data values and are mapped where they happened
+        QVector<QMetaObject::Connection>& connections = it->connections;
+        connections << connect(series, &QXYSeries::pointsReplaced, this, [this, series]() {
+            auto entry = m_data_points.find(series);
+            if (m_transforming || entry == m_data_points.end())
+                return;
+            entry->points = series->points();
+            transformSeries(series);
+        });
+        connections << connect(series, &QXYSeries::pointAdded, this, [this, series](int index) {
+            auto entry = m_data_points.find(series);
+            if (m_transforming || entry == m_data_points.end())
+                return;
+            entry->points.insert(index, series->at(index));
+            transformPoint(series, index);
+        });
+        connections << connect(series, &QXYSeries::pointReplaced, this, [this, series](int index) {
+            auto entry = m_data_points.find(series);
+            if (m_transforming || entry == m_data_points.end())
+                return;
+            entry->points[index] = series->at(index);
+            transformPoint(series, index);
+        });
+        connections << connect(series, &QXYSeries::pointRemoved, this, [this, series](int index) {
+            auto entry = m_data_points.find(series);
+            if (entry != m_data_points.end())
+                entry->points.removeAt(index);
+        });
+        connections << connect(series, &QXYSeries::pointsRemoved, this, [this, series](int index, int count) {
+            auto entry = m_data_points.find(series);
+            if (entry != m_data_points.end())
+                entry->points.remove(index, count);
+        });
+        connections << connect(series, &QObject::destroyed, this, [this, series]() { m_data_points.remove(series); });
+    }
+
+    QPointF clip;
+    const QList<QPointF> points = AxisTransform::map(it->points, m_x_transform, m_y_transform, &clip);
+    it->clip = clip;
+    m_transforming = true;
+    series->replace(points);
+    m_transforming = false;
+}
+
+void ChartView::transformPoint(QXYSeries* series, int index)
+{
+    const TransformedSeries& entry = m_data_points[series];
+    QPointF point = m_x_transform.map(entry.points[index], m_y_transform);
+    if (!std::isfinite(point.x()))
+        point.setX(std::isfinite(entry.clip.x()) ? entry.clip.x() : 0);
+    if (!std::isfinite(point.y()))
+        point.setY(std::isfinite(entry.clip.y()) ? entry.clip.y() : 0);
+
+    m_transforming = true;
+    series->replace(index, point);
+    m_transforming = false;
+}
+
+void ChartView::restoreSeriesData(QXYSeries* series)
+{
+    auto it = m_data_points.find(series);
+    if (it == m_data_points.end())
+        return;
+
+    for (const QMetaObject::Connection& connection : qAsConst(it->connections))
+        disconnect(connection);
+    const QList<QPointF> points = it->points;
+    m_data_points.erase(it);
+    series->replace(points);
+}
+
+void ChartView::replaceAxis(Qt::Orientation orientation, qreal min, qreal max)
+{
+    QPointer<QValueAxis>& axis = orientation == Qt::Horizontal ? m_XAxis : m_YAxis;
+    const bool transformed = !axisTransform(orientation).isLinear();
+
+    // Only a category axis can put labels at arbitrary values, the type follows the transform
+    if (bool(qobject_cast<QCategoryAxis*>(axis.data())) != transformed) {
+        QValueAxis* previous = axis.data();
+        QValueAxis* replacement = transformed ? new QCategoryAxis : new QValueAxis;
+        replacement->setTitleText(previous->titleText());
+        replacement->setTitleFont(previous->titleFont());
+        replacement->setLabelsFont(previous->labelsFont());
+        replacement->setLabelFormat(previous->labelFormat());
+        replacement->setGridLineVisible(previous->isGridLineVisible());
+        replacement->setVisible(previous->isVisible());
+
+        QList<QAbstractSeries*> attached;
+        for (QAbstractSeries* series : m_chart->series()) {
+            if (series->attachedAxes().contains(previous))
+                attached << series;
+        }
+        const Qt::Alignment alignment = previous->alignment();
+        m_chart->removeAxis(previous);
+        previous->deleteLater();
+
+        m_chart->addAxis(replacement, alignment);
+        for (QAbstractSeries* series : qAsConst(attached)) {
+            series->attachAxis(replacement);
+            if (HistogramSeries* histogram = qobject_cast<HistogramSeries*>(series)) {
+                if (orientation == Qt::Horizontal)
+                    connect(replacement, &QValueAxis::rangeChanged, histogram, &HistogramSeries::setViewRange);
+            }
+        }
+        axis = replacement;
+        m_callouts->trackAxis(replacement);
+        connect(replacement, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleZoomRecord);
+        connect(replacement, &QValueAxis::rangeChanged, m_chart_private, &ChartViewPrivate::scheduleTicks);
+        if (orientation == Qt::Horizontal)
+            connect(replacement, &QValueAxis::rangeChanged, this, &ChartView::scheduleDecimation);
+
+        if (QCategoryAxis* category = qobject_cast<QCategoryAxis*>(replacement)) {
+            category->setLabelsPosition(QCategoryAxis::AxisLabelsPositionOnValue);
+            connect(category, &QValueAxis::rangeChanged, this, [this, orientation]() { updateTransformLabels(orientation); });
+        }
+        emit axisReplaced(orientation, previous, replacement);
+    }
+    axis->setRange(min, max);
+    updateTransformLabels(orientation);
+}
+
+void ChartView::scheduleFormatAxis()
+{
+    if (m_format_scheduled)
+        return;
+    m_format_scheduled = true;
+    QMetaObject::invokeMethod(
+        this, [this]() {
+            m_format_scheduled = false;
+            forceFormatAxis();
+        },
+        Qt::QueuedConnection);
+}
+
+void ChartView::scheduleDecimation()
+{
+    if (m_decimation_scheduled)
+        return;
+    m_decimation_scheduled = true;
+    QMetaObject::invokeMethod(this, &ChartView::decimateSeries, Qt::QueuedConnection);
+}
+
+void ChartView::decimateSeries()
+{
+    m_decimation_scheduled = false;
+    // Before the first layout the series keep their initial decimation
+    if (!m_XAxis || m_chart->plotArea().isEmpty())
+        return;
+
+    const double min = m_x_transform.unmap(m_XAxis->min());
+    const double max = m_x_transform.unmap(m_XAxis->max());
+    const int columns = qMax(1, int(std::ceil(m_chart->plotArea().width() * devicePixelRatioF())));
+    ZoomFrame* frame = m_chart_private->currentZoomFrame();
+    for (const QPointer<QAbstractSeries>& series : qAsConst(m_series)) {
+        LineSeries* line = qobject_cast<LineSeries*>(series.data());
+        if (!line || !line->hasCompactStorage())
+            continue;
+
+        // Back in a viewport of the zoom history, its decimation is still good
+        if (frame) {
+            auto it = frame->decimations.constFind(line);
+            if (it != frame->decimations.cend() && it->matches(line->samplesRevision(), min, max, columns)) {
+                line->setViewport(min, max, columns, it->points);
+                continue;
+            }
+        }
+        line->setViewport(min, max, columns);
+        if (frame)
+            frame->decimations.insert(line, ZoomFrame::Decimation{ line->samplesRevision(), min, max, columns, line->viewportPoints() });
+    }
+}
+
+void ChartView::updateTransformLabels(Qt::Orientation orientation)
+{
+    QCategoryAxis* axis = qobject_cast<QCategoryAxis*>((orientation == Qt::Horizontal ? m_XAxis : m_YAxis).data());
+    if (!axis)
+        return;
+
+    const AxisTransform& transform = axisTransform(orientation);
+    const QStringList labels = axis->categoriesLabels();
+    for (const QString& label : labels)
+        axis->remove(label);
+    axis->setStartValue(axis->min());
+    for (double value : transform.ticks(axis->min(), axis->max()))
+        axis->append(AxisTransform::label(value), transform.map(value));
+}
+
 void ChartView::setSelectBox(const QPointF& topleft, const QPointF& bottomright)
 {
     m_chart_private->setSelectBox(topleft, bottomright);
@@ -20,18 +20,24 @@
 #pragma once
 
 // Reduced includes for faster compilation (Claude Generated)
+#include <QtCore/QHash>
 #include <QtCore/QJsonObject>
 #include <QtCore/QPointer>
+#include <QtCore/QVector>
 #include <QtWidgets/QScrollArea>
 
 #include <memory>
 
+#include "axistransform.h"
+#include "peakpicker.h"
+
 // Forward declarations to reduce header dependencies (Claude Generated)
 class QChart;
 class QAbstractSeries;
 class QAbstractAxis;
 class QLineSeries;
 class QValueAxis;
+class QXYSeries;
 class QGridLayout;
 class QPushButton;
 class QStackedWidget;
@@ -39,14 +45,16 @@ class QResizeEvent;
 
 class ChartViewPrivate;
 class ChartConfigDialog;
-class PeakCallOut;
+class CalloutLayout;
 
 // Forward declare enums (defined in chartviewprivate.h)
 enum class ZoomStrategy;
 enum class SelectStrategy;
 enum class AutoScaleStrategy;
+enum class RenderBackend;
 
 struct ChartConfig;
+struct ChartAxisConfig;
 
 // Default chart configuration settings
 const QJsonObject DefaultConfig{
@@ -82,14 +90,23 @@ class ChartView : public QScrollArea {
 public:
     /**
      * @brief Constructor for ChartView
+     *
+     * Menus and the configuration dialog are built on first use.
+     * @param lite Build no configuration UI at all, for pages showing many small charts
      */
-    ChartView();
+    explicit ChartView(bool lite = false);
 
     /**
      * @brief Destructor for ChartView
      */
     ~ChartView() override;
 
+    /**
+     * @brief Check if the view was built without configuration UI
+     * @return True for a lite view
+     */
+    bool isLite() const { return m_lite; }
+
     /**
      * @brief Set the zooming strategy for the chart
      * @param strategy The zoom strategy to use
@@ -131,7 +148,7 @@ public:
      * @brief Get the maximum Y value currently displayed
      * @return Maximum Y value
      */
-    qreal YMax() const { return m_ymax; }
+    qreal YMax() const { return m_y_transform.unmap(m_ymax); }
 
     /**
      * @brief Remove a series from the chart
@@ -172,6 +189,21 @@ public:
      */
     void setAutoScaleStrategy(AutoScaleStrategy strategy);
 
+    /**
+     * @brief Select how line and scatter series are drawn
+     *
+     * RenderBackend::Threaded rasterizes series on worker threads and keeps the
+     * GUI thread free for input handling while heavy plots redraw.
+     * @param backend The backend to use
+     */
+    void setRenderBackend(RenderBackend backend);
+
+    /**
+     * @brief Get the current render backend
+     * @return Current render backend
+     */
+    RenderBackend renderBackend() const;
+
     /**
      * @brief Get the maximum Y range value
      * @return Maximum Y value of the axis range
@@ -292,7 +324,7 @@ public:
      * @brief Get the current chart configuration
      * @return JsonObject containing the configuration
      */
-    QJsonObject currentChartConfig() const { return m_currentChartConfig; }
+    QJsonObject currentChartConfig() const;
 
     /**
      * @brief Get the chart configuration
@@ -351,6 +383,96 @@ public:
      */
     void removeAllVerticalLines();
 
+    /**
+     * @brief Add a horizontal line at specified position
+     * @param position_y Y position for the line
+     */
+    void addHorizontalLine(double position_y);
+
+    /**
+     * @brief Remove all horizontal lines
+     */
+    void removeAllHorizontalLines();
+
+    /**
+     * @brief Positions of the marker lines
+     * @return Sorted positions
+     */
+    QVector<double> verticalLines() const;
+    QVector<double> horizontalLines() const;
+
+    /**
+     * @brief Check if a series was added with a callout
+     * @param series The series
+     * @return True if a callout follows the series
+     */
+    bool hasCallout(const QAbstractSeries* series) const;
+
+    /**
+     * @brief Label the peaks of all line series
+     *
+     * Peaks are searched in parallel and again whenever the points of a
+     * series change; only the most prominent peaks in view get a label.
+     * @param enabled False removes the peak labels
+     * @param options Search options
+     * @param maxLabels Number of peak labels shown at once
+     */
+    void setPeakDetection(bool enabled, const PeakPicker::Options& options = PeakPicker::Options(), int maxLabels = 40);
+
+    /**
+     * @brief Put an axis on a logarithmic, symlog or custom scale
+     *
+     * Line and scatter series keep their data points in a per-series cache
+     * and hold the transformed points, mapped in one parallel pass per
+     * coordinate. The cache follows point changes of the series, so points
+     * appended or replaced later are still data values. Zooming and panning
+     * only move the axis range and never touch the points again.
+     *
+     * The axis becomes a QCategoryAxis whose labels are round data values,
+     * rebuilt with every range change. Autoscaling works in transformed units
+     * and snaps log axes to decades. All range setters and getters of this
+     * class, marker lines and the point signals use data values.
+     * @param orientation Qt::Horizontal for the x axis
+     * @param transform The transform, a default AxisTransform is linear
+     */
+    void setAxisTransform(Qt::Orientation orientation, const AxisTransform& transform);
+
+    /**
+     * @brief Get the transform of an axis
+     */
+    inline const AxisTransform& axisTransform(Qt::Orientation orientation) const
+    {
+        return orientation == Qt::Horizontal ? m_x_transform : m_y_transform;
+    }
+
+    /**
+     * @brief Data points of a series, untransformed
+     * @param series Series of this chart
+     * @return The cached data points while an axis is transformed, otherwise the points of the series
+     */
+    QList<QPointF> dataPoints(const QXYSeries* series) const;
+
+    /**
+     * @brief The peak picker while peak detection is enabled
+     * @return The picker or nullptr
+     */
+    inline PeakPicker* peakPicker() const { return m_peak_picker; }
+
+    /**
+     * @brief Whether the zoom history has an earlier viewport
+     */
+    bool canZoomBack() const;
+
+    /**
+     * @brief Whether the zoom history has a later viewport
+     */
+    bool canZoomForward() const;
+
+    /**
+     * @brief Forget all recorded viewports
+     */
+    void clearZoomHistory();
+
 public slots:
     /**
      * @brief Set selection box with given coordinates
@@ -407,6 +529,25 @@ public slots:
      */
     void zoomRect(const QPointF& point1, const QPointF& point2);
 
+    /**
+     * @brief Return to the previous viewport
+     *
+     * Every change of the axis ranges is recorded: rectangle zoom, the
+     * middle-click reset, ranges set after scaleUp() or scaleDown() and
+     * autoscaling. Going back restores ticks, the frame of the threaded render
+     * backend and the callout placement of the viewport as they were, without
+     * scanning the data again. Alt+Left (QKeySequence::Back) does the same;
+     * leftKey() can be connected here to use the plain arrow key instead.
+     */
+    void zoomBack();
+
+    /**
+     * @brief Return to the next viewport, undoing zoomBack()
+     *
+     * Alt+Right (QKeySequence::Forward) does the same.
+     */
+    void zoomForward();
+
     /**
      * @brief Apply font configuration
      * @param chartconfig The configuration to apply
@@ -414,52 +555,96 @@ public slots:
     void setFontConfig(const QJsonObject& chartconfig);
 
 private:
+    struct TransformedSeries {
+        QList<QPointF> points;
+        QPointF clip;
+        QVector<QMetaObject::Connection> connections;
+    };
+
+    void transformSeries(QXYSeries* series);
+    void transformPoint(QXYSeries* series, int index);
+    void restoreSeriesData(QXYSeries* series);
+    void replaceAxis(Qt::Orientation orientation, qreal min, qreal max);
+    void updateTransformLabels(Qt::Orientation orientation);
+
+    /**
+     * @brief Rescale the axes once control returns to the event loop, repeated calls coalesce
+     */
+    void scheduleFormatAxis();
+
+    /**
+     * @brief Decimate series in compact storage once control returns to the event loop
+     */
+    void scheduleDecimation();
+
+    /**
+     * @brief Hand series in compact storage the visible x range and the plot area width
+     */
+    void decimateSeries();
+
     void connectLegendCallbacks(QAbstractSeries* series, bool initialShowState);
 
     QStackedWidget* m_centralWidget;
     QWidget* m_configure;
 
-    QAction* m_lock_action;
+    QAction* m_lock_action = nullptr;
     ChartViewPrivate* m_chart_private;
     QPointer<QChart> m_chart;
-    QPushButton *m_config, *m_action_button, *m_ignore;
+    QPushButton *m_config = nullptr, *m_action_button, *m_ignore;
+    bool m_lite = false;
     void setUi();
+    void populateMenu();
+    void updateExportMenu();
+    void updateStrategyActions();
+    ChartConfigDialog* configDialog();
     bool has_legend, connected, m_hasAxis = false, m_manual_zoom = false;
     QString m_x_axis, m_y_axis;
     QString color2RGB(const QColor& color) const;
     void writeTable(const QString& str);
-    ChartConfigDialog* m_chartconfigdialog;
-    bool m_pending, m_lock_scaling, m_modal = true, m_prevent_notification = false;
+    ChartConfigDialog* m_chartconfigdialog = nullptr;
+    bool m_pending, m_modal = false, m_prevent_notification = false;
     qreal m_ymax, m_ymin, m_xmin, m_xmax;
     QVector<QPointer<QAbstractSeries>> m_series;
-    QVector<QPointer<PeakCallOut>> m_peak_anno;
+    CalloutLayout* m_callouts;
+    PeakPicker* m_peak_picker = nullptr;
 
-    QAction *m_configure_series, *m_select_none, *m_select_horizonal, *m_select_vertical, *m_select_rectangular, *m_zoom_none, *m_zoom_horizonal, *m_zoom_vertical, *m_zoom_rectangular;
-    QMenu *m_select_strategy, *m_zoom_strategy;
+    QAction *m_configure_series = nullptr, *m_select_none = nullptr, *m_select_horizonal = nullptr, *m_select_vertical = nullptr, *m_select_rectangular = nullptr;
+    QAction *m_zoom_none = nullptr, *m_zoom_horizonal = nullptr, *m_zoom_vertical = nullptr, *m_zoom_rectangular = nullptr;
+    QMenu *m_select_strategy = nullptr, *m_zoom_strategy = nullptr;
 
-    QJsonObject m_currentChartConfig, m_pendingChartConfig, m_lastChartConfig;
+    // Typed current config, JSON is only produced for the API and persistence
+    std::unique_ptr<ChartConfig> m_chart_config;
+    // The widgets start in their own defaults, not in the default config, so the first config is applied completely
+    bool m_chart_config_applied = false;
+    QJsonObject m_pendingChartConfig, m_lastChartConfig;
 
     QString m_name, m_last_filename;
     QPointer<QValueAxis> m_XAxis, m_YAxis;
 
     void scaleAxis(QPointer<QValueAxis> axis, qreal& min, qreal& max);
+    void scaleAxis(QPointer<QValueAxis> axis, const AxisTransform& transform, qreal& min, qreal& max);
+
+    AxisTransform m_x_transform, m_y_transform;
+    QHash<const QXYSeries*, TransformedSeries> m_data_points;
+    bool m_transforming = false;
+    bool m_decimation_scheduled = false;
+    bool m_format_scheduled = false;
     QGridLayout* mCentralLayout;
 
     // -1: button activated to revert
     // +1: button activated to apply
     int m_apply_action = 0;
-    int m_x_size = 600, m_y_size = 400, m_scaling = 2;
-    qreal m_lineWidth = 2, m_markerSize = 8;
 
     QString m_font;
     AutoScaleStrategy m_autoscalestrategy;
 
-    void updateAxisConfig(const QJsonObject& config, QAbstractAxis* axis);
+    void updateAxisConfig(const ChartAxisConfig& config, QAbstractAxis* axis);
+    void applyFontConfig(const ChartConfig& config);
     QJsonObject getAxisConfig(const QAbstractAxis* axis) const;
     void applyConfigAction();
 
     QHash<QString, QPair<QString, QJsonObject>> m_stored_exportsettings;
-    QMenu* m_exportMenu;
+    QMenu* m_exportMenu = nullptr;
 
 private slots:
     void plotSettings();
@@ -478,6 +663,13 @@ signals:
     void lastDirChanged(const QString& dir);
     void pointDoubleClicked(const QPointF& point);
     void zoomChanged();
+    void zoomHistoryChanged();
+
+    /**
+     * @brief An axis was swapped for a transform, previous is deleted once control returns to the event loop
+     */
+    void axisReplaced(Qt::Orientation orientation, QValueAxis* previous, QValueAxis* replacement);
+
     void scaleUp();
     void scaleDown();
     void addRect(const QPointF& point1, const QPointF& point2);
@@ -17,12 +17,16 @@
  *
  */
 
+#include "calloutlayout.h"
 #include "chartconfig.h"
+#include "markerlines.h"
 #include "peakcallout.h"
+#include "renderpipeline.h"
 #include "series.h"
 #include "tools.h"
 
 #include <QtCharts/QAreaSeries>
+#include <QtCharts/QCategoryAxis>
 #include <QtCharts/QChart>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLegendMarker>
@@ -47,6 +51,7 @@
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QPushButton>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -78,7 +83,14 @@ ChartViewPrivate::ChartViewPrivate(QChart* chart, QWidget* parent)
     m_zoom_box->setBrush(QColor::fromRgbF(0.18, 0.64, 0.71, 0.6)); // Semi-transparent zoom box
     setMouseTracking(true);
 
+    m_marker_lines = std::make_unique<MarkerLines>(chart);
+
     connect(this, &ChartViewPrivate::zoomChanged, this, &ChartViewPrivate::updateLines);
+    connect(chart, &QChart::plotAreaChanged, this, &ChartViewPrivate::updateLines);
+    connect(chart, &QChart::plotAreaChanged, this, &ChartViewPrivate::scheduleFrame);
+    connect(this, &ChartViewPrivate::zoomChanged, this, &ChartViewPrivate::scheduleZoomRecord);
+    connect(this, &ChartViewPrivate::zoomChanged, this, &ChartViewPrivate::scheduleTicks);
+    connect(chart, &QChart::plotAreaChanged, this, &ChartViewPrivate::scheduleTicks);
 }
 
 ChartViewPrivate::~ChartViewPrivate()
@@ -115,14 +127,25 @@ bool ChartViewPrivate::isVerticalLineEnabled() const
 
 void ChartViewPrivate::setHorizontalLinesPrec(int prec)
 {
-    m_horizontal_lines_prec = prec;
-    updateLines();
+    m_marker_lines->setPrecision(Qt::Horizontal, prec);
 }
 
 void ChartViewPrivate::setVerticalLinesPrec(int prec)
 {
-    m_vertical_lines_prec = prec;
-    updateLines();
+    m_marker_lines->setPrecision(Qt::Vertical, prec);
+}
+
+void ChartViewPrivate::setAxisTransform(Qt::Orientation orientation, const AxisTransform& transform)
+{
+    if (orientation == Qt::Horizontal) {
+        m_x_transform = transform;
+        m_marker_lines->setTransform(Qt::Vertical, transform);
+    } else {
+        m_y_transform = transform;
+        m_marker_lines->setTransform(Qt::Horizontal, transform);
+    }
+    // Recorded ranges are in the units of the old transform
+    clearZoomHistory();
 }
 
 void ChartViewPrivate::setVerticalLinePrec(int prec)
@@ -134,6 +157,332 @@ void ChartViewPrivate::setVerticalLinePrec(int prec)
     }
 }
 
+void ChartViewPrivate::setRenderBackend(RenderBackend backend)
+{
+    if (m_render_backend == backend)
+        return;
+    m_render_backend = backend;
+
+    if (backend == RenderBackend::Threaded) {
+        m_pipeline = std::make_unique<RenderPipeline>();
+        connect(m_pipeline.get(), &RenderPipeline::frameReady, this, &ChartViewPrivate::frameRendered);
+        m_frame_item = std::make_unique<RenderFrameItem>(m_chart);
+        m_frame_item->setZValue(5);
+        for (QAbstractSeries* series : m_chart->series())
+            trackSeries(series);
+        scheduleFrame();
+    } else {
+        m_frame_item.reset();
+        m_pipeline.reset();
+        m_series_revision.clear();
+        // Hand drawing back to Qt Charts the way it was set up before
+        for (QAbstractSeries* series : m_chart->series()) {
+            auto state = m_native_state.constFind(series);
+            if (state == m_native_state.cend())
+                continue;
+            series->setOpacity(state->opacity);
+            series->setUseOpenGL(state->openGL);
+        }
+        m_native_state.clear();
+    }
+}
+
+void ChartViewPrivate::trackSeries(QAbstractSeries* series)
+{
+    if (m_render_backend != RenderBackend::Threaded)
+        return;
+
+    QXYSeries* serie = qobject_cast<QXYSeries*>(series);
+    if (!serie || !SeriesSnapshot::fromSeries(series))
+        return;
+
+    // Qt Charts keeps the series for axes, legend and hit tests but does not paint it anymore
+    if (!m_native_state.contains(series))
+        m_native_state.insert(series, NativeState{ serie->useOpenGL(), serie->opacity() });
+    serie->setUseOpenGL(false);
+    serie->setOpacity(0);
+
+    m_series_revision[series] = ++m_revision;
+
+    // Changes of data or style invalidate the cached layer, visibility only changes the composition
+    connect(serie, &QXYSeries::pointsReplaced, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::pointAdded, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::pointRemoved, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::pointsRemoved, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::pointReplaced, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::colorChanged, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QXYSeries::penChanged, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    connect(serie, &QAbstractSeries::visibleChanged, this, &ChartViewPrivate::scheduleFrame, Qt::UniqueConnection);
+    connect(serie, &QObject::destroyed, this, &ChartViewPrivate::seriesDestroyed, Qt::UniqueConnection);
+    if (QScatterSeries* scatter = qobject_cast<QScatterSeries*>(series))
+        connect(scatter, &QScatterSeries::markerSizeChanged, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+    if (ScatterSeries* scatter = qobject_cast<ScatterSeries*>(series))
+        connect(scatter, &ScatterSeries::densityChanged, this, &ChartViewPrivate::seriesChanged, Qt::UniqueConnection);
+
+    for (QAbstractAxis* axis : serie->attachedAxes()) {
+        if (QValueAxis* valueaxis = qobject_cast<QValueAxis*>(axis))
+            connect(valueaxis, &QValueAxis::rangeChanged, this, &ChartViewPrivate::scheduleFrame, Qt::UniqueConnection);
+    }
+    scheduleFrame();
+}
+
+void ChartViewPrivate::untrackSeries(QAbstractSeries* series)
+{
+    if (!series || !m_series_revision.contains(series))
+        return;
+
+    m_series_revision.remove(series);
+    auto state = m_native_state.constFind(series);
+    if (state != m_native_state.cend()) {
+        series->setOpacity(state->opacity);
+        series->setUseOpenGL(state->openGL);
+        m_native_state.erase(state);
+    }
+    disconnect(series, nullptr, this, nullptr);
+    scheduleFrame();
+}
+
+void ChartViewPrivate::seriesDestroyed(QObject* object)
+{
+    // Only the address is used, the series is already gone
+    const QAbstractSeries* series = static_cast<const QAbstractSeries*>(object);
+    m_series_revision.remove(series);
+    m_native_state.remove(series);
+}
+
+void ChartViewPrivate::seriesChanged()
+{
+    const QAbstractSeries* series = qobject_cast<const QAbstractSeries*>(sender());
+    if (series && m_series_revision.contains(series))
+        m_series_revision[series] = ++m_revision;
+    scheduleFrame();
+}
+
+void ChartViewPrivate::scheduleTicks()
+{
+    if (m_ticks_scheduled)
+        return;
+    m_ticks_scheduled = true;
+    QMetaObject::invokeMethod(this, &ChartViewPrivate::updateTicks, Qt::QueuedConnection);
+}
+
+void ChartViewPrivate::updateTicks()
+{
+    m_ticks_scheduled = false;
+    const QRectF area = chart()->plotArea();
+    ZoomFrame* frame = currentZoomFrame();
+    for (Qt::Orientation orientation : { Qt::Horizontal, Qt::Vertical }) {
+        const QList<QAbstractAxis*> axes = chart()->axes(orientation);
+        if (axes.isEmpty())
+            continue;
+        // Category axes of transformed scales carry their own labels
+        QValueAxis* axis = qobject_cast<QValueAxis*>(axes.first());
+        if (!axis || qobject_cast<QCategoryAxis*>(axis))
+            continue;
+
+        // A viewport of the zoom history brings its ticks along
+        const QString font = axis->labelsFont().key();
+        ZoomFrame::Ticks* cached = frame ? (orientation == Qt::Horizontal ? &frame->xTicks : &frame->yTicks) : nullptr;
+        TickLayout layout;
+        if (cached && cached->valid && cached->font == font) {
+            layout = cached->layout;
+        } else {
+            const qreal pixels = orientation == Qt::Horizontal ? area.width() : area.height();
+            layout = m_ticks.layout(axis->min(), axis->max(), pixels, axis->labelsFont(), orientation);
+            if (cached)
+                *cached = ZoomFrame::Ticks{ layout, font, true };
+        }
+
+        // The default format follows the ticks, a format set in the configuration is kept
+        QString& automatic = orientation == Qt::Horizontal ? m_x_tick_format : m_y_tick_format;
+        const bool format = axis->labelFormat() == QLatin1String("%2.2f") || axis->labelFormat() == automatic;
+        if (TickEngine::apply(axis, layout, format)) {
+            if (format)
+                automatic = layout.format;
+        } else if (format && axis->labelFormat() == automatic) {
+            // Back to fixed ticks, the decimals of the engine do not fit them
+            axis->setLabelFormat(QStringLiteral("%2.2f"));
+        }
+    }
+}
+
+void ChartViewPrivate::scheduleFrame()
+{
+    if (m_render_backend != RenderBackend::Threaded)
+        return;
+
+    updateFrameGeometry();
+    if (m_frame_scheduled)
+        return;
+    m_frame_scheduled = true;
+    QMetaObject::invokeMethod(this, &ChartViewPrivate::requestFrame, Qt::QueuedConnection);
+}
+
+void ChartViewPrivate::requestFrame()
+{
+    m_frame_scheduled = false;
+    if (!m_pipeline || m_chart->axes(Qt::Horizontal).isEmpty() || m_chart->axes(Qt::Vertical).isEmpty())
+        return;
+
+    QValueAxis* xaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Horizontal).first());
+    QValueAxis* yaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Vertical).first());
+    if (!xaxis || !yaxis)
+        return;
+
+    RenderRequest request;
+    request.transform.plotArea = m_chart->plotArea();
+    request.transform.xMin = xaxis->min();
+    request.transform.xMax = xaxis->max();
+    request.transform.yMin = yaxis->min();
+    request.transform.yMax = yaxis->max();
+    request.transform.devicePixelRatio = devicePixelRatioF();
+    request.antialiasing = renderHints().testFlag(QPainter::Antialiasing);
+
+    // The key tells which series, in which state, a frame shows
+    size_t key = qHash(request.antialiasing);
+    for (QAbstractSeries* series : m_chart->series()) {
+        if (!series->isVisible())
+            continue;
+        if (auto snapshot = SeriesSnapshot::fromSeries(series)) {
+            snapshot->revision = m_series_revision.value(series);
+            key = qHashMulti(key, snapshot->key, snapshot->revision);
+            request.series << *snapshot;
+        }
+    }
+
+    // Back in a viewport of the zoom history, its frame is still good
+    const ZoomFrame* frame = currentZoomFrame();
+    if (frame && !frame->image.isNull() && frame->imageKey == key && frame->imageTransform == request.transform) {
+        m_frame_restored = true;
+        m_frame_item->setFrame(frame->image, frame->imageTransform);
+        updateFrameGeometry();
+        return;
+    }
+
+    m_frame_restored = false;
+    m_requested_transform = request.transform;
+    m_requested_key = key;
+    m_pipeline->render(std::move(request));
+}
+
+void ChartViewPrivate::frameRendered(const QImage& frame, const RenderTransform& transform)
+{
+    // Frames still in flight when a frame came from the history are outdated
+    if (!m_frame_item || m_frame_restored)
+        return;
+    m_frame_item->setFrame(frame, transform);
+    updateFrameGeometry();
+
+    if (transform != m_requested_transform)
+        return;
+    ZoomFrame* current = currentZoomFrame();
+    if (current && current->matches(transform.xMin, transform.xMax, transform.yMin, transform.yMax) && current->plotArea == transform.plotArea)
+        m_zoom_history.storeImage(current, frame, transform, m_requested_key);
+}
+
+void ChartViewPrivate::scheduleZoomRecord()
+{
+    if (m_zoom_record_scheduled)
+        return;
+    m_zoom_record_scheduled = true;
+    QMetaObject::invokeMethod(this, &ChartViewPrivate::recordZoom, Qt::QueuedConnection);
+}
+
+void ChartViewPrivate::recordZoom()
+{
+    m_zoom_record_scheduled = false;
+    if (m_chart->axes(Qt::Horizontal).isEmpty() || m_chart->axes(Qt::Vertical).isEmpty())
+        return;
+
+    QValueAxis* xaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Horizontal).first());
+    QValueAxis* yaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Vertical).first());
+    if (!xaxis || !yaxis)
+        return;
+
+    if (m_zoom_history.record(xaxis->min(), xaxis->max(), yaxis->min(), yaxis->max()))
+        emit zoomHistoryChanged();
+}
+
+ZoomFrame* ChartViewPrivate::currentZoomFrame()
+{
+    if (m_chart->axes(Qt::Horizontal).isEmpty() || m_chart->axes(Qt::Vertical).isEmpty())
+        return nullptr;
+
+    QValueAxis* xaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Horizontal).first());
+    QValueAxis* yaxis = qobject_cast<QValueAxis*>(m_chart->axes(Qt::Vertical).first());
+    if (!xaxis || !yaxis)
+        return nullptr;
+
+    ZoomFrame* frame = m_zoom_history.current(xaxis->min(), xaxis->max(), yaxis->min(), yaxis->max());
+    if (frame)
+        frame->setPlotArea(m_chart->plotArea());
+    return frame;
+}
+
+void ChartViewPrivate::setCalloutLayout(CalloutLayout* callouts)
+{
+    if (m_callouts)
+        disconnect(m_callouts, nullptr, this, nullptr);
+    m_callouts = callouts;
+    if (m_callouts)
+        connect(m_callouts, &CalloutLayout::laidOut, this, &ChartViewPrivate::storeLabels);
+}
+
+void ChartViewPrivate::storeLabels()
+{
+    if (ZoomFrame* frame = currentZoomFrame())
+        frame->labels = m_callouts->placement();
+}
+
+void ChartViewPrivate::clearZoomHistory()
+{
+    m_zoom_history.clear();
+    emit zoomHistoryChanged();
+}
+
+void ChartViewPrivate::zoomBack()
+{
+    if (const ZoomFrame* frame = m_zoom_history.back())
+        restoreZoom(*frame);
+}
+
+void ChartViewPrivate::zoomForward()
+{
+    if (const ZoomFrame* frame = m_zoom_history.forward())
+        restoreZoom(*frame);
+}
+
+void ChartViewPrivate::restoreZoom(const ZoomFrame& frame)
+{
+    if (m_chart->axes(Qt::Horizontal).isEmpty() || m_chart->axes(Qt::Vertical).isEmpty())
+        return;
+
+    // Receivers of zoomChanged() may change the history, keep what is needed
+    const CalloutLayout::Placement labels = frame.labels;
+    setZoom(frame.xMin, frame.xMax, frame.yMin, frame.yMax);
+
+    // Ticks go first, their labels decide the plot area everything else depends on;
+    // the frame of the render backend follows from the range change
+    updateTicks();
+    if (m_callouts && labels.isValid())
+        m_callouts->restorePlacement(labels);
+    emit zoomHistoryChanged();
+}
+
+void ChartViewPrivate::updateFrameGeometry()
+{
+    if (!m_frame_item || m_chart->series().isEmpty())
+        return;
+
+    const RenderTransform& transform = m_frame_item->frameTransform();
+    if (!transform.isValid())
+        return;
+
+    QPointF topleft = m_chart->mapToPosition(QPointF(transform.xMin, transform.yMax));
+    QPointF bottomright = m_chart->mapToPosition(QPointF(transform.xMax, transform.yMin));
+    m_frame_item->setTargetRect(QRectF(topleft, bottomright), m_chart->plotArea());
+}
+
 void ChartViewPrivate::updateView(double min, double max)
 {
     m_y_min = min;
@@ -176,13 +525,11 @@ void ChartViewPrivate::setZoom(qreal x_min, qreal x_max, qreal y_min, qreal y_ma
 
     yaxis->setMin(y_min);
     yaxis->setMax(y_max);
-    yaxis->setTickInterval(ChartTools::CustomCeil(y_max + y_min) / 10.0);
     m_y_min = y_min;
     m_y_max = y_max;
 
     xaxis->setMin(x_min);
     xaxis->setMax(x_max);
-    xaxis->setTickInterval(ChartTools::CustomCeil(x_max + x_min) / 10.0);
 
     m_x_min = x_min;
     m_x_max = x_max;
@@ -298,8 +645,8 @@ void ChartViewPrivate::setSelectBox(const QPointF& topleft, const QPointF& botto
 {
     updateCorner();
 
-    m_border_start = chart()->mapToPosition(topleft);
-    m_border_end = chart()->mapToPosition(bottomright);
+    m_border_start = chart()->mapToPosition(m_x_transform.map(topleft, m_y_transform));
+    m_border_end = chart()->mapToPosition(m_x_transform.map(bottomright, m_y_transform));
 
     m_saved_zoom_strategy = m_zoom_strategy;
     m_saved_select_strategy = m_select_strategy;
@@ -312,8 +659,8 @@ void ChartViewPrivate::setSelectBox(const QPointF& topleft, const QPointF& botto
     m_box_bounded = true;
 
     QRectF rect;
-    rect = QRectF(chart()->mapToPosition(topleft), chart()->mapToPosition(bottomright));
-    m_rect_start = chart()->mapToPosition(topleft);
+    rect = QRectF(m_border_start, m_border_end);
+    m_rect_start = m_border_start;
     m_select_box->setRect(rect);
     m_select_box->setVisible(true);
     setFocus();
@@ -321,106 +668,47 @@ void ChartViewPrivate::setSelectBox(const QPointF& topleft, const QPointF& botto
 
 void ChartViewPrivate::addHorizontalLine(double position_y)
 {
-    auto line = std::make_unique<QGraphicsLineItem>(m_chart);
-    QPen pen;
-    pen.setWidth(2);
-    pen.setColor(Qt::darkGray);
-    line->setPen(pen);
-    line->setVisible(true);
-
-    auto text = std::make_unique<QGraphicsTextItem>(m_chart);
-
-    m_horizontal_lines.emplace(position_y, std::move(line));
-    m_horizontal_lines_position.emplace(position_y, std::move(text));
-    updateLines();
+    m_marker_lines->add(Qt::Horizontal, position_y);
 }
 
 void ChartViewPrivate::addVerticalLine(double position_x)
 {
-    auto line = std::make_unique<QGraphicsLineItem>(m_chart);
-    QPen pen;
-    pen.setWidth(2);
-    pen.setColor(Qt::darkGray);
-    line->setPen(pen);
-    line->setVisible(true);
-
-    auto text = std::make_unique<QGraphicsTextItem>(m_chart);
-
-    m_vertical_lines.emplace(position_x, std::move(line));
-    m_vertical_lines_position.emplace(position_x, std::move(text));
-    updateLines();
+    m_marker_lines->add(Qt::Vertical, position_x);
 }
 
 bool ChartViewPrivate::removeVerticalLine(double position_x)
 {
-    if (m_vertical_lines.find(position_x) != m_vertical_lines.end()) {
-        m_vertical_lines.erase(position_x);
-        m_vertical_lines_position.erase(position_x);
-        return true;
-    }
-    return false;
+    return m_marker_lines->remove(Qt::Vertical, position_x);
 }
 
 bool ChartViewPrivate::removeHorizontalLine(double position_y)
 {
-    if (m_horizontal_lines.find(position_y) != m_horizontal_lines.end()) {
-        m_horizontal_lines.erase(position_y);
-        m_horizontal_lines_position.erase(position_y);
-        return true;
-    }
-    return false;
+    return m_marker_lines->remove(Qt::Horizontal, position_y);
 }
 
 void ChartViewPrivate::removeAllHorizontalLines()
 {
-    m_horizontal_lines.clear();
-    m_horizontal_lines_position.clear();
+    m_marker_lines->clear(Qt::Horizontal);
 }
 
-void ChartViewPrivate::removeAllVerticalLines()
+QVector<double> ChartViewPrivate::verticalLines() const
 {
-    m_vertical_lines.clear();
-    m_vertical_lines_position.clear();
+    return m_marker_lines->positions(Qt::Vertical);
 }
 
-void ChartViewPrivate::updateLines()
+QVector<double> ChartViewPrivate::horizontalLines() const
 {
-    // Update vertical marker lines
-    for (const auto& pair : m_vertical_lines) {
-        double x = pair.first;
-        auto& line = pair.second;
-
-        QPointF start = chart()->mapToPosition(QPointF(x, m_y_min));
-        QPointF end = chart()->mapToPosition(QPointF(x, 0.95 * m_y_max));
-
-        line->setLine(start.x(), start.y(), end.x(), end.y());
-
-        auto& textItem = m_vertical_lines_position[x];
-        textItem->setPlainText(QString::number(x, 'f', m_horizontal_lines_prec));
-        QPointF position = chart()->mapToPosition(QPointF(x, 0.99 * m_y_max));
-
-        textItem->setPos(QPointF(position.x() + 20 * textItem->document()->size().width(), position.y()));
-        textItem->setVisible(m_vertical_lines_prec != -1);
-    }
-
-    // Update horizontal marker lines
-    for (const auto& pair : m_horizontal_lines) {
-        double y = pair.first;
-        auto& line = pair.second;
-
-        QPointF start = chart()->mapToPosition(QPointF(m_x_min, y));
-        QPointF end = chart()->mapToPosition(QPointF(0.95 * m_x_max, y));
-
-        line->setLine(start.x(), start.y(), end.x(), end.y());
+    return m_marker_lines->positions(Qt::Horizontal);
+}
 
-        auto& textItem = m_horizontal_lines_position[y];
-        textItem->setPlainText(QString::number(y, 'f', m_vertical_lines_prec));
-        QPointF position = chart()->mapToPosition(QPointF(m_x_min, y));
+void ChartViewPrivate::removeAllVerticalLines()
+{
+    m_marker_lines->clear(Qt::Vertical);
+}
 
-        textItem->setPos(position.x() - 20 * textItem->document()->size().width(),
-            position.y() - 10);
-        textItem->setVisible(m_horizontal_lines_prec != -1);
-    }
+void ChartViewPrivate::updateLines()
+{
+    m_marker_lines->updateGeometry(m_x_min, m_x_max, m_y_min, m_y_max);
 }
 
 void ChartViewPrivate::mouseMoveEvent(QMouseEvent* event)
@@ -459,7 +747,7 @@ void ChartViewPrivate::updateVerticalLine(double x)
     QPointF end = chart()->mapToPosition(QPointF(x, 0.95 * m_y_max));
 
     m_vertical_line->setLine(start.x(), start.y(), end.x(), end.y());
-    m_line_position->setPlainText(QString::number(x, 'f', m_vertical_line_prec));
+    m_line_position->setPlainText(QString::number(m_x_transform.unmap(x), 'f', m_vertical_line_prec));
     QPointF position = chart()->mapToPosition(QPointF(x, 0.99 * m_y_max));
     m_line_position->setPos(position.x() - m_line_position->document()->size().width() / 2, position.y() - 20);
 }
@@ -477,9 +765,9 @@ void ChartViewPrivate::mouseReleaseEvent(QMouseEvent* event)
             QPair<QPointF, QPointF> rect = getCurrentRectangle();
 
             if ((m_border_start.x() <= rect.first.x() && m_border_end.x() >= rect.second.x()) || !m_box_bounded) {
-                emit addRect(chart()->mapToValue(rect.first), chart()->mapToValue(rect.second));
+                emit addRect(m_x_transform.unmap(chart()->mapToValue(rect.first), m_y_transform), m_x_transform.unmap(chart()->mapToValue(rect.second), m_y_transform));
             } else {
-                emit addRect(chart()->mapToValue(m_border_start), chart()->mapToValue(m_border_end));
+                emit addRect(m_x_transform.unmap(chart()->mapToValue(m_border_start), m_y_transform), m_x_transform.unmap(chart()->mapToValue(m_border_end), m_y_transform));
             }
 
             m_vertical_line->setVisible(m_vertical_line_visible);
@@ -527,7 +815,7 @@ void ChartViewPrivate::mouseDoubleClickEvent(QMouseEvent* event)
         event->ignore();
     } else if (event->button() == Qt::LeftButton) {
         QPointF chartPoint = chart()->mapToValue(QPointF(event->x(), event->y()));
-        emit pointDoubleClicked(chartPoint);
+        emit pointDoubleClicked(m_x_transform.unmap(chartPoint, m_y_transform));
     } else {
         event->ignore();
     }
@@ -555,6 +843,16 @@ void ChartViewPrivate::updateZoom()
 
 void ChartViewPrivate::keyPressEvent(QKeyEvent* event)
 {
+    // Alt+Left and Alt+Right on most platforms, plain arrows stay with leftKey() and rightKey()
+    if (event->matches(QKeySequence::Back)) {
+        zoomBack();
+        return;
+    }
+    if (event->matches(QKeySequence::Forward)) {
+        zoomForward();
+        return;
+    }
+
     switch (event->key()) {
     case Qt::Key_Escape:
         m_double_right_clicked = false;
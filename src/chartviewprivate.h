@@ -31,14 +31,22 @@
 #include <QtWidgets/QScrollArea>
 
 #include <memory>
-#include <unordered_map>
+
+#include "axistransform.h"
+#include "tickengine.h"
+#include "zoomhistory.h"
 
 class QGridLayout;
 class QPushButton;
 
+class CalloutLayout;
+class MarkerLines;
 class PeakCallOut;
+class RenderFrameItem;
+class RenderPipeline;
 
 struct ChartConfig;
+struct RenderTransform;
 
 enum class ZoomStrategy {
     None = 0,
@@ -59,6 +67,11 @@ enum class AutoScaleStrategy {
     SpaceScale = 1
 };
 
+enum class RenderBackend {
+    Native = 0,
+    Threaded = 1
+};
+
 class ChartViewPrivate : public QChartView {
     Q_OBJECT
 
@@ -147,6 +160,18 @@ public:
      */
     void removeAllHorizontalLines();
 
+    /**
+     * @brief Positions of the vertical marker lines
+     * @return Sorted x positions
+     */
+    QVector<double> verticalLines() const;
+
+    /**
+     * @brief Positions of the horizontal marker lines
+     * @return Sorted y positions
+     */
+    QVector<double> horizontalLines() const;
+
     /**
      * @brief Set decimal precision for horizontal line labels
      * @param prec Number of decimal places to show
@@ -165,6 +190,77 @@ public:
      */
     void setVerticalLinePrec(int prec);
 
+    /**
+     * @brief Select how line and scatter series are drawn
+     *
+     * With RenderBackend::Threaded the series are rasterized by a RenderPipeline
+     * on worker threads and only the finished frame is blitted on the GUI thread.
+     * @param backend The backend to use
+     */
+    void setRenderBackend(RenderBackend backend);
+
+    /**
+     * @brief Get the current render backend
+     * @return Current render backend
+     */
+    RenderBackend renderBackend() const { return m_render_backend; }
+
+    /**
+     * @brief Set the transform of an axis
+     *
+     * Axis ranges stay in transformed units. Marker line positions, the
+     * tracking line label, setSelectBox() and the addRect() and
+     * pointDoubleClicked() signals use data values.
+     * @param orientation Qt::Horizontal for the x axis
+     * @param transform The transform
+     */
+    void setAxisTransform(Qt::Orientation orientation, const AxisTransform& transform);
+
+    /**
+     * @brief Update the ticks of the value axes once control returns to the event loop
+     *
+     * Interval, anchor, minor ticks and the default label format come from a
+     * TickEngine fitted to the plot area and the tick label font.
+     */
+    void scheduleTicks();
+
+    /**
+     * @brief Record the current viewport in the zoom history once control returns to the event loop
+     *
+     * Every change of the axis ranges ends up here, so zooming by rectangle,
+     * the middle-click reset and the range changes that follow scaleUp() and
+     * scaleDown() are all covered; a burst of changes makes a single entry.
+     */
+    void scheduleZoomRecord();
+
+    /**
+     * @brief Callouts whose placement is kept with the viewports of the zoom history
+     */
+    void setCalloutLayout(CalloutLayout* callouts);
+
+    inline bool canZoomBack() const { return m_zoom_history.canGoBack(); }
+    inline bool canZoomForward() const { return m_zoom_history.canGoForward(); }
+
+    void clearZoomHistory();
+
+    /**
+     * @brief History frame of the current axis ranges, for the current plot area
+     * @return The frame, or nullptr if the ranges are not recorded (yet)
+     */
+    ZoomFrame* currentZoomFrame();
+
+    /**
+     * @brief Let the render backend follow changes of a series
+     * @param series Series that has been added to the chart
+     */
+    void trackSeries(QAbstractSeries* series);
+
+    /**
+     * @brief Stop following a series that leaves the chart and hand it back to Qt Charts
+     * @param series Series that is about to be removed from the chart
+     */
+    void untrackSeries(QAbstractSeries* series);
+
 public slots:
     /**
      * @brief Update the position of the tracking vertical line
@@ -206,6 +302,35 @@ public slots:
      */
     void setSelectBox(const QPointF& topleft, const QPointF& bottomright);
 
+    /**
+     * @brief Request a new frame from the render backend, coalesced until the event loop runs
+     */
+    void scheduleFrame();
+
+    /**
+     * @brief Return to the previous viewport of the zoom history
+     *
+     * Ticks, the rendered frame and the callout placement come from the
+     * history where they are still valid, nothing is scanned or rendered again.
+     */
+    void zoomBack();
+
+    /**
+     * @brief Return to the next viewport of the zoom history
+     */
+    void zoomForward();
+
+private slots:
+    /**
+     * @brief Invalidate the cached layer of the sending series and request a frame
+     */
+    void seriesChanged();
+
+    /**
+     * @brief Forget the revision and native state of a destroyed series
+     */
+    void seriesDestroyed(QObject* object);
+
 protected:
     void mousePressEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
@@ -256,28 +381,91 @@ private:
      */
     void updateLines();
 
+    /**
+     * @brief Snapshot the visible series and hand them to the render pipeline
+     */
+    void requestFrame();
+
+    /**
+     * @brief Apply the tick layout of the current ranges to the value axes
+     */
+    void updateTicks();
+
+    /**
+     * @brief Add the current axis ranges to the zoom history
+     */
+    void recordZoom();
+
+    /**
+     * @brief Set the ranges of a history frame and put back its derived state
+     */
+    void restoreZoom(const ZoomFrame& frame);
+
+    /**
+     * @brief Keep the placement of the last callout pass with the current viewport
+     */
+    void storeLabels();
+
+    /**
+     * @brief Show a finished frame from the render pipeline
+     * @param frame Rendered frame
+     * @param transform Transform the frame was rendered with
+     */
+    void frameRendered(const QImage& frame, const RenderTransform& transform);
+
+    /**
+     * @brief Move the current frame to where its value range lies now
+     */
+    void updateFrameGeometry();
+
     // Graphics items for tracking and visualization
     std::unique_ptr<QGraphicsLineItem> m_vertical_line;
     std::unique_ptr<QGraphicsTextItem> m_line_position;
     std::unique_ptr<QGraphicsRectItem> m_zoom_box;
     std::unique_ptr<QGraphicsRectItem> m_select_box;
 
-    // Collections of marker lines and their labels
-    std::unordered_map<double, std::unique_ptr<QGraphicsLineItem>> m_vertical_lines;
-    std::unordered_map<double, std::unique_ptr<QGraphicsLineItem>> m_horizontal_lines;
-    std::unordered_map<double, std::unique_ptr<QGraphicsTextItem>> m_vertical_lines_position;
-    std::unordered_map<double, std::unique_ptr<QGraphicsTextItem>> m_horizontal_lines_position;
+    // Marker lines and their labels, one item for all of them
+    std::unique_ptr<MarkerLines> m_marker_lines;
+
+    // Threaded rendering of series
+    std::unique_ptr<RenderPipeline> m_pipeline;
+    std::unique_ptr<RenderFrameItem> m_frame_item;
+    RenderBackend m_render_backend{ RenderBackend::Native };
+    bool m_frame_scheduled = false;
+    bool m_frame_restored = false;
+    RenderTransform m_requested_transform;
+    quint64 m_requested_key = 0;
+    QHash<const QAbstractSeries*, quint64> m_series_revision;
+    quint64 m_revision = 0;
+
+    // How Qt Charts drew a series before the threaded backend took it over
+    struct NativeState {
+        bool openGL = false;
+        qreal opacity = 1;
+    };
+    QHash<const QAbstractSeries*, NativeState> m_native_state;
 
     // Rectangle selection boundaries
     QPointF m_border_start, m_border_end;
     QPointF m_rect_start, m_upperleft, m_lowerright;
 
+    // Axis transforms, identity for plain value axes
+    AxisTransform m_x_transform, m_y_transform;
+
+    // Tick layouts and the label formats last set from them
+    TickEngine m_ticks;
+    QString m_x_tick_format, m_y_tick_format;
+    bool m_ticks_scheduled = false;
+
+    // Viewports visited, with their ticks, frames and callout placements
+    ZoomHistory m_zoom_history;
+    QPointer<CalloutLayout> m_callouts;
+    bool m_zoom_record_scheduled = false;
+
     // Current axis limits
     double m_x_min, m_x_max, m_y_min, m_y_max;
 
     // Precision for number display
-    int m_horizontal_lines_prec = 2;
-    int m_vertical_lines_prec = 2;
     int m_vertical_line_prec = 4;
 
     // State flags
@@ -303,6 +491,7 @@ signals:
     void lockZoom();
     void unlockZoom();
     void zoomChanged();
+    void zoomHistoryChanged();
     void scaleUp();
     void scaleDown();
     void addRect(const QPointF& point1, const QPointF& point2);
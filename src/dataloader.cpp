@@ -0,0 +1,576 @@
+/*
+ * CuteCharts - Parallel loader for delimited text and binary data files
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QXYSeries>
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLocale>
+#include <QtCore/QThread>
+#include <QtCore/QtEndian>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+
+#include "dataloader.h"
+
+namespace {
+const qreal NaN = std::numeric_limits<qreal>::quiet_NaN();
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/* Parses one number at p and advances p behind it. The mapped file is not
+ * null terminated, so everything here has to respect end. */
+inline bool parseNumber(const char*& p, const char* end, qreal& value)
+{
+    if (p < end && *p == '+')
+        ++p;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ptr == p)
+        return false;
+    if (result.ec == std::errc::result_out_of_range)
+        value = NaN;
+    p = result.ptr;
+    return true;
+#else
+    const char* q = p;
+    while (q < end && q - p < 64 && !isBlank(*q) && *q != '\n' && *q != ',' && *q != ';' && *q != '"')
+        ++q;
+    bool ok = false;
+    value = QLocale::c().toDouble(QLatin1String(p, int(q - p)), &ok);
+    if (!ok)
+        return false;
+    p = q;
+    return true;
+#endif
+}
+
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+    return newline ? newline : end;
+}
+
+inline const char* nextLine(const char* p, const char* end)
+{
+    const char* newline = lineEnd(p, end);
+    return newline < end ? newline + 1 : end;
+}
+
+inline bool isSkipped(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p))
+        ++p;
+    return p == end || *p == '#';
+}
+
+/* Splits a line into its raw fields, only used for the header and the first data line */
+QList<QByteArray> splitFields(const char* p, const char* end, char delimiter)
+{
+    QByteArray line(p, int(end - p));
+    QList<QByteArray> fields;
+    if (delimiter)
+        fields = line.split(delimiter);
+    else
+        fields = line.simplified().split(' ');
+    for (QByteArray& field : fields) {
+        field = field.trimmed();
+        if (field.size() >= 2 && field.startsWith('"') && field.endsWith('"'))
+            field = field.mid(1, field.size() - 2);
+    }
+    return fields;
+}
+
+char detectDelimiter(const char* p, const char* end)
+{
+    int best = 0;
+    char delimiter = 0;
+    for (char candidate : { ',', '\t', ';' }) {
+        const int count = int(std::count(p, end, candidate));
+        if (count > best) {
+            best = count;
+            delimiter = candidate;
+        }
+    }
+    return delimiter;
+}
+
+void parseLine(const char* p, const char* end, char delimiter, std::vector<std::vector<qreal>>& columns)
+{
+    const int count = int(columns.size());
+    int column = 0;
+    while (p < end && isBlank(*p) && *p != delimiter)
+        ++p;
+    while (column < count) {
+        if (p < end && *p == '"')
+            ++p;
+        qreal value = NaN;
+        const char* q = p;
+        if (parseNumber(q, end, value))
+            p = q;
+        columns[size_t(column++)].push_back(value);
+
+        if (delimiter) {
+            p = static_cast<const char*>(std::memchr(p, delimiter, size_t(end - p)));
+            if (!p)
+                break;
+            ++p;
+            while (p < end && isBlank(*p) && *p != delimiter)
+                ++p;
+        } else {
+            while (p < end && !isBlank(*p))
+                ++p;
+            while (p < end && isBlank(*p))
+                ++p;
+            if (p == end)
+                break;
+        }
+    }
+    for (; column < count; ++column)
+        columns[size_t(column)].push_back(NaN);
+}
+
+class Progress {
+public:
+    Progress(qint64 total, const std::function<void(int)>& report)
+        : m_total(qMax<qint64>(1, total))
+        , m_report(report)
+    {
+    }
+
+    void add(qint64 done)
+    {
+        if (!m_report)
+            return;
+        const int percent = int((m_done += done) * 100 / m_total);
+        int last = m_last.load();
+        // Only the thread that raises the percentage reports it
+        while (percent > last) {
+            if (m_last.compare_exchange_weak(last, percent)) {
+                m_report(percent);
+                break;
+            }
+        }
+    }
+
+private:
+    const qint64 m_total;
+    const std::function<void(int)>& m_report;
+    std::atomic<qint64> m_done{ 0 };
+    std::atomic<int> m_last{ -1 };
+};
+
+bool parseDelimited(const char* data, qint64 size, const DataLoader::Options& options, DataTable& table, QString& error,
+    const std::atomic<bool>* cancel, Progress& progress)
+{
+    const char* end = data + size;
+    const char* p = data;
+
+    // Skip a UTF-8 byte order mark
+    if (size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    const char* header = nullptr;
+    const char* headerEnd = nullptr;
+    for (int skipped = 0; options.header > 0 && skipped < options.header && p < end; ++skipped) {
+        header = p;
+        headerEnd = lineEnd(p, end);
+        p = nextLine(p, end);
+    }
+    while (p < end && isSkipped(p, lineEnd(p, end)))
+        p = nextLine(p, end);
+    if (p >= end) {
+        error = DataLoader::tr("The file contains no data.");
+        return false;
+    }
+
+    const char* firstEnd = lineEnd(p, end);
+    const char delimiter = options.delimiter ? options.delimiter : detectDelimiter(p, firstEnd);
+    QList<QByteArray> fields = splitFields(p, firstEnd, delimiter);
+
+    if (options.header < 0) {
+        qreal value;
+        const char* first = fields.isEmpty() ? nullptr : fields.first().constData();
+        const char* firstFieldEnd = first ? first + fields.first().size() : nullptr;
+        if (first && !parseNumber(first, firstFieldEnd, value)) {
+            header = p;
+            headerEnd = firstEnd;
+            p = nextLine(p, end);
+            while (p < end && isSkipped(p, lineEnd(p, end)))
+                p = nextLine(p, end);
+            fields = splitFields(p, lineEnd(p, end), delimiter);
+        }
+    }
+
+    const int columnCount = qMax(1, int(fields.size()));
+    if (header) {
+        for (const QByteArray& name : splitFields(header, headerEnd, delimiter))
+            table.names << QString::fromUtf8(name);
+    }
+    for (int i = table.names.size(); i < columnCount; ++i)
+        table.names << DataLoader::tr("Column %1").arg(i + 1);
+    while (table.names.size() > columnCount)
+        table.names.removeLast();
+
+    const char* const begin = p;
+    const qint64 length = end - begin;
+    std::vector<std::vector<std::vector<qreal>>> partial(size_t(ChartTools::WorkerCount()));
+
+    // A line belongs to the chunk its first byte lies in
+    ChartTools::ParallelFor(length, [&](qsizetype chunkBegin, qsizetype chunkEnd, int worker) {
+        std::vector<std::vector<qreal>>& columns = partial[size_t(worker)];
+        columns.resize(size_t(columnCount));
+
+        const char* line = chunkBegin > 0 ? nextLine(begin + chunkBegin - 1, end) : begin;
+        const char* const last = begin + chunkEnd;
+        const char* reported = line;
+        int lines = 0;
+        while (line < last) {
+            const char* const next = lineEnd(line, end);
+            if (!isSkipped(line, next))
+                parseLine(line, next, delimiter, columns);
+            line = nextLine(line, end);
+
+            if (++lines == 16384) {
+                lines = 0;
+                if (cancel && *cancel)
+                    return;
+                progress.add(line - reported);
+                reported = line;
+            }
+        }
+        progress.add(line - reported);
+    },
+        1 << 20);
+
+    if (cancel && *cancel) {
+        error = DataLoader::tr("Loading was cancelled.");
+        return false;
+    }
+
+    // Join the chunks column by column in file order
+    table.columns.resize(columnCount);
+    ChartTools::ParallelFor(columnCount, [&](qsizetype first, qsizetype last, int) {
+        for (qsizetype column = first; column < last; ++column) {
+            size_t rows = 0;
+            for (const auto& columns : partial)
+                rows += columns.empty() ? 0 : columns[size_t(column)].size();
+
+            QVector<qreal>& target = table.columns[column];
+            target.reserve(qsizetype(rows));
+            for (const auto& columns : partial) {
+                if (!columns.empty())
+                    target.append(QVector<qreal>(columns[size_t(column)].begin(), columns[size_t(column)].end()));
+            }
+        }
+    },
+        1);
+    return true;
+}
+
+template <typename T>
+void readElements(const uchar* data, qsizetype rows, int columns, bool planar, DataTable& table,
+    const std::atomic<bool>* cancel, Progress& progress)
+{
+    std::vector<qreal*> targets;
+    for (QVector<qreal>& column : table.columns)
+        targets.push_back(column.data());
+
+    ChartTools::ParallelFor(rows, [&](qsizetype first, qsizetype last, int) {
+        for (qsizetype row = first; row < last; ++row) {
+            if ((row & 0xFFFF) == 0 && cancel && *cancel)
+                return;
+            for (int column = 0; column < columns; ++column) {
+                const qsizetype index = planar ? column * rows + row : row * columns + column;
+                targets[size_t(column)][row] = qreal(qFromLittleEndian<T>(data + index * qsizetype(sizeof(T))));
+            }
+        }
+        progress.add((last - first) * columns * qsizetype(sizeof(T)));
+    },
+        65536);
+}
+
+bool readBinary(const uchar* data, qint64 size, DataLoader::BinaryType type, qsizetype rows, int columns, bool planar,
+    DataTable& table, QString& error, const std::atomic<bool>* cancel, Progress& progress)
+{
+    const int element = type == DataLoader::BinaryType::Float32 || type == DataLoader::BinaryType::Int32 ? 4 : 8;
+    if (columns < 1 || rows < 0 || size < 0 || rows > size / element / columns) {
+        error = DataLoader::tr("The file is shorter than its layout requires.");
+        return false;
+    }
+
+    table.columns.resize(columns);
+    for (int column = 0; column < columns; ++column) {
+        table.columns[column].resize(rows);
+        table.names << DataLoader::tr("Column %1").arg(column + 1);
+    }
+
+    switch (type) {
+    case DataLoader::BinaryType::Float64:
+        readElements<double>(data, rows, columns, planar, table, cancel, progress);
+        break;
+    case DataLoader::BinaryType::Float32:
+        readElements<float>(data, rows, columns, planar, table, cancel, progress);
+        break;
+    case DataLoader::BinaryType::Int32:
+        readElements<qint32>(data, rows, columns, planar, table, cancel, progress);
+        break;
+    case DataLoader::BinaryType::Int64:
+        readElements<qint64>(data, rows, columns, planar, table, cancel, progress);
+        break;
+    }
+
+    if (cancel && *cancel) {
+        error = DataLoader::tr("Loading was cancelled.");
+        return false;
+    }
+    return true;
+}
+
+/* Reads the header of a NumPy .npy file: magic, version, header length and a
+ * Python dict literal with descr, fortran_order and shape. */
+bool readNpy(const uchar* data, qint64 size, DataTable& table, QString& error, const std::atomic<bool>* cancel, Progress& progress)
+{
+    if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0) {
+        error = DataLoader::tr("This is not a .npy file.");
+        return false;
+    }
+
+    const int major = data[6];
+    const qint64 headerStart = major == 1 ? 10 : 12;
+    if (size < headerStart) {
+        error = DataLoader::tr("The .npy header is truncated.");
+        return false;
+    }
+    const qint64 headerLength = major == 1 ? qFromLittleEndian<quint16>(data + 8) : qFromLittleEndian<quint32>(data + 8);
+    if (headerStart + headerLength > size) {
+        error = DataLoader::tr("The .npy header is truncated.");
+        return false;
+    }
+    const QByteArray header(reinterpret_cast<const char*>(data + headerStart), int(headerLength));
+
+    auto value = [&header](const char* key) -> QByteArray {
+        int index = header.indexOf(key);
+        if (index < 0)
+            return QByteArray();
+        index = header.indexOf(':', index) + 1;
+        return header.mid(index).trimmed();
+    };
+
+    QByteArray descr = value("'descr'");
+    descr = descr.mid(1, descr.indexOf('\'', 1) - 1);
+    const bool littleEndian = descr.startsWith('<') || descr.startsWith('|') || (descr.startsWith('=') && Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+    const QByteArray kind = descr.mid(1);
+
+    DataLoader::BinaryType type;
+    if (kind == "f8")
+        type = DataLoader::BinaryType::Float64;
+    else if (kind == "f4")
+        type = DataLoader::BinaryType::Float32;
+    else if (kind == "i4")
+        type = DataLoader::BinaryType::Int32;
+    else if (kind == "i8")
+        type = DataLoader::BinaryType::Int64;
+    else {
+        error = DataLoader::tr("The .npy element type %1 is not supported.").arg(QString::fromLatin1(descr));
+        return false;
+    }
+    if (!littleEndian) {
+        error = DataLoader::tr("Big endian .npy files are not supported.");
+        return false;
+    }
+
+    const bool fortran = value("'fortran_order'").startsWith("True");
+    QByteArray shape = value("'shape'");
+    shape = shape.mid(1, shape.indexOf(')') - 1);
+    QList<qsizetype> dimensions;
+    for (const QByteArray& dimension : shape.split(',')) {
+        if (dimension.trimmed().isEmpty())
+            continue;
+        bool ok = false;
+        const qlonglong extent = dimension.trimmed().toLongLong(&ok);
+        if (!ok || extent < 0) {
+            error = DataLoader::tr("The .npy shape is invalid.");
+            return false;
+        }
+        dimensions << qsizetype(extent);
+    }
+    if (dimensions.isEmpty() || dimensions.size() > 2) {
+        error = DataLoader::tr("Only one and two dimensional .npy arrays are supported.");
+        return false;
+    }
+    /* A column count beyond int range can never fit the file, so reject it
+     * here rather than truncate it. */
+    if (dimensions.size() == 2 && (dimensions[1] < 1 || dimensions[1] > std::numeric_limits<int>::max())) {
+        error = DataLoader::tr("The .npy shape is invalid.");
+        return false;
+    }
+
+    const qsizetype rows = dimensions[0];
+    const int columns = dimensions.size() == 2 ? int(dimensions[1]) : 1;
+    return readBinary(data + headerStart + headerLength, size - headerStart - headerLength, type, rows, columns, fortran,
+        table, error, cancel, progress);
+}
+}
+
+QList<QPointF> DataTable::points(int xColumn, int yColumn) const
+{
+    QList<QPointF> result;
+    if (yColumn < 0 || yColumn >= columns.size() || xColumn >= columns.size())
+        return result;
+
+    const QVector<qreal>& y = columns[yColumn];
+    result.reserve(y.size());
+    for (qsizetype i = 0; i < y.size(); ++i) {
+        const qreal x = xColumn < 0 ? qreal(i) : columns[xColumn][i];
+        if (std::isfinite(x) && std::isfinite(y[i]))
+            result.append(QPointF(x, y[i]));
+    }
+    return result;
+}
+
+void DataTable::fill(QXYSeries* series, int xColumn, int yColumn) const
+{
+    if (!series)
+        return;
+    series->replace(points(xColumn, yColumn));
+    if (yColumn >= 0 && yColumn < names.size())
+        series->setName(names[yColumn]);
+}
+
+DataLoader::DataLoader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+DataLoader::~DataLoader()
+{
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+    }
+}
+
+DataTable DataLoader::load(const QString& fileName, const Options& options, QString* error,
+    const std::atomic<bool>* cancel, const std::function<void(int)>& progress)
+{
+    DataTable table;
+    QString message;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = tr("Could not open %1: %2").arg(fileName, file.errorString());
+        return table;
+    }
+
+    // Mapping avoids a copy of the whole file, a plain read is the fallback
+    const qint64 size = file.size();
+    QByteArray buffer;
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (!data && size > 0) {
+        buffer = file.readAll();
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+    }
+
+    Format format = options.format;
+    if (format == Format::Auto) {
+        const QString suffix = QFileInfo(fileName).suffix().toLower();
+        if (suffix == QLatin1String("npy") || (size >= 6 && std::memcmp(data, "\x93NUMPY", 6) == 0))
+            format = Format::Npy;
+        else if (suffix == QLatin1String("bin") || suffix == QLatin1String("raw"))
+            format = Format::Binary;
+        else
+            format = Format::Delimited;
+    }
+
+    Progress tracker(size, progress);
+    bool success = false;
+    if (size <= 0) {
+        message = tr("The file contains no data.");
+    } else if (format == Format::Npy) {
+        success = readNpy(data, size, table, message, cancel, tracker);
+    } else if (format == Format::Binary) {
+        const qint64 payload = size - qBound<qint64>(0, options.binaryOffset, size);
+        const int element = options.binaryType == BinaryType::Float32 || options.binaryType == BinaryType::Int32 ? 4 : 8;
+        const int columns = qMax(1, options.binaryColumns);
+        success = readBinary(data + (size - payload), payload, options.binaryType, payload / element / columns, columns, false,
+            table, message, cancel, tracker);
+    } else {
+        success = parseDelimited(reinterpret_cast<const char*>(data), size, options, table, message, cancel, tracker);
+    }
+
+    if (!success)
+        table = DataTable();
+    if (error)
+        *error = message;
+    return table;
+}
+
+void DataLoader::start(const QString& fileName, const Options& options)
+{
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+    }
+    m_cancel = false;
+    const quint64 generation = ++m_generation;
+
+    m_thread = QThread::create([this, fileName, options, generation]() {
+        QString error;
+        const DataTable table = load(fileName, options, &error, &m_cancel, [this, generation](int percent) {
+            if (generation == m_generation)
+                emit progress(percent);
+        });
+        // The table is implicitly shared, handing it over copies no data. The result of a
+        // cancelled load may only arrive once the next one has started, it is dropped then.
+        QMetaObject::invokeMethod(
+            this, [this, table, error, generation]() {
+                if (generation != m_generation)
+                    return;
+                m_table = table;
+                emit finished(error.isEmpty(), error);
+            },
+            Qt::QueuedConnection);
+    });
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+    m_thread->start();
+}
+
+bool DataLoader::isRunning() const
+{
+    return m_thread && m_thread->isRunning();
+}
+
+DataTable DataLoader::takeTable()
+{
+    DataTable table = std::move(m_table);
+    m_table = DataTable();
+    return table;
+}
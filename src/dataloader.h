@@ -0,0 +1,146 @@
+/*
+ * CuteCharts - Parallel loader for delimited text and binary data files
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <atomic>
+#include <functional>
+
+class QThread;
+class QXYSeries;
+
+/**
+ * @brief Numeric columns read from a data file
+ */
+struct DataTable {
+    QStringList names; ///< Column names from the header line, generated if there is none
+    QVector<QVector<qreal>> columns;
+
+    int columnCount() const { return columns.size(); }
+    qsizetype rowCount() const { return columns.isEmpty() ? 0 : columns.first().size(); }
+
+    /**
+     * @brief Pair two columns into points
+     * @param xColumn Column of the x values, -1 uses the row index
+     * @param yColumn Column of the y values
+     * @return Points, rows with a non finite value are skipped
+     */
+    QList<QPointF> points(int xColumn, int yColumn) const;
+
+    /**
+     * @brief Replace the points of a series with two columns in one call
+     * @param series Series to fill, e.g. before ChartView::addSeries()
+     * @param xColumn Column of the x values, -1 uses the row index
+     * @param yColumn Column of the y values
+     */
+    void fill(QXYSeries* series, int xColumn, int yColumn) const;
+};
+
+/**
+ * @brief Loads numeric columns from CSV/TSV, raw binary and .npy files
+ *
+ * Text files are memory mapped and split into one chunk per worker at line
+ * boundaries; every chunk is parsed into its own column buffers in parallel
+ * and the buffers are joined in file order. Empty lines and lines starting
+ * with '#' are skipped, missing or unparsable fields become NaN.
+ *
+ * load() works synchronously on the calling thread, start() runs the same
+ * on a thread of its own and reports through progress() and finished().
+ */
+class DataLoader : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Auto, ///< .npy by content, .bin/.raw as Binary, everything else (.dat, .csv, ...) Delimited
+        Delimited,
+        Binary,
+        Npy
+    };
+
+    enum class BinaryType {
+        Float64,
+        Float32,
+        Int32,
+        Int64
+    };
+
+    struct Options {
+        Format format = Format::Auto;
+        char delimiter = 0; ///< 0 detects ',', '\t', ';' or whitespace from the first data line
+        int header = -1; ///< Header lines, -1 takes the first line as header if it is not numeric
+        BinaryType binaryType = BinaryType::Float64; ///< Little endian element type of raw binary files
+        int binaryColumns = 1; ///< Interleaved columns of raw binary files
+        qint64 binaryOffset = 0; ///< Bytes to skip at the start of raw binary files
+    };
+
+    explicit DataLoader(QObject* parent = nullptr);
+    ~DataLoader() override;
+
+    /**
+     * @brief Load a file on the calling thread
+     * @param fileName Path of the file
+     * @param options Format options
+     * @param error Receives a message if loading failed or was cancelled, may be nullptr
+     * @param cancel Polled while parsing, may be nullptr
+     * @param progress Called with the percentage from any worker thread, may be empty
+     * @return The table, empty on failure
+     */
+    static DataTable load(const QString& fileName, const Options& options = Options(), QString* error = nullptr,
+        const std::atomic<bool>* cancel = nullptr, const std::function<void(int)>& progress = {});
+
+    /**
+     * @brief Load a file on a background thread
+     *
+     * A load that is still running is cancelled first, its finished() is dropped.
+     * @param fileName Path of the file
+     * @param options Format options
+     */
+    void start(const QString& fileName, const Options& options = Options());
+
+    /**
+     * @brief Ask the running load to stop, finished() follows with an error
+     */
+    void cancel() { m_cancel = true; }
+
+    bool isRunning() const;
+
+    /**
+     * @brief Take the result of the last finished load
+     * @return The table, the loader keeps an empty one
+     */
+    DataTable takeTable();
+
+signals:
+    void progress(int percent);
+    void finished(bool success, const QString& error);
+
+private:
+    QPointer<QThread> m_thread;
+    std::atomic<bool> m_cancel{ false };
+    std::atomic<quint64> m_generation{ 0 }; ///< Counts start() calls, results of older loads are dropped
+    DataTable m_table;
+};
@@ -0,0 +1,150 @@
+/*
+ * CuteCharts - Screen resolution density maps for overplotted scatter data
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "parallel.h"
+
+#include "densitymap.h"
+
+namespace {
+
+struct ColorStop {
+    unsigned char r, g, b;
+};
+
+// Nine evenly spaced stops per map, linearly interpolated in between
+constexpr std::array<ColorStop, 9> viridis{ { { 68, 1, 84 }, { 71, 44, 122 }, { 59, 81, 139 }, { 44, 113, 142 }, { 33, 144, 141 },
+    { 39, 173, 129 }, { 92, 200, 99 }, { 170, 220, 50 }, { 253, 231, 37 } } };
+
+constexpr std::array<ColorStop, 9> magma{ { { 0, 0, 4 }, { 28, 16, 68 }, { 79, 18, 123 }, { 129, 37, 129 }, { 181, 54, 122 },
+    { 229, 80, 100 }, { 251, 135, 97 }, { 254, 194, 135 }, { 252, 253, 191 } } };
+
+constexpr std::array<ColorStop, 9> grayscale{ { { 220, 220, 220 }, { 192, 192, 192 }, { 165, 165, 165 }, { 137, 137, 137 }, { 110, 110, 110 },
+    { 82, 82, 82 }, { 55, 55, 55 }, { 27, 27, 27 }, { 0, 0, 0 } } };
+
+const std::array<ColorStop, 9>& stops(ColorMap map)
+{
+    switch (map) {
+    case ColorMap::Magma:
+        return magma;
+    case ColorMap::Grayscale:
+        return grayscale;
+    default:
+        return viridis;
+    }
+}
+
+}
+
+QRgb DensityMap::color(ColorMap map, qreal value)
+{
+    const auto& table = stops(map);
+    const qreal position = qBound<qreal>(0, value, 1) * (table.size() - 1);
+    const int lower = qMin(int(position), int(table.size()) - 2);
+    const qreal t = position - lower;
+    const ColorStop& a = table[lower];
+    const ColorStop& b = table[lower + 1];
+    return qRgb(int(a.r + t * (b.r - a.r)), int(a.g + t * (b.g - a.g)), int(a.b + t * (b.b - a.b)));
+}
+
+DensityMap DensityMap::bin(const QPointF* points, qsizetype count, const QRectF& range, const QSize& size)
+{
+    DensityMap density;
+    density.m_size = size;
+    if (size.isEmpty() || range.width() <= 0 || range.height() <= 0)
+        return density;
+
+    const qsizetype bins = qsizetype(size.width()) * size.height();
+    const int workers = ChartTools::WorkerCount();
+    std::vector<std::vector<quint32>> partial(workers);
+
+    const qreal sx = size.width() / range.width();
+    const qreal sy = size.height() / range.height();
+    const qreal x0 = range.left();
+    const qreal y1 = range.bottom();
+    const int width = size.width();
+    const int height = size.height();
+
+    ChartTools::ParallelFor(count, [&partial, points, bins, sx, sy, x0, y1, width, height](qsizetype begin, qsizetype end, int worker) {
+        std::vector<quint32>& local = partial[worker];
+        local.assign(size_t(bins), 0);
+        for (qsizetype i = begin; i < end; ++i) {
+            const qreal fx = (points[i].x() - x0) * sx;
+            const qreal fy = (y1 - points[i].y()) * sy;
+            if (!(fx >= 0 && fx < width && fy >= 0 && fy < height))
+                continue;
+            ++local[size_t(int(fy)) * width + size_t(int(fx))];
+        }
+    },
+        16384);
+
+    // Merge the per-thread bins, again split across the pool
+    density.m_counts.resize(bins);
+    quint32* counts = density.m_counts.data();
+    std::vector<quint32> maxima(workers, 0);
+    ChartTools::ParallelFor(bins, [&partial, &maxima, counts](qsizetype begin, qsizetype end, int worker) {
+        quint32 maximum = 0;
+        for (qsizetype i = begin; i < end; ++i) {
+            quint32 sum = 0;
+            for (const std::vector<quint32>& local : partial) {
+                if (!local.empty())
+                    sum += local[size_t(i)];
+            }
+            counts[i] = sum;
+            maximum = qMax(maximum, sum);
+        }
+        maxima[worker] = maximum;
+    });
+
+    for (quint32 maximum : maxima)
+        density.m_maximum = qMax(density.m_maximum, maximum);
+    return density;
+}
+
+QImage DensityMap::toImage(ColorMap map, bool logarithmic) const
+{
+    if (m_size.isEmpty() || m_counts.isEmpty())
+        return QImage();
+
+    // Quantize to a 256 entry table instead of interpolating the colour map per pixel
+    const qreal scale = logarithmic ? 1.0 / std::log1p(qreal(qMax<quint32>(1, m_maximum))) : 1.0 / qMax<quint32>(1, m_maximum);
+    std::array<QRgb, 256> lut;
+    for (int i = 0; i < 256; ++i)
+        lut[size_t(i)] = color(map, i / 255.0);
+
+    QImage image(m_size, QImage::Format_ARGB32_Premultiplied);
+    const quint32* counts = m_counts.constData();
+    const int width = m_size.width();
+    for (int y = 0; y < m_size.height(); ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            const quint32 count = counts[size_t(y) * width + x];
+            if (count == 0) {
+                line[x] = 0;
+                continue;
+            }
+            const qreal value = logarithmic ? std::log1p(qreal(count)) * scale : count * scale;
+            line[x] = lut[size_t(qBound(0, int(value * 255.0 + 0.5), 255))];
+        }
+    }
+    return image;
+}
@@ -0,0 +1,78 @@
+/*
+ * CuteCharts - Screen resolution density maps for overplotted scatter data
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QSize>
+#include <QtCore/QVector>
+
+#include <QtGui/QImage>
+
+enum class ColorMap {
+    Viridis = 0,
+    Magma = 1,
+    Grayscale = 2
+};
+
+/**
+ * @brief 2D histogram of points at screen resolution
+ *
+ * Points are binned in parallel, every worker counts into its own bins and
+ * the partial histograms are summed at the end. The result is turned into an
+ * image through a colour map, optionally with logarithmic scaling.
+ */
+class DensityMap {
+public:
+    /**
+     * @brief Bin points into a grid
+     * @param points Points in chart values
+     * @param count Number of points
+     * @param range Value range covered by the grid, top is the minimum y
+     * @param size Grid size in pixels
+     * @return The density map
+     */
+    static DensityMap bin(const QPointF* points, qsizetype count, const QRectF& range, const QSize& size);
+
+    /**
+     * @brief Colour the density map
+     * @param map Colour map to use
+     * @param logarithmic Use log(1 + count) instead of count
+     * @return Premultiplied ARGB32 image, empty bins stay transparent
+     */
+    QImage toImage(ColorMap map, bool logarithmic) const;
+
+    /**
+     * @brief Look up a colour
+     * @param map Colour map to use
+     * @param value Position in [0, 1]
+     * @return Colour at that position
+     */
+    static QRgb color(ColorMap map, qreal value);
+
+    QSize size() const { return m_size; }
+    quint32 maximum() const { return m_maximum; }
+    const QVector<quint32>& counts() const { return m_counts; }
+
+private:
+    QSize m_size;
+    QVector<quint32> m_counts;
+    quint32 m_maximum = 0;
+};
@@ -12,9 +12,10 @@ int main(int argc, char** argv)
     QMainWindow* window = new QMainWindow;
 
     ChartView* view = new ChartView;
-    LineSeries* series = new LineSeries;
-    for (int i = 0; i < 10000; ++i)
-        series->append(i / 100.0, std::sin(i / 100.0));
+    QVector<double> values(10000);
+    for (int i = 0; i < values.size(); ++i)
+        values[i] = std::sin(i / 100.0);
+    UniformLineSeries* series = new UniformLineSeries(0, 0.01, values);
 
     view->addSeries(series);
     window->setCentralWidget(view);
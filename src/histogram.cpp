@@ -0,0 +1,195 @@
+/*
+ * CuteCharts - Streaming histogram with a fine base binning
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+
+#include "histogram.h"
+
+Histogram::Histogram(int bins, qreal min, qreal max, bool autoExpand)
+    : m_auto_expand(autoExpand)
+{
+    m_counts.resize(qMax(2, bins + (bins & 1)));
+    reset(min, max);
+}
+
+void Histogram::reset(qreal min, qreal max)
+{
+    if (!(max > min)) {
+        min = std::isfinite(min) ? min : 0;
+        max = min + 1;
+    }
+    m_min = min;
+    m_max = max;
+    m_counts.fill(0);
+    m_total = m_underflow = m_overflow = 0;
+}
+
+void Histogram::expand(qreal low, qreal high)
+{
+    const int bins = m_counts.size();
+    QVector<quint64> merged(bins, 0);
+
+    // Every step doubles the range, the loop ends long before the width overflows
+    for (int step = 0; step < 1024 && (low < m_min || high >= m_max); ++step) {
+        const qreal width = m_max - m_min;
+        if (!std::isfinite(width * 2))
+            break;
+
+        merged.fill(0);
+        if (low < m_min) {
+            for (int i = 0; i < bins; ++i)
+                merged[bins / 2 + i / 2] += m_counts[i];
+            m_min -= width;
+        } else {
+            for (int i = 0; i < bins; ++i)
+                merged[i / 2] += m_counts[i];
+            m_max += width;
+        }
+        m_counts.swap(merged);
+    }
+}
+
+void Histogram::addSample(qreal sample)
+{
+    if (!std::isfinite(sample))
+        return;
+
+    if (m_auto_expand && (sample < m_min || sample >= m_max))
+        expand(sample, sample);
+
+    if (sample < m_min) {
+        ++m_underflow;
+    } else if (sample >= m_max) {
+        ++m_overflow;
+    } else {
+        const int bins = m_counts.size();
+        const int index = qMin(bins - 1, int((sample - m_min) / (m_max - m_min) * bins));
+        ++m_counts[index];
+        ++m_total;
+    }
+}
+
+void Histogram::addSamples(const qreal* samples, qsizetype count)
+{
+    if (count < 65536) {
+        for (qsizetype i = 0; i < count; ++i)
+            addSample(samples[i]);
+        return;
+    }
+
+    const int workers = ChartTools::WorkerCount();
+
+    // Grow once for the whole batch instead of per sample
+    if (m_auto_expand) {
+        std::vector<qreal> lows(workers, std::numeric_limits<qreal>::max());
+        std::vector<qreal> highs(workers, std::numeric_limits<qreal>::lowest());
+        ChartTools::ParallelFor(count, [samples, &lows, &highs](qsizetype begin, qsizetype end, int worker) {
+            qreal low = lows[worker], high = highs[worker];
+            for (qsizetype i = begin; i < end; ++i) {
+                if (!std::isfinite(samples[i]))
+                    continue;
+                low = qMin(low, samples[i]);
+                high = qMax(high, samples[i]);
+            }
+            lows[worker] = low;
+            highs[worker] = high;
+        });
+        qreal low = std::numeric_limits<qreal>::max(), high = std::numeric_limits<qreal>::lowest();
+        for (int i = 0; i < workers; ++i) {
+            low = qMin(low, lows[i]);
+            high = qMax(high, highs[i]);
+        }
+        if (low <= high)
+            expand(low, high);
+    }
+
+    struct Partial {
+        std::vector<quint64> counts;
+        quint64 underflow = 0, overflow = 0;
+    };
+    std::vector<Partial> partial(workers);
+
+    const int bins = m_counts.size();
+    const qreal min = m_min, max = m_max;
+    const qreal scale = bins / (m_max - m_min);
+    ChartTools::ParallelFor(count, [samples, &partial, bins, min, max, scale](qsizetype begin, qsizetype end, int worker) {
+        Partial& local = partial[worker];
+        local.counts.assign(size_t(bins), 0);
+        for (qsizetype i = begin; i < end; ++i) {
+            const qreal sample = samples[i];
+            if (!std::isfinite(sample))
+                continue;
+            if (sample < min)
+                ++local.underflow;
+            else if (sample >= max)
+                ++local.overflow;
+            else
+                ++local.counts[size_t(qMin(bins - 1, int((sample - min) * scale)))];
+        }
+    },
+        65536);
+
+    for (const Partial& local : partial) {
+        if (local.counts.empty())
+            continue;
+        for (int i = 0; i < bins; ++i) {
+            m_counts[i] += local.counts[size_t(i)];
+            m_total += local.counts[size_t(i)];
+        }
+        m_underflow += local.underflow;
+        m_overflow += local.overflow;
+    }
+}
+
+QVector<qreal> Histogram::rebin(qreal min, qreal max, int bins) const
+{
+    QVector<qreal> result(qMax(0, bins), 0);
+    if (bins <= 0 || !(max > min))
+        return result;
+
+    const int base = m_counts.size();
+    std::vector<qreal> cumulative(size_t(base) + 1, 0);
+    for (int i = 0; i < base; ++i)
+        cumulative[size_t(i) + 1] = cumulative[size_t(i)] + m_counts[i];
+
+    // Cumulative count up to x, linear within a base bin
+    const qreal scale = base / (m_max - m_min);
+    auto below = [&](qreal x) -> qreal {
+        const qreal position = (x - m_min) * scale;
+        if (position <= 0)
+            return 0;
+        if (position >= base)
+            return cumulative[size_t(base)];
+        const int index = int(position);
+        return cumulative[size_t(index)] + (position - index) * m_counts[index];
+    };
+
+    const qreal width = (max - min) / bins;
+    qreal previous = below(min);
+    for (int i = 0; i < bins; ++i) {
+        const qreal next = below(min + (i + 1) * width);
+        result[i] = next - previous;
+        previous = next;
+    }
+    return result;
+}
@@ -0,0 +1,98 @@
+/*
+ * CuteCharts - Streaming histogram with a fine base binning
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QVector>
+#include <QtCore/QtGlobal>
+
+/**
+ * @brief Histogram that is filled sample by sample and never stores the samples
+ *
+ * Counts are kept in a fixed number of fine base bins. Displayed bins are
+ * derived from the base bins by rebin(), so zooming changes the bar width
+ * without revisiting the data. With auto expansion the range doubles towards
+ * samples that fall outside of it, merging pairs of base bins; otherwise such
+ * samples end up in the underflow and overflow counters.
+ */
+class Histogram {
+public:
+    /**
+     * @brief Create an empty histogram
+     * @param bins Number of base bins, rounded up to an even number
+     * @param min Lower edge of the initial range
+     * @param max Upper edge of the initial range
+     * @param autoExpand Grow the range instead of counting under- and overflow
+     */
+    explicit Histogram(int bins = 4096, qreal min = 0, qreal max = 1, bool autoExpand = true);
+
+    /**
+     * @brief Drop all counts and set a new range
+     * @param min Lower edge
+     * @param max Upper edge
+     */
+    void reset(qreal min, qreal max);
+
+    /**
+     * @brief Count a single sample
+     * @param sample Value, non finite values are ignored
+     */
+    void addSample(qreal sample);
+
+    /**
+     * @brief Count a batch of samples, large batches are binned in parallel
+     * @param samples Values, non finite values are ignored
+     * @param count Number of values
+     */
+    void addSamples(const qreal* samples, qsizetype count);
+
+    /**
+     * @brief Sum the base bins into evenly spaced bins
+     *
+     * Display edges do not have to coincide with base edges, the counts of a
+     * base bin are then split proportionally to the overlap.
+     * @param min Lower edge of the first bin
+     * @param max Upper edge of the last bin
+     * @param bins Number of bins
+     * @return Counts per bin
+     */
+    QVector<qreal> rebin(qreal min, qreal max, int bins) const;
+
+    int bins() const { return m_counts.size(); }
+    qreal minimum() const { return m_min; }
+    qreal maximum() const { return m_max; }
+    qreal binWidth() const { return (m_max - m_min) / m_counts.size(); }
+    bool autoExpand() const { return m_auto_expand; }
+    void setAutoExpand(bool autoExpand) { m_auto_expand = autoExpand; }
+    quint64 total() const { return m_total; }
+    quint64 underflow() const { return m_underflow; }
+    quint64 overflow() const { return m_overflow; }
+    const QVector<quint64>& counts() const { return m_counts; }
+
+private:
+    /**
+     * @brief Double the range until it covers [low, high]
+     */
+    void expand(qreal low, qreal high);
+
+    QVector<quint64> m_counts;
+    qreal m_min = 0, m_max = 1;
+    quint64 m_total = 0, m_underflow = 0, m_overflow = 0;
+    bool m_auto_expand = true;
+};
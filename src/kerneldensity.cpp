@@ -0,0 +1,153 @@
+/*
+ * CuteCharts - Binned kernel density estimation
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCore/QtMath>
+
+#include <complex>
+#include <vector>
+
+#include "parallel.h"
+
+#include "kerneldensity.h"
+
+namespace {
+
+using Complex = std::complex<qreal>;
+
+// Iterative radix-2 FFT, the size has to be a power of two
+void fft(std::vector<Complex>& data, bool inverse)
+{
+    const size_t size = data.size();
+    for (size_t i = 1, j = 0; i < size; ++i) {
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (size_t length = 2; length <= size; length <<= 1) {
+        const qreal angle = 2 * M_PI / length * (inverse ? 1 : -1);
+        const Complex root(std::cos(angle), std::sin(angle));
+        for (size_t start = 0; start < size; start += length) {
+            Complex w(1);
+            for (size_t k = 0; k < length / 2; ++k) {
+                const Complex even = data[start + k];
+                const Complex odd = data[start + k + length / 2] * w;
+                data[start + k] = even + odd;
+                data[start + k + length / 2] = even - odd;
+                w *= root;
+            }
+        }
+    }
+
+    if (inverse) {
+        for (Complex& value : data)
+            value /= qreal(size);
+    }
+}
+
+}
+
+KernelDensity KernelDensity::estimate(const qreal* samples, qsizetype count, qreal min, qreal max, int points, qreal bandwidth)
+{
+    KernelDensity result;
+    result.min = min;
+    result.max = max;
+    result.bandwidth = bandwidth;
+    if (!samples || count <= 0 || points < 2 || !(max > min) || !(bandwidth > 0))
+        return result;
+
+    const qreal step = (max - min) / (points - 1);
+
+    // Linear binning, every sample is split between its two neighbouring grid points
+    const int workers = ChartTools::WorkerCount();
+    std::vector<std::vector<qreal>> partial(workers);
+    std::vector<qsizetype> used(workers, 0);
+    ChartTools::ParallelFor(count, [samples, &partial, &used, min, step, points](qsizetype begin, qsizetype end, int worker) {
+        std::vector<qreal>& local = partial[worker];
+        local.assign(size_t(points), 0);
+        qsizetype finite = 0;
+        for (qsizetype i = begin; i < end; ++i) {
+            if (!std::isfinite(samples[i]))
+                continue;
+            ++finite;
+            const qreal position = (samples[i] - min) / step;
+            if (position < 0 || position > points - 1)
+                continue;
+            const int lower = qMin(points - 2, int(position));
+            const qreal weight = position - lower;
+            local[size_t(lower)] += 1 - weight;
+            local[size_t(lower) + 1] += weight;
+        }
+        used[worker] = finite;
+    },
+        65536);
+
+    qsizetype total = 0;
+    for (qsizetype finite : used)
+        total += finite;
+    if (total == 0)
+        return result;
+
+    // Kernel support of four bandwidths, padded so the circular convolution does not wrap
+    const int reach = qMin(points - 1, int(std::ceil(4 * bandwidth / step)));
+    size_t size = 1;
+    while (size < size_t(points + reach))
+        size <<= 1;
+
+    std::vector<Complex> bins(size, 0);
+    for (const std::vector<qreal>& local : partial) {
+        for (size_t i = 0; i < local.size(); ++i)
+            bins[i] += local[i];
+    }
+
+    std::vector<Complex> kernel(size, 0);
+    const qreal norm = 1 / (bandwidth * std::sqrt(2 * M_PI) * total);
+    for (int lag = 0; lag <= reach; ++lag) {
+        const qreal u = lag * step / bandwidth;
+        const qreal value = norm * std::exp(-0.5 * u * u);
+        kernel[size_t(lag)] = value;
+        if (lag > 0)
+            kernel[size - size_t(lag)] = value;
+    }
+
+    fft(bins, false);
+    fft(kernel, false);
+    for (size_t i = 0; i < size; ++i)
+        bins[i] *= kernel[i];
+    fft(bins, true);
+
+    result.density.resize(points);
+    for (int i = 0; i < points; ++i)
+        result.density[i] = qMax<qreal>(0, bins[size_t(i)].real());
+    return result;
+}
+
+qreal KernelDensity::silvermanBandwidth(const BoxWhisker& box)
+{
+    const qreal iqr = (box.upper_quantile - box.lower_quantile) / 1.34;
+    qreal spread = box.stddev;
+    if (iqr > 0)
+        spread = spread > 0 ? qMin(spread, iqr) : iqr;
+    if (!(spread > 0))
+        spread = qMax<qreal>(1e-12, std::abs(box.median) * 1e-3);
+    return 0.9 * spread * std::pow(qMax(1, box.count), -0.2);
+}
@@ -0,0 +1,64 @@
+/*
+ * CuteCharts - Binned kernel density estimation
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QVector>
+#include <QtCore/QtGlobal>
+
+#include "boxwhisker.h"
+
+/**
+ * @brief Gaussian kernel density estimate on a regular grid
+ *
+ * Samples are linearly binned onto the grid in parallel and the bin counts
+ * are convolved with the sampled kernel through an FFT, which costs
+ * O(N + M log M) instead of O(N M) for N samples and M grid points.
+ */
+struct KernelDensity {
+    qreal min = 0; ///< Value of the first grid point
+    qreal max = 0; ///< Value of the last grid point
+    qreal bandwidth = 0;
+    QVector<qreal> density; ///< Normalized density at every grid point
+
+    /**
+     * @brief Estimate the density of a sample set
+     * @param samples Values, non finite values are ignored
+     * @param count Number of values
+     * @param min Value of the first grid point
+     * @param max Value of the last grid point
+     * @param points Number of grid points
+     * @param bandwidth Standard deviation of the kernel
+     * @return The estimate, empty if there are no samples or the grid is degenerate
+     */
+    static KernelDensity estimate(const qreal* samples, qsizetype count, qreal min, qreal max, int points, qreal bandwidth);
+
+    /**
+     * @brief Silverman's rule of thumb
+     * @param box Summary of the samples
+     * @return Bandwidth, never zero
+     */
+    static qreal silvermanBandwidth(const BoxWhisker& box);
+
+    /**
+     * @brief Grid spacing
+     * @return Distance between two grid points
+     */
+    qreal step() const { return density.size() > 1 ? (max - min) / (density.size() - 1) : 0; }
+};
@@ -23,13 +23,14 @@
 
 #include <QtWidgets/QColorDialog>
 #include <QtWidgets/QLayout>
-#include <QtWidgets/QListWidget>
+#include <QtWidgets/QListView>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QSplitter>
 #include <QtWidgets/QWidget>
 
 #include "chartview.h"
 #include "series.h"
+#include "serieslistmodel.h"
 
 #include "listchart.h"
 
@@ -44,13 +45,23 @@ ListChart::ListChart()
     m_chartview->setYAxis("Y");
     m_chartview->setXAxis("X");
 
-    m_list = new QListWidget;
+    m_model = new SeriesListModel(true, this);
+    m_list = new QListView;
+    m_list->setModel(m_model);
+    m_list->setItemDelegate(new SeriesListDelegate(m_list));
+    m_list->setUniformItemSizes(true);
+    m_list->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_list->setMaximumWidth(200);
 
     m_list->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(m_list, &QListWidget::customContextMenuRequested, this, &ListChart::contextMenu);
-
-    m_names_list = new QListWidget;
+    connect(m_list, &QListView::customContextMenuRequested, this, &ListChart::contextMenu);
+
+    m_names_model = new SeriesListModel(false, this);
+    m_names_list = new QListView;
+    m_names_list->setModel(m_names_model);
+    m_names_list->setItemDelegate(new SeriesListDelegate(m_names_list));
+    m_names_list->setUniformItemSizes(true);
+    m_names_list->setEditTriggers(QAbstractItemView::NoEditTriggers);
     m_names_list->setMaximumWidth(200);
 
     QSplitter* list_splitter = new QSplitter(Qt::Vertical);
@@ -63,8 +74,9 @@ ListChart::ListChart()
     layout->addWidget(splitter);
     setLayout(layout);
 
-    connect(m_list, &QListWidget::itemDoubleClicked, this, &ListChart::seriesListClicked);
-    connect(m_names_list, &QListWidget::itemDoubleClicked, this, &ListChart::namesListClicked);
+    connect(m_list, &QListView::doubleClicked, this, &ListChart::seriesListClicked);
+    connect(m_names_list, &QListView::doubleClicked, this, &ListChart::namesListClicked);
+    connect(m_model, &SeriesListModel::nameEdited, this, &ListChart::renameGroup);
 }
 
 ListChart::~ListChart()
@@ -88,36 +100,35 @@ void ListChart::addSeries(QAbstractSeries* series, int index, const QColor& colo
 
     m_chartview->addSeries(series, callout);
 
-    QListWidgetItem* item = nullptr;
-    if (index >= m_list->count()) {
-        item = new QListWidgetItem(name);
-        item->setData(Qt::UserRole, index);
-        if (qobject_cast<QXYSeries*>(series))
-            item->setBackground(qobject_cast<QXYSeries*>(series)->color());
-        else
-            item->setBackground(color);
-        m_list->addItem(item);
-        item->setData(Qt::UserRole + 1, QVariant::fromValue(series));
+    QXYSeries* s = qobject_cast<QXYSeries*>(series);
+    const bool created = !m_registry.contains(index);
+    m_registry.add(series, index, name, s ? s->color() : color);
+    if (!created && !m_registry.group(index).visible)
+        series->setVisible(false);
+
+    if (index >= m_model->entryCount()) {
+        SeriesListModel::Entry entry;
+        entry.name = name;
+        entry.group = index;
+        entry.series = series;
+        entry.color = s ? s->color() : color;
+        m_model->append(entry);
+
+        if (s)
+            connect(s, &QXYSeries::colorChanged, m_model, [this, index](const QColor& color) {
+                m_registry.setColor(index, color);
+                m_model->setGroupColor(index, color);
+            });
     }
 
-    QXYSeries* s = qobject_cast<QXYSeries*>(series);
-    if (s && item != nullptr)
-        connect(s, &QXYSeries::colorChanged, this, [item](const QColor& color) {
-            item->setBackground(color);
-        });
-
-    if (!m_names_list->findItems(name, Qt::MatchExactly).size()) {
-        item = new QListWidgetItem(name);
-        item->setData(Qt::UserRole, name);
-        m_names_list->addItem(item);
+    if (!m_names_model->contains(name)) {
+        SeriesListModel::Entry entry;
+        entry.name = name;
+        m_names_model->append(entry);
     }
 
-    m_list->setItemDelegate(new HTMLListItem(m_list));
-    m_names_list->setItemDelegate(new HTMLListItem(m_names_list));
-    m_hidden[index] = true;
-    m_series.insert(index, series);
     m_chartview->formatAxis();
-    if (m_list->count() == m_names_list->count())
+    if (m_model->entryCount() == m_names_model->entryCount())
         m_names_list->hide();
     else
         m_names_list->show();
@@ -126,52 +137,134 @@ void ListChart::addSeries(QAbstractSeries* series, int index, const QColor& colo
 QLineSeries* ListChart::addLinearSeries(qreal m, qreal n, qreal min, qreal max, int index)
 {
     QLineSeries* serie = m_chartview->addLinearSeries(m, n, min, max);
-    m_series.insert(index, serie);
+    m_registry.add(serie, index, serie->name(), serie->color());
     return serie;
 }
 
 void ListChart::clear()
 {
     m_chartview->clearChart();
-    m_series.clear();
-    m_list->clear();
-    m_names_list->clear();
+    m_registry.clear();
+    m_model->clear();
+    m_names_model->clear();
 }
 
-void ListChart::namesListClicked(QListWidgetItem* item)
+void ListChart::seriesListClicked(const QModelIndex& index)
 {
-    QString str = item->data(Qt::UserRole).toString();
-    QList<QListWidgetItem*> list = m_list->findItems(str, Qt::MatchExactly);
-    for (int i = 0; i < list.size(); ++i)
-        seriesListClicked(list[i]);
+    hideSeries(index.data(SeriesListModel::GroupRole).toInt());
+    emit itemDoubleClicked(index);
+}
+
+void ListChart::namesListClicked(const QModelIndex& index)
+{
+    const QVector<int> groups = m_registry.groupsNamed(index.data(Qt::DisplayRole).toString());
+    batchUpdate([this, &groups]() {
+        for (int group : groups)
+            applyGroupVisible(group, !m_registry.group(group).visible);
+    });
 }
 
 void ListChart::hideSeries(int index)
 {
-    m_hidden[index] = !m_hidden[index];
-    QList<QAbstractSeries*> series = m_series.values(index);
-    for (int j = 0; j < series.size(); ++j) {
-        if (qobject_cast<BoxPlotSeries*>(series[j])) // visibility doesnt work for boxplots ??
-            qobject_cast<BoxPlotSeries*>(series[j])->setVisible(m_hidden[index]);
+    if (m_registry.contains(index))
+        setGroupVisible(index, !m_registry.group(index).visible);
+}
+
+void ListChart::setGroupVisible(int index, bool visible)
+{
+    applyGroupVisible(index, visible);
+}
+
+void ListChart::setGroupsVisible(const QList<int>& groups, bool visible)
+{
+    batchUpdate([this, &groups, visible]() {
+        for (int group : groups)
+            applyGroupVisible(group, visible);
+    });
+}
+
+void ListChart::setGroupsColor(const QList<int>& groups, const QColor& color)
+{
+    batchUpdate([this, &groups, &color]() {
+        for (int group : groups)
+            applyGroupColor(group, color);
+    });
+}
+
+void ListChart::renameGroup(int index, const QString& name)
+{
+    if (!m_registry.contains(index))
+        return;
+    const QString previous = m_registry.group(index).name;
+    if (!m_registry.setName(index, name))
+        return;
+
+    for (QAbstractSeries* series : m_registry.groupSeries(index)) {
+        if (qobject_cast<QXYSeries*>(series))
+            series->setName(name);
+    }
+    m_model->setName(m_model->rowOfGroup(index), name);
+
+    // The names list carries every name once, the old one goes with its last group
+    if (m_names_model->contains(name))
+        return;
+    const QList<int> rows = m_names_model->rowsOfName(previous);
+    if (!rows.isEmpty() && m_model->rowsOfName(previous).isEmpty()) {
+        m_names_model->setName(rows.first(), name);
+    } else {
+        SeriesListModel::Entry entry;
+        entry.name = name;
+        m_names_model->append(entry);
+    }
+}
+
+void ListChart::batchUpdate(const std::function<void()>& update)
+{
+    // One repaint of the chart for the whole batch, the lists coalesce on their own and
+    // ChartView rescales once for all visibility changes when control returns to the event loop
+    const bool enabled = m_chartview->updatesEnabled();
+    m_chartview->setUpdatesEnabled(false);
+    update();
+    m_chartview->setUpdatesEnabled(enabled);
+}
+
+void ListChart::applyGroupVisible(int index, bool visible)
+{
+    if (!m_registry.setVisible(index, visible))
+        return;
+
+    const QList<QAbstractSeries*> series = m_registry.groupSeries(index);
+    for (QAbstractSeries* serie : series) {
+        if (qobject_cast<BoxPlotSeries*>(serie)) // QAbstractSeries::setVisible does not hide the boxes
+            qobject_cast<BoxPlotSeries*>(serie)->setVisible(visible);
         else
-            series[j]->setVisible(m_hidden[index]);
+            serie->setVisible(visible);
     }
 }
 
+void ListChart::applyGroupColor(int index, const QColor& color)
+{
+    if (!color.isValid() || !m_registry.contains(index))
+        return;
+
+    m_registry.setColor(index, color);
+    const QList<QAbstractSeries*> series = m_registry.groupSeries(index);
+    for (QAbstractSeries* serie : series)
+        updateSeriesColor(serie, color);
+    m_model->setGroupColor(index, color);
+}
+
 void ListChart::contextMenu(const QPoint& pos)
 {
     // Handle global position
     QPoint globalPos = m_list->mapToGlobal(pos);
 
-    QListWidgetItem* item = m_list->item(m_list->currentRow());
+    if (!m_list->currentIndex().isValid())
+        return;
 
     // Create menu and insert some actions
     QMenu myMenu;
-    if (item->flags().testFlag(Qt::ItemIsEditable) == false)
-        myMenu.addAction("Rename", this, &ListChart::renameSeries);
-    else
-        myMenu.addAction("Save", this, &ListChart::renameSeries);
-
+    myMenu.addAction("Rename", this, &ListChart::renameSeries);
     myMenu.addAction("Change Color", this, &ListChart::changeColor);
 
     // Show context menu at handling position
@@ -180,44 +273,28 @@ void ListChart::contextMenu(const QPoint& pos)
 
 void ListChart::renameSeries()
 {
-    QListWidgetItem* item = m_list->item(m_list->currentRow());
-    QAbstractSeries* series = item->data(Qt::UserRole + 1).value<QAbstractSeries*>();
-    if (item->flags().testFlag(Qt::ItemIsEditable) == false) {
-        item->setFlags(item->flags() | Qt::ItemIsEditable);
-        m_list->editItem(item);
-    } else {
-        item->setFlags(item->flags() ^ Qt::ItemIsEditable);
-        m_list->editItem(item);
-        if (qobject_cast<QXYSeries*>(series)) {
-            qobject_cast<QXYSeries*>(series)->setName(item->text());
-        }
-    }
+    // The model renames the series once the editor is committed
+    const QModelIndex index = m_list->currentIndex();
+    if (index.isValid())
+        m_list->edit(index);
 }
 
 void ListChart::setColor(int index, const QColor& color)
 {
-    if (index < m_list->count()) {
-        QListWidgetItem* item = m_list->item(index);
-        QList<QAbstractSeries*> seriesList = m_series.values(index);
-
-        for (QAbstractSeries* series : seriesList) {
-            updateSeriesColor(item, series, color);
-        }
-    }
+    applyGroupColor(index, color);
 }
 
 void ListChart::changeColor()
 {
-    QListWidgetItem* item = m_list->item(m_list->currentRow());
-    QAbstractSeries* series = item->data(Qt::UserRole + 1).value<QAbstractSeries*>();
+    const QModelIndex index = m_list->currentIndex();
+    QAbstractSeries* series = index.data(SeriesListModel::SeriesRole).value<QAbstractSeries*>();
 
     if (!series)
         return;
 
     QColor color = QColorDialog::getColor(tr("Choose Color for Series"));
-    if (color.isValid()) {
-        updateSeriesColor(item, series, color);
-    }
+    if (color.isValid())
+        applyGroupColor(index.data(SeriesListModel::GroupRole).toInt(), color);
 }
 
 #include "listchart.moc"
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "chartview.h"
+#include "seriesregistry.h"
 
 #include <QtCharts/QAbstractSeries>
 #include <QtCharts/QChart>
@@ -26,69 +27,12 @@
 
 #include <QtCore/QModelIndex>
 
-#include <QtGui/QTextDocument>
-
-#include <QtWidgets/QListWidgetItem>
-#include <QtWidgets/QStyleOptionViewItem>
-#include <QtWidgets/QStyledItemDelegate>
 #include <QtWidgets/QWidget>
 
-class QListWidget;
-class QListWidgetItem;
-
-/**
- * @brief HTML-enabled list item delegate for the series list
- *
- * This delegate enables HTML formatting in list items
- */
-class HTMLListItem : public QStyledItemDelegate {
-public:
-    /**
-     * @brief Constructor
-     * @param parent Parent object
-     */
-    HTMLListItem(QObject* parent = nullptr)
-        : QStyledItemDelegate(parent)
-    {
-    }
-
-    /**
-     * @brief Paint the delegate with HTML support
-     * @param painter Painter to use
-     * @param option Style options
-     * @param index Model index
-     */
-    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override
-    {
-        QStyleOptionViewItem options = option;
-        initStyleOption(&options, index);
+#include <functional>
 
-        painter->save();
-
-        QTextDocument doc;
-        doc.setHtml(options.text);
-
-        options.text = "";
-        options.widget->style()->drawControl(QStyle::CE_ItemViewItem, &options, painter);
-
-        painter->translate(options.rect.left(), options.rect.top());
-        QRect clip(0, 0, options.rect.width(), options.rect.height());
-        doc.drawContents(painter, clip);
-
-        painter->restore();
-    }
-
-    /**
-     * @brief Get size hint for the item
-     * @param option Style options
-     * @param index Model index
-     * @return Suggested size
-     */
-    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override
-    {
-        return QSize(150, QStyledItemDelegate::sizeHint(option, index).height() * 1.5);
-    }
-};
+class QListView;
+class SeriesListModel;
 
 /**
  * @brief The ListChart class provides a chart with a list of series for easy toggling
@@ -239,6 +183,34 @@ public:
         m_chartview->setFontConfig(chartconfig);
     }
 
+    /**
+     * @brief Indices of the series groups
+     * @return Group indices as passed to addSeries()
+     */
+    inline QList<int> groups() const { return m_registry.groups(); }
+
+    /**
+     * @brief Series of a group
+     * @param index Group index
+     * @return All series added with that index
+     */
+    inline QList<QAbstractSeries*> groupSeries(int index) const { return m_registry.groupSeries(index); }
+
+    /**
+     * @brief Series groups with their names, colours and visibility
+     */
+    inline const SeriesRegistry& registry() const { return m_registry; }
+
+    /**
+     * @brief Groups accepted by a predicate, e.g. for setGroupsVisible()
+     * @param predicate Called once per group
+     * @return Group indices in the order they were added
+     */
+    inline QList<int> groupsWhere(const std::function<bool(const SeriesRegistry::Group&)>& predicate) const
+    {
+        return m_registry.groupsWhere(predicate);
+    }
+
     /**
      * @brief Add an export setting preset
      * @param name Name of the preset
@@ -269,25 +241,61 @@ public slots:
      */
     void hideSeries(int index);
 
+    /**
+     * @brief Show or hide all series of a group
+     * @param index Group index
+     * @param visible New visibility
+     */
+    void setGroupVisible(int index, bool visible);
+
+    /**
+     * @brief Show or hide several groups with a single repaint
+     * @param groups Group indices
+     * @param visible New visibility
+     */
+    void setGroupsVisible(const QList<int>& groups, bool visible);
+
+    /**
+     * @brief Recolour several groups with a single repaint
+     * @param groups Group indices
+     * @param color New color
+     */
+    void setGroupsColor(const QList<int>& groups, const QColor& color);
+
+    /**
+     * @brief Rename a group and its line and scatter series
+     * @param index Group index
+     * @param name New name
+     */
+    void renameGroup(int index, const QString& name);
+
 private:
-    QListWidget *m_list, *m_names_list;
+    QListView *m_list, *m_names_list;
+    SeriesListModel *m_model, *m_names_model;
     ChartView* m_chartview;
-    QMultiHash<int, QAbstractSeries*> m_series;
-    QHash<int, bool> m_hidden;
+    SeriesRegistry m_registry;
     QString m_name;
 
+    /**
+     * @brief Apply a change to several groups while the chart view does not repaint
+     */
+    void batchUpdate(const std::function<void()>& update);
+
+    void applyGroupVisible(int index, bool visible);
+    void applyGroupColor(int index, const QColor& color);
+
 private slots:
     /**
-     * @brief Handle click on series list item
-     * @param item Clicked item
+     * @brief Handle double click on a series list row
+     * @param index Clicked row
      */
-    inline void seriesListClicked(QListWidgetItem* item) { hideSeries(item->data(Qt::UserRole).toInt()); }
+    void seriesListClicked(const QModelIndex& index);
 
     /**
-     * @brief Handle click on names list item
-     * @param item Clicked item
+     * @brief Handle double click on a names list row
+     * @param index Clicked row
      */
-    void namesListClicked(QListWidgetItem* item);
+    void namesListClicked(const QModelIndex& index);
 
     /**
      * @brief Show context menu
@@ -307,10 +315,10 @@ private slots:
 
 signals:
     /**
-     * @brief Signal emitted when an item is double-clicked
-     * @param item The clicked item
+     * @brief Signal emitted when a series list row is double-clicked
+     * @param index The clicked row
      */
-    void itemDoubleClicked(QListWidgetItem* item);
+    void itemDoubleClicked(const QModelIndex& index);
 
     /**
      * @brief Signal emitted when last directory changes
@@ -0,0 +1,167 @@
+/*
+ * CuteCharts - Pre-rasterized scatter markers
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCore/QMutexLocker>
+
+#include <QtGui/QPainter>
+#include <QtGui/QPainterPath>
+
+#include <QtCharts/QScatterSeries>
+
+#include <cmath>
+#include <vector>
+
+#include "markeratlas.h"
+
+// Multiply all four channels of a premultiplied pixel by alpha / 255
+static inline uint byteMul(uint pixel, uint alpha)
+{
+    uint t = (pixel & 0xff00ff) * alpha;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+
+    pixel = ((pixel >> 8) & 0xff00ff) * alpha;
+    pixel = (pixel + ((pixel >> 8) & 0xff00ff) + 0x800080);
+    pixel &= 0xff00ff00;
+    return pixel | t;
+}
+
+MarkerAtlas& MarkerAtlas::instance()
+{
+    static MarkerAtlas atlas;
+    return atlas;
+}
+
+QImage MarkerAtlas::sprite(const Key& key)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_sprites.constFind(key);
+    if (it != m_sprites.constEnd())
+        return it.value();
+
+    QImage image = rasterize(key);
+    m_sprites.insert(key, image);
+    return image;
+}
+
+void MarkerAtlas::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_sprites.clear();
+}
+
+QImage MarkerAtlas::rasterize(const Key& key)
+{
+    const qreal size = key.size * key.devicePixelRatio;
+    const qreal border = key.borderWidth * key.devicePixelRatio;
+    // Odd edge length, so the marker center lies on a pixel center
+    const int edge = int(std::ceil(size + border)) | 1;
+
+    QImage image(edge, edge, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const QRectF rect(-size / 2.0, -size / 2.0, size, size);
+    QPainterPath path;
+    switch (key.shape) {
+    case QScatterSeries::MarkerShapeRectangle:
+        path.addRect(rect);
+        break;
+    case QScatterSeries::MarkerShapeRotatedRectangle:
+        path.moveTo(0, rect.top());
+        path.lineTo(rect.right(), 0);
+        path.lineTo(0, rect.bottom());
+        path.lineTo(rect.left(), 0);
+        path.closeSubpath();
+        break;
+    case QScatterSeries::MarkerShapeTriangle:
+        path.moveTo(0, rect.top());
+        path.lineTo(rect.right(), rect.bottom());
+        path.lineTo(rect.left(), rect.bottom());
+        path.closeSubpath();
+        break;
+    default:
+        path.addEllipse(rect);
+        break;
+    }
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.translate(edge / 2.0, edge / 2.0);
+    painter.setBrush(QColor::fromRgba(key.fill));
+    if (border > 0 && qAlpha(key.border) > 0)
+        painter.setPen(QPen(QColor::fromRgba(key.border), border));
+    else
+        painter.setPen(Qt::NoPen);
+    painter.drawPath(path);
+    painter.end();
+
+    return image;
+}
+
+void MarkerAtlas::stamp(QImage* target, const QImage& sprite, const QPoint* centers, qsizetype count)
+{
+    if (!target || target->isNull() || sprite.isNull() || count == 0)
+        return;
+
+    Q_ASSERT(target->format() == QImage::Format_ARGB32_Premultiplied);
+    Q_ASSERT(sprite.format() == QImage::Format_ARGB32_Premultiplied);
+
+    const int width = target->width();
+    const int height = target->height();
+    const int edge = sprite.width();
+    const int half = edge / 2;
+    const qsizetype stride = target->bytesPerLine() / sizeof(QRgb);
+    QRgb* bits = reinterpret_cast<QRgb*>(target->bits());
+    const QRgb* sprite_bits = reinterpret_cast<const QRgb*>(sprite.constBits());
+    const qsizetype sprite_stride = sprite.bytesPerLine() / sizeof(QRgb);
+
+    // One bit per target pixel, overplotted markers are blended only once
+    std::vector<bool> occupied(size_t(width) * size_t(height), false);
+
+    for (qsizetype i = 0; i < count; ++i) {
+        const int cx = centers[i].x();
+        const int cy = centers[i].y();
+        if (cx < -half || cy < -half || cx >= width + half || cy >= height + half)
+            continue;
+
+        if (cx >= 0 && cy >= 0 && cx < width && cy < height) {
+            const size_t pixel = size_t(cy) * size_t(width) + size_t(cx);
+            if (occupied[pixel])
+                continue;
+            occupied[pixel] = true;
+        }
+
+        const int x0 = qMax(0, cx - half);
+        const int x1 = qMin(width, cx - half + edge);
+        const int y0 = qMax(0, cy - half);
+        const int y1 = qMin(height, cy - half + edge);
+
+        for (int y = y0; y < y1; ++y) {
+            const QRgb* src = sprite_bits + (y - cy + half) * sprite_stride + (x0 - cx + half);
+            QRgb* dst = bits + y * stride + x0;
+            for (int x = x0; x < x1; ++x, ++src, ++dst) {
+                const uint alpha = qAlpha(*src);
+                if (alpha == 255)
+                    *dst = *src;
+                else if (alpha)
+                    *dst = *src + byteMul(*dst, 255 - alpha);
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * CuteCharts - Pre-rasterized scatter markers
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QPoint>
+
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+
+/**
+ * @brief Process wide cache of marker sprites
+ *
+ * Every combination of shape, size, fill, border and device pixel ratio is
+ * rasterized exactly once into a premultiplied ARGB32 image. Scatter layers
+ * are then built by stamping that sprite at integer pixel positions, which
+ * avoids the per marker pen and brush setup of QPainter. Images are used
+ * instead of pixmaps since the stamping runs on worker threads.
+ */
+class MarkerAtlas {
+public:
+    struct Key {
+        int shape = 0;
+        qreal size = 8;
+        QRgb fill = 0;
+        QRgb border = 0;
+        qreal borderWidth = 0;
+        qreal devicePixelRatio = 1;
+
+        bool operator==(const Key& other) const
+        {
+            return shape == other.shape && size == other.size && fill == other.fill && border == other.border
+                && borderWidth == other.borderWidth && devicePixelRatio == other.devicePixelRatio;
+        }
+    };
+
+    /**
+     * @brief Get the shared atlas instance
+     * @return The atlas
+     */
+    static MarkerAtlas& instance();
+
+    /**
+     * @brief Get the sprite for a marker, rasterizing it on first use
+     * @param key Marker description
+     * @return Premultiplied ARGB32 sprite, its center is the marker position
+     */
+    QImage sprite(const Key& key);
+
+    /**
+     * @brief Drop all sprites
+     */
+    void clear();
+
+    /**
+     * @brief Blend a sprite at many positions into an image
+     *
+     * Positions are sprite centers in target pixels. Each position is stamped
+     * once, even if several markers fall onto the same pixel.
+     * @param target Premultiplied ARGB32 image to draw into
+     * @param sprite Sprite returned by sprite()
+     * @param centers Marker centers
+     * @param count Number of centers
+     */
+    static void stamp(QImage* target, const QImage& sprite, const QPoint* centers, qsizetype count);
+
+private:
+    MarkerAtlas() = default;
+    static QImage rasterize(const Key& key);
+
+    QMutex m_mutex;
+    QHash<Key, QImage> m_sprites;
+};
+
+inline size_t qHash(const MarkerAtlas::Key& key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.shape, key.size, key.fill, key.border, key.borderWidth, key.devicePixelRatio);
+}
@@ -0,0 +1,202 @@
+/*
+ * CuteCharts - Vertical and horizontal marker lines drawn as one item
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QChart>
+
+#include <QtGui/QFontMetricsF>
+#include <QtGui/QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "markerlines.h"
+
+MarkerLines::MarkerLines(QChart* chart)
+    : QGraphicsItem(chart)
+    , m_chart(chart)
+{
+    m_pen.setWidth(2);
+    m_pen.setColor(Qt::darkGray);
+}
+
+bool MarkerLines::add(Qt::Orientation orientation, double position)
+{
+    QVector<double>& lines = orientation == Qt::Vertical ? m_vertical : m_horizontal;
+    auto it = std::lower_bound(lines.begin(), lines.end(), position);
+    if (it != lines.end() && *it == position)
+        return false;
+    lines.insert(it, position);
+    invalidate();
+    return true;
+}
+
+bool MarkerLines::remove(Qt::Orientation orientation, double position)
+{
+    QVector<double>& lines = orientation == Qt::Vertical ? m_vertical : m_horizontal;
+    auto it = std::lower_bound(lines.begin(), lines.end(), position);
+    if (it == lines.end() || *it != position)
+        return false;
+    lines.erase(it);
+    invalidate();
+    return true;
+}
+
+void MarkerLines::clear(Qt::Orientation orientation)
+{
+    QVector<double>& lines = orientation == Qt::Vertical ? m_vertical : m_horizontal;
+    if (lines.isEmpty())
+        return;
+    lines.clear();
+    invalidate();
+}
+
+void MarkerLines::setPrecision(Qt::Orientation orientation, int precision)
+{
+    if (orientation == Qt::Vertical)
+        m_vertical_prec = precision;
+    else
+        m_horizontal_prec = precision;
+    invalidate();
+}
+
+void MarkerLines::setTransform(Qt::Orientation orientation, const AxisTransform& transform)
+{
+    if (orientation == Qt::Vertical)
+        m_x_transform = transform;
+    else
+        m_y_transform = transform;
+    invalidate();
+}
+
+void MarkerLines::updateGeometry(double xMin, double xMax, double yMin, double yMax)
+{
+    m_x_min = xMin;
+    m_x_max = xMax;
+    m_y_min = yMin;
+    m_y_max = yMax;
+
+    // The bounds follow the chart, which may just have been resized
+    prepareGeometryChange();
+    invalidate();
+}
+
+void MarkerLines::rebuild()
+{
+    m_dirty = false;
+    m_path = QPainterPath();
+    m_labels.clear();
+    const double xMin = m_x_min, xMax = m_x_max, yMin = m_y_min, yMax = m_y_max;
+    if (!m_chart || xMax <= xMin || yMax <= yMin)
+        return;
+
+    // Value axes map linearly, two corners give the whole transform
+    const QPointF origin = m_chart->mapToPosition(QPointF(xMin, yMin));
+    const QPointF corner = m_chart->mapToPosition(QPointF(xMax, yMax));
+    const double sx = (corner.x() - origin.x()) / (xMax - xMin);
+    const double sy = (corner.y() - origin.y()) / (yMax - yMin);
+    auto mapX = [&](double x) { return origin.x() + (x - xMin) * sx; };
+    auto mapY = [&](double y) { return origin.y() + (y - yMin) * sy; };
+
+    const QFontMetricsF metrics(m_font);
+    const qreal height = metrics.height();
+
+    // Only the lines inside the visible range are touched, positions are data values
+    auto first = std::lower_bound(m_vertical.cbegin(), m_vertical.cend(), m_x_transform.unmap(xMin));
+    auto last = std::upper_bound(first, m_vertical.cend(), m_x_transform.unmap(xMax));
+    const qreal top = mapY(0.95 * yMax), bottom = mapY(yMin), labelTop = mapY(0.99 * yMax) - height;
+    qreal free = -std::numeric_limits<qreal>::infinity();
+    for (auto it = first; it != last; ++it) {
+        const qreal x = mapX(m_x_transform.map(*it));
+        if (!std::isfinite(x))
+            continue;
+        m_path.moveTo(x, bottom);
+        m_path.lineTo(x, top);
+        if (m_vertical_prec < 0)
+            continue;
+        // Labels run left to right, one that would touch its predecessor is left out
+        if (x + 2 < free)
+            continue;
+        const QString text = QString::number(*it, 'f', m_vertical_prec);
+        m_labels.append(Label{ QPointF(x + 2, labelTop), text });
+        free = x + 2 + staticText(text).size().width() + 4;
+    }
+
+    first = std::lower_bound(m_horizontal.cbegin(), m_horizontal.cend(), m_y_transform.unmap(yMin));
+    last = std::upper_bound(first, m_horizontal.cend(), m_y_transform.unmap(yMax));
+    const qreal left = mapX(xMin), right = mapX(0.95 * xMax);
+    free = std::numeric_limits<qreal>::infinity();
+    for (auto it = first; it != last; ++it) {
+        const qreal y = mapY(m_y_transform.map(*it));
+        if (!std::isfinite(y))
+            continue;
+        m_path.moveTo(left, y);
+        m_path.lineTo(right, y);
+        if (m_horizontal_prec < 0)
+            continue;
+        // Increasing values go up the screen, labels are checked bottom to top
+        const QString text = QString::number(*it, 'f', m_horizontal_prec);
+        const qreal labelY = y - height / 2;
+        if (labelY + height > free)
+            continue;
+        m_labels.append(Label{ QPointF(left - staticText(text).size().width() - 4, labelY), text });
+        free = labelY - 2;
+    }
+}
+
+QRectF MarkerLines::boundingRect() const
+{
+    // Lines and labels never leave the chart; tight bounds would need the rebuild before painting
+    return m_chart ? m_chart->boundingRect() : QRectF();
+}
+
+void MarkerLines::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+    if (m_dirty)
+        rebuild();
+    if (m_path.isEmpty())
+        return;
+
+    painter->save();
+    painter->setPen(m_pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(m_path);
+
+    painter->setFont(m_font);
+    painter->setPen(Qt::black);
+    for (const Label& label : qAsConst(m_labels))
+        painter->drawStaticText(label.position, staticText(label.text));
+    painter->restore();
+}
+
+const QStaticText& MarkerLines::staticText(const QString& text) const
+{
+    auto it = m_texts.constFind(text);
+    if (it != m_texts.cend())
+        return it.value();
+
+    if (m_texts.size() > 4096)
+        m_texts.clear();
+    QStaticText prepared(text);
+    prepared.setTextFormat(Qt::PlainText);
+    prepared.prepare(QTransform(), m_font);
+    return m_texts.insert(text, prepared).value();
+}
@@ -0,0 +1,136 @@
+/*
+ * CuteCharts - Vertical and horizontal marker lines drawn as one item
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+
+#include <QtGui/QFont>
+#include <QtGui/QPainterPath>
+#include <QtGui/QPen>
+#include <QtGui/QStaticText>
+
+#include <QtWidgets/QGraphicsItem>
+
+#include "axistransform.h"
+
+class QChart;
+
+/**
+ * @brief Marker lines of a chart in sorted vectors, painted as one path
+ *
+ * Positions are kept sorted and unique, so lookups are binary searches and
+ * an update only touches the lines inside the visible range, found by two
+ * more binary searches. Changes only mark the item dirty; the path of all
+ * visible lines is rebuilt once in the next paint, so adding many lines costs
+ * one rebuild. Labels are dropped where they would overlap the previous label
+ * along the axis, their widths come from the cached static texts.
+ * Positions are data values; on a transformed axis they are mapped when the
+ * path is built.
+ */
+class MarkerLines : public QGraphicsItem {
+public:
+    /**
+     * @brief Constructor
+     * @param chart Chart to draw on, becomes the parent item
+     */
+    explicit MarkerLines(QChart* chart);
+
+    /**
+     * @brief Add a line
+     * @param orientation Qt::Vertical for a line at an x position
+     * @param position Axis value
+     * @return False if there already is a line at that position
+     */
+    bool add(Qt::Orientation orientation, double position);
+
+    /**
+     * @brief Remove the line at a position
+     * @return True if there was one
+     */
+    bool remove(Qt::Orientation orientation, double position);
+
+    void clear(Qt::Orientation orientation);
+
+    /**
+     * @brief Sorted positions of the lines
+     */
+    inline const QVector<double>& positions(Qt::Orientation orientation) const
+    {
+        return orientation == Qt::Vertical ? m_vertical : m_horizontal;
+    }
+
+    /**
+     * @brief Decimals of the labels, -1 hides them
+     */
+    void setPrecision(Qt::Orientation orientation, int precision);
+
+    /**
+     * @brief Transform of the axis the lines of an orientation are placed on
+     * @param orientation Qt::Vertical for the x axis
+     */
+    void setTransform(Qt::Orientation orientation, const AxisTransform& transform);
+
+    /**
+     * @brief Set the visible value range, the path follows in the next paint
+     */
+    void updateGeometry(double xMin, double xMax, double yMin, double yMax);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    struct Label {
+        QPointF position;
+        QString text;
+    };
+
+    /**
+     * @brief Cached layout of a label text
+     */
+    const QStaticText& staticText(const QString& text) const;
+
+    /**
+     * @brief Rebuild the path and labels in the next paint
+     */
+    inline void invalidate()
+    {
+        m_dirty = true;
+        update();
+    }
+
+    /**
+     * @brief Build path and labels for the last value range
+     */
+    void rebuild();
+
+    QPointer<QChart> m_chart;
+    QVector<double> m_vertical, m_horizontal;
+    QPainterPath m_path;
+    QVector<Label> m_labels;
+    QPen m_pen;
+    QFont m_font;
+    AxisTransform m_x_transform, m_y_transform;
+    mutable QHash<QString, QStaticText> m_texts;
+    double m_x_min = 0, m_x_max = 0, m_y_min = 0, m_y_max = 0;
+    int m_vertical_prec = 2, m_horizontal_prec = 2;
+    bool m_dirty = false;
+};
@@ -0,0 +1,85 @@
+/*
+ * CuteCharts - Parallel helpers used by the render and statistics code
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtGlobal>
+
+namespace ChartTools {
+
+/**
+ * @brief Number of workers ParallelFor will use at most
+ * @return Thread count of the global pool plus the calling thread
+ */
+inline int WorkerCount()
+{
+    return qMax(1, QThreadPool::globalInstance()->maxThreadCount()) + 1;
+}
+
+/**
+ * @brief Split [0, size) into contiguous chunks and process them in parallel
+ *
+ * The calling thread always works on the first chunk. Further chunks are handed
+ * to the global thread pool only if a thread is idle, otherwise they are run
+ * inline, so nested calls from pool threads can never deadlock.
+ *
+ * @param size Number of elements
+ * @param function Callable as function(begin, end, worker); worker is unique per chunk
+ *        and smaller than WorkerCount(), which makes it usable as index into per-thread buffers
+ * @param minChunk Smallest chunk that is worth a thread of its own
+ */
+template <typename Function>
+inline void ParallelFor(qsizetype size, Function&& function, qsizetype minChunk = 4096)
+{
+    if (size <= 0)
+        return;
+
+    const qsizetype wanted = size / qMax<qsizetype>(1, minChunk);
+    const int workers = int(qBound<qsizetype>(1, wanted, WorkerCount()));
+    if (workers == 1) {
+        function(qsizetype(0), size, 0);
+        return;
+    }
+
+    const qsizetype chunk = (size + workers - 1) / workers;
+    QSemaphore done;
+    int started = 0;
+
+    for (int worker = 1; worker < workers; ++worker) {
+        const qsizetype begin = worker * chunk;
+        const qsizetype end = qMin(size, begin + chunk);
+        if (begin >= end)
+            break;
+
+        bool queued = QThreadPool::globalInstance()->tryStart([&function, &done, begin, end, worker]() {
+            function(begin, end, worker);
+            done.release();
+        });
+        if (queued)
+            ++started;
+        else
+            function(begin, end, worker);
+    }
+    function(qsizetype(0), qMin(size, chunk), 0);
+    done.acquire(started);
+}
+
+} // namespace ChartTools
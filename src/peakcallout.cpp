@@ -17,9 +17,9 @@
  */
 
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
 #include <QtCore/QPointer>
 
-#include <QtGui/QFontMetrics>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QPainter>
 #include <QtGui/QTextDocument>
@@ -31,6 +31,29 @@
 
 #include "peakcallout.h"
 
+namespace {
+/**
+ * @brief Laid out size of a callout text, shared by all callouts
+ *
+ * The key carries text, colour and font, so a callout only asks its
+ * document for a layout the first time a combination shows up.
+ */
+QSizeF textSize(const QString& html, const QString& font, QTextDocument* document)
+{
+    static QHash<QString, QSizeF> cache;
+    const QString key = font + QLatin1Char('\n') + html;
+    auto it = cache.constFind(key);
+    if (it != cache.cend())
+        return it.value();
+
+    if (cache.size() > 4096)
+        cache.clear();
+    const QSizeF size = document->size();
+    cache.insert(key, size);
+    return size;
+}
+}
+
 PeakCallOut::PeakCallOut(QPointer<QChart> chart)
     : QGraphicsTextItem(chart)
     , m_chart(chart)
@@ -60,37 +83,20 @@ QRectF PeakCallOut::boundingRect() const
 
 void PeakCallOut::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-    // Calculate positioning based on available space
-    int width = 40;
-    int height = -100;
-
-    if (!m_rotated) {
-        QFontMetrics fm = painter->fontMetrics();
-        width = fm.horizontalAdvance(m_text) - fm.horizontalAdvance(m_text) / 2;
-        height = -50;
-    }
-
-    // Position callout relative to anchor point
-    QPointF anchorPos = m_chart->mapToPosition(m_anchor);
-    qreal x = anchorPos.x() - width;
-    qreal y = anchorPos.y() - height - 50;
-    setPos(x, y);
-
-    // Draw connection line to anchor point
+    // Dashed line from the nearest edge of the label to the anchor point
+    QPointF anchor = mapFromParent(m_chart->mapToPosition(m_anchor));
+    QPointF edge(qBound(m_textRect.left(), anchor.x(), m_textRect.right()),
+        qBound(m_textRect.top(), anchor.y(), m_textRect.bottom()));
     painter->setPen(QPen(m_color, 1.5, Qt::DashLine));
-    painter->drawLine(QPointF(width, height + 40), mapFromParent(anchorPos));
+    painter->drawLine(edge, anchor);
 
     // Draw text with background
     painter->setPen(QPen(QColor(60, 60, 60), 1));
     painter->setBrush(QBrush(QColor(240, 240, 240, 220)));
-    painter->drawRoundedRect(boundingRect().adjusted(5, 5, -5, -5), 5, 5);
+    painter->drawRoundedRect(m_textRect, 5, 5);
 
     // Let the base class handle text rendering
     QGraphicsTextItem::paint(painter, option, widget);
-
-    // Hide callout if associated series is hidden
-    if (m_series)
-        setVisible(m_series->isVisible());
 }
 
 void PeakCallOut::setColor(const QColor& color)
@@ -109,6 +115,9 @@ void PeakCallOut::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
 {
     if (event->buttons() & Qt::LeftButton) {
         setPos(mapToParent(event->pos() - event->buttonDownPos(Qt::LeftButton)));
+        // CalloutLayout leaves moved labels where the user put them
+        m_pinned = true;
+        m_pin_offset = pos() - m_chart->mapToPosition(m_anchor);
         event->accept();
     } else {
         event->ignore();
@@ -124,18 +133,24 @@ void PeakCallOut::setText(const QString& text, const QPointF& point)
 
 void PeakCallOut::update()
 {
-    m_htmlText = tr("<h4><font color='%2'>%1</font></h4>").arg(m_text).arg(m_color.name());
+    const QString html = tr("<h4><font color='%2'>%1</font></h4>").arg(m_text).arg(m_color.name());
+    const QString font = this->font().toString();
+    if (html == m_htmlText && font == m_font) {
+        QGraphicsTextItem::update();
+        return;
+    }
+
+    m_htmlText = html;
+    m_font = font;
     setHtml(m_htmlText);
 
-    QFontMetrics metrics(font());
-    QTextDocument doc;
-    doc.setHtml(m_htmlText);
-    m_textRect = metrics.boundingRect(QRect(0, 0, 300, 300), Qt::AlignLeft, m_htmlText);
+    const QSizeF size = textSize(m_htmlText, m_font, document());
     prepareGeometryChange();
+    m_textRect = QRectF(QPointF(0, 0), size);
     m_rect = m_textRect.adjusted(-5, -5, 5, 5);
 
     // Rotate text for better readability with longer texts
-    if (doc.size().width() > 60) {
+    if (size.width() > 60) {
         setRotation(-90);
         m_rotated = true;
     } else {
@@ -144,6 +159,17 @@ void PeakCallOut::update()
     }
 }
 
+QSizeF PeakCallOut::labelSize() const
+{
+    return m_rotated ? m_textRect.size().transposed() : m_textRect.size();
+}
+
+void PeakCallOut::placeLabel(const QRectF& rect)
+{
+    // Rotated by -90 degrees the text runs upwards from its origin
+    setPos(m_rotated ? rect.bottomLeft() : rect.topLeft());
+}
+
 void PeakCallOut::setAnchor(QPointF point)
 {
     m_anchor = point;
@@ -35,7 +35,8 @@ class QGraphicsSceneMouseEvent;
  *
  * This class allows for creating text annotations that point to specific data points
  * in a chart. The callouts can be moved by the user and will follow their associated
- * data points if the chart is zoomed or panned.
+ * data points if the chart is zoomed or panned. Where the label goes is decided
+ * by CalloutLayout; a label moved by the user keeps its offset to the anchor.
  */
 class PeakCallOut : public QGraphicsTextItem {
 public:
@@ -81,13 +82,55 @@ public:
      */
     void setSeries(const QPointer<QAbstractSeries> serie) { m_series = serie; }
 
+    /**
+     * @brief Series this callout is associated with
+     * @return The series, nullptr if there is none
+     */
+    QAbstractSeries* series() const { return m_series; }
+
     /**
      * @brief Update the callout's appearance
      *
-     * This should be called after changing properties like color or text.
+     * This should be called after changing properties like color, font or text.
+     * The HTML is only rebuilt if one of them changed.
      */
     void update();
 
+    inline QPointF anchor() const { return m_anchor; }
+    inline QString text() const { return m_text; }
+
+    /**
+     * @brief Size of the label in chart coordinates, rotation included
+     */
+    QSizeF labelSize() const;
+
+    /**
+     * @brief Current label rectangle in chart coordinates
+     */
+    inline QRectF labelRect() const { return mapRectToParent(m_textRect); }
+
+    /**
+     * @brief Move the label into a rectangle of labelSize()
+     * @param rect Target in chart coordinates
+     */
+    void placeLabel(const QRectF& rect);
+
+    /**
+     * @brief Whether the user has moved the label
+     */
+    inline bool isPinned() const { return m_pinned; }
+
+    /**
+     * @brief Offset of a moved label to its anchor in chart coordinates
+     */
+    inline QPointF pinnedOffset() const { return m_pin_offset; }
+
+    /**
+     * @brief Labels with a higher priority are placed first
+     */
+    inline void setPriority(qreal priority) { m_priority = priority; }
+    inline qreal priority() const { return m_priority; }
+
 public slots:
     /**
      * @brief Set the color of the callout text
@@ -105,10 +148,13 @@ private:
     QRectF m_textRect; ///< Rectangle for the text portion
     QRectF m_rect; ///< Total rectangle including text and anchor line
     QPointF m_anchor; ///< The point this callout is anchored to
-    QPointF m_textPosition; ///< The position of the text relative to anchor
     QPointer<QChart> m_chart; ///< The chart this callout belongs to
     bool m_rotated = false; ///< Whether this callout is rotated 90 degrees
     QColor m_color; ///< The color of the callout text
+    QString m_font; ///< Font the current HTML was laid out with
+    bool m_pinned = false; ///< Whether the user has moved the label
+    QPointF m_pin_offset; ///< Label position relative to the anchor once pinned
+    qreal m_priority = 0;
 
     QPointer<QAbstractSeries> m_series; ///< The series this callout is associated with
 };
@@ -0,0 +1,351 @@
+/*
+ * CuteCharts - Peak detection for line series
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QXYSeries>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+#include "series.h"
+
+#include "peakpicker.h"
+
+namespace {
+/**
+ * @brief Lowest value between every point and the next higher point in one direction
+ *
+ * The stack holds the points still waiting for a higher successor together
+ * with the minimum seen after each of them, so every point is pushed and
+ * popped once.
+ */
+void bases(const std::vector<double>& y, bool forward, std::vector<double>& base)
+{
+    struct Item {
+        double value;
+        double minAfter;
+    };
+    std::vector<Item> stack;
+    const double infinity = std::numeric_limits<double>::infinity();
+    double lowest = infinity;
+    const qsizetype n = qsizetype(y.size());
+
+    for (qsizetype k = 0; k < n; ++k) {
+        const qsizetype i = forward ? k : n - 1 - k;
+        const double value = y[i];
+        lowest = std::min(lowest, value);
+
+        double minimum = value;
+        while (!stack.empty() && stack.back().value <= value) {
+            minimum = std::min({ minimum, stack.back().value, stack.back().minAfter });
+            stack.pop_back();
+        }
+        if (stack.empty()) {
+            base[i] = lowest;
+        } else {
+            stack.back().minAfter = std::min(stack.back().minAfter, minimum);
+            base[i] = stack.back().minAfter;
+        }
+        stack.push_back({ value, infinity });
+    }
+}
+
+/**
+ * @brief x where the line between two points crosses a height
+ */
+double crossing(double x0, double y0, double x1, double y1, double height)
+{
+    if (y1 == y0)
+        return x0;
+    return x0 + (height - y0) * (x1 - x0) / (y1 - y0);
+}
+
+/**
+ * @brief Search finite values, source maps them back to the indices of the input
+ */
+QVector<Peak> search(const std::vector<double>& x, const std::vector<double>& y, const std::vector<qsizetype>& source,
+    const PeakPicker::Options& options)
+{
+    QVector<Peak> result;
+    const qsizetype n = qsizetype(y.size());
+    if (n < 3)
+        return result;
+
+    // Centred moving average through prefix sums
+    std::vector<double> smooth;
+    const std::vector<double>* signal = &y;
+    if (options.smoothing > 0) {
+        std::vector<double> sum(n + 1, 0.0);
+        for (qsizetype i = 0; i < n; ++i)
+            sum[i + 1] = sum[i] + y[i];
+        smooth.resize(n);
+        for (qsizetype i = 0; i < n; ++i) {
+            const qsizetype first = qMax<qsizetype>(0, i - options.smoothing);
+            const qsizetype last = qMin<qsizetype>(n - 1, i + options.smoothing);
+            smooth[i] = (sum[last + 1] - sum[first]) / double(last - first + 1);
+        }
+        signal = &smooth;
+    }
+    const std::vector<double>& s = *signal;
+
+    const auto range = std::minmax_element(s.begin(), s.end());
+    const double threshold = qMax(options.minProminence, options.relativeProminence * (*range.second - *range.first));
+
+    std::vector<double> left(n), right(n);
+    bases(s, true, left);
+    bases(s, false, right);
+
+    for (qsizetype i = 1; i < n - 1; ++i) {
+        if (!(s[i] > s[i - 1]))
+            continue;
+
+        // A plateau counts once, at its middle
+        qsizetype end = i;
+        while (end + 1 < n && s[end + 1] == s[i])
+            ++end;
+        if (end + 1 >= n || s[end + 1] > s[i]) {
+            i = end;
+            continue;
+        }
+        const qsizetype peak = (i + end) / 2;
+        i = end;
+
+        const double prominence = s[peak] - std::max(left[peak], right[peak]);
+        if (prominence < threshold || prominence <= 0)
+            continue;
+
+        // Width at half prominence, the walk stops before the bases
+        const double height = s[peak] - prominence / 2.0;
+        qsizetype l = peak;
+        while (l > 0 && s[l - 1] > height)
+            --l;
+        qsizetype r = peak;
+        while (r < n - 1 && s[r + 1] > height)
+            ++r;
+        const double xLeft = l > 0 ? crossing(x[l - 1], s[l - 1], x[l], s[l], height) : x[0];
+        const double xRight = r < n - 1 ? crossing(x[r + 1], s[r + 1], x[r], s[r], height) : x[n - 1];
+        const double width = std::abs(xRight - xLeft);
+        if (width < options.minWidth)
+            continue;
+
+        // The label belongs on the highest raw point, not on the smoothed one
+        qsizetype top = peak;
+        if (options.smoothing > 0) {
+            const qsizetype first = qMax<qsizetype>(0, peak - options.smoothing);
+            const qsizetype last = qMin<qsizetype>(n - 1, peak + options.smoothing);
+            for (qsizetype j = first; j <= last; ++j) {
+                if (y[j] > y[top])
+                    top = j;
+            }
+        }
+
+        Peak found;
+        found.index = source[top];
+        found.position = QPointF(x[top], y[top]);
+        found.prominence = prominence;
+        found.width = width;
+        result.append(found);
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const Peak& a, const Peak& b) {
+        return a.prominence > b.prominence;
+    });
+    if (options.maxPeaks > 0 && result.size() > options.maxPeaks)
+        result.resize(options.maxPeaks);
+    return result;
+}
+}
+
+PeakPicker::PeakPicker(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &PeakPicker::update);
+}
+
+QVector<Peak> PeakPicker::find(const QList<QPointF>& points, const Options& options)
+{
+    // Non finite values would act as bottomless bases, they are left out
+    std::vector<double> x, y;
+    std::vector<qsizetype> source;
+    x.reserve(points.size());
+    y.reserve(points.size());
+    source.reserve(points.size());
+    for (qsizetype i = 0; i < points.size(); ++i) {
+        const QPointF& point = points[i];
+        if (!std::isfinite(point.x()) || !std::isfinite(point.y()))
+            continue;
+        x.push_back(point.x());
+        y.push_back(point.y());
+        source.push_back(i);
+    }
+    return search(x, y, source, options);
+}
+
+QVector<Peak> PeakPicker::find(const SampleStore& samples, const AxisTransform& xTransform, const AxisTransform& yTransform, const Options& options)
+{
+    // Samples are mapped one at a time, no point list of the whole store is built
+    std::vector<double> x, y;
+    std::vector<qsizetype> source;
+    x.reserve(samples.size());
+    y.reserve(samples.size());
+    source.reserve(samples.size());
+    for (qsizetype i = 0; i < samples.size(); ++i) {
+        const double mappedX = xTransform.map(samples.x(i));
+        const double mappedY = yTransform.map(samples.y(i));
+        if (!std::isfinite(mappedX) || !std::isfinite(mappedY))
+            continue;
+        x.push_back(mappedX);
+        y.push_back(mappedY);
+        source.push_back(i);
+    }
+    return search(x, y, source, options);
+}
+
+void PeakPicker::setOptions(const Options& options)
+{
+    m_options = options;
+    for (Entry& entry : m_entries)
+        entry.dirty = true;
+    if (!m_entries.isEmpty())
+        m_timer.start();
+}
+
+void PeakPicker::setAxisTransforms(const AxisTransform& x, const AxisTransform& y)
+{
+    m_x_transform = x;
+    m_y_transform = y;
+    // Other series see their mapped points replaced anyway
+    for (Entry& entry : m_entries) {
+        const LineSeries* line = qobject_cast<const LineSeries*>(entry.series.data());
+        if (line && line->hasCompactStorage())
+            invalidate(line);
+    }
+}
+
+void PeakPicker::addSeries(QXYSeries* series)
+{
+    if (!series || m_entries.contains(series))
+        return;
+
+    Entry entry;
+    entry.series = series;
+    m_entries.insert(series, entry);
+
+    // The points of compact storage follow the view, the data only changes with the samples
+    connect(series, &QXYSeries::pointsReplaced, this, [this, series]() {
+        const LineSeries* line = qobject_cast<const LineSeries*>(series);
+        if (!line || !line->hasCompactStorage())
+            invalidate(series);
+    });
+    if (LineSeries* line = qobject_cast<LineSeries*>(series))
+        connect(line, &LineSeries::samplesChanged, this, [this, series]() { invalidate(series); });
+    connect(series, &QXYSeries::pointAdded, this, [this, series]() { invalidate(series); });
+    connect(series, &QXYSeries::pointReplaced, this, [this, series]() { invalidate(series); });
+    connect(series, &QXYSeries::pointRemoved, this, [this, series]() { invalidate(series); });
+    connect(series, &QXYSeries::pointsRemoved, this, [this, series]() { invalidate(series); });
+    connect(series, &QObject::destroyed, this, [this, series]() { m_entries.remove(series); });
+    m_timer.start();
+}
+
+void PeakPicker::removeSeries(const QXYSeries* series)
+{
+    if (!m_entries.remove(series))
+        return;
+    disconnect(series, nullptr, this, nullptr);
+}
+
+void PeakPicker::clear()
+{
+    for (const Entry& entry : qAsConst(m_entries)) {
+        if (entry.series)
+            disconnect(entry.series, nullptr, this, nullptr);
+    }
+    m_entries.clear();
+}
+
+QList<QXYSeries*> PeakPicker::series() const
+{
+    QList<QXYSeries*> result;
+    for (const Entry& entry : m_entries) {
+        if (entry.series)
+            result.append(entry.series);
+    }
+    return result;
+}
+
+QVector<Peak> PeakPicker::peaks(const QXYSeries* series) const
+{
+    auto it = m_entries.constFind(series);
+    return it == m_entries.cend() ? QVector<Peak>() : it->peaks;
+}
+
+void PeakPicker::update()
+{
+    m_timer.stop();
+
+    // Series are not thread safe, their points and samples are shared copies taken here
+    QVector<QXYSeries*> pending;
+    QVector<QList<QPointF>> points;
+    QVector<SampleStore> samples;
+    QVector<bool> compact;
+    for (Entry& entry : m_entries) {
+        if (!entry.dirty || !entry.series)
+            continue;
+        entry.dirty = false;
+        pending.append(entry.series);
+        const LineSeries* line = qobject_cast<const LineSeries*>(entry.series.data());
+        const bool isCompact = line && line->hasCompactStorage();
+        compact.append(isCompact);
+        points.append(isCompact ? QList<QPointF>() : entry.series->points());
+        samples.append(isCompact ? line->samples() : SampleStore());
+    }
+    if (pending.isEmpty())
+        return;
+
+    QVector<QVector<Peak>> results(pending.size());
+    const Options options = m_options;
+    const AxisTransform xTransform = m_x_transform, yTransform = m_y_transform;
+    ChartTools::ParallelFor(pending.size(), [&](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            results[i] = compact[i] ? find(samples[i], xTransform, yTransform, options) : find(points[i], options);
+    },
+        1);
+
+    for (int i = 0; i < pending.size(); ++i) {
+        auto it = m_entries.find(pending[i]);
+        if (it == m_entries.end())
+            continue;
+        it->peaks = results[i];
+        emit peaksChanged(pending[i]);
+    }
+}
+
+void PeakPicker::invalidate(const QXYSeries* series)
+{
+    auto it = m_entries.find(series);
+    if (it == m_entries.end())
+        return;
+    it->dirty = true;
+    if (!m_timer.isActive())
+        m_timer.start();
+}
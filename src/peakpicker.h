@@ -0,0 +1,152 @@
+/*
+ * CuteCharts - Peak detection for line series
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include "axistransform.h"
+#include "samplestore.h"
+
+class QXYSeries;
+
+/**
+ * @brief A local maximum of a series
+ */
+struct Peak {
+    qsizetype index = 0; ///< Index of the maximum in the series, in its samples for compact storage
+    QPointF position; ///< Point of the series at the maximum, not smoothed
+    qreal prominence = 0; ///< Height above the higher of the two bases
+    qreal width = 0; ///< Width at half prominence in x units
+};
+
+/**
+ * @brief Finds peaks by prominence and width and keeps them until the data changes
+ *
+ * Prominence follows the usual definition: the base on each side is the lowest
+ * point between the peak and the next higher point on that side (or the end of
+ * the data), and the prominence is the height above the higher base. Both bases
+ * come from one pass per direction with a monotonic stack, so a series costs
+ * O(n) regardless of the number of peaks. Widths are measured at half
+ * prominence with linear interpolation.
+ *
+ * Watched series are searched again after their points change; all series
+ * waiting for an update are searched in parallel, one series per worker.
+ * A LineSeries in compact storage only holds the decimated points of the view,
+ * which change with every pan; it is searched in all of its samples, each
+ * mapped through the axis transforms as it is read, and only again when the
+ * samples change.
+ */
+class PeakPicker : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        qreal minProminence = 0; ///< Absolute prominence threshold
+        qreal relativeProminence = 0.05; ///< Threshold as fraction of the y range, the larger threshold wins
+        qreal minWidth = 0; ///< Minimum width at half prominence in x units
+        int smoothing = 0; ///< Half window of a moving average applied before the search, 0 disables it
+        int maxPeaks = 0; ///< Keep only the most prominent peaks, 0 keeps all
+    };
+
+    explicit PeakPicker(QObject* parent = nullptr);
+
+    /**
+     * @brief Search points for peaks
+     *
+     * Safe to call from any thread.
+     * @param points Points ordered by x
+     * @param options Search options
+     * @return Peaks sorted by descending prominence
+     */
+    static QVector<Peak> find(const QList<QPointF>& points, const Options& options);
+
+    /**
+     * @brief Search samples for peaks, mapping each sample through the transforms
+     *
+     * Safe to call from any thread. Peak::index refers to the samples.
+     * @param samples Samples ordered by x
+     * @param xTransform Transform of the x axis
+     * @param yTransform Transform of the y axis
+     * @param options Search options
+     * @return Peaks sorted by descending prominence
+     */
+    static QVector<Peak> find(const SampleStore& samples, const AxisTransform& xTransform, const AxisTransform& yTransform, const Options& options);
+
+    void setOptions(const Options& options);
+    inline const Options& options() const { return m_options; }
+
+    /**
+     * @brief Transforms the samples of compact series are mapped with, as their points are
+     */
+    void setAxisTransforms(const AxisTransform& x, const AxisTransform& y);
+
+    /**
+     * @brief Watch a series and search it with the next update
+     */
+    void addSeries(QXYSeries* series);
+    void removeSeries(const QXYSeries* series);
+    void clear();
+
+    inline bool contains(const QXYSeries* series) const { return m_entries.contains(series); }
+
+    /**
+     * @brief Series currently watched
+     */
+    QList<QXYSeries*> series() const;
+
+    /**
+     * @brief Cached peaks of a series, sorted by descending prominence
+     *
+     * Empty until the first update after the series was added or changed.
+     */
+    QVector<Peak> peaks(const QXYSeries* series) const;
+
+public slots:
+    /**
+     * @brief Search all series whose points changed since the last update
+     */
+    void update();
+
+signals:
+    /**
+     * @brief New peaks are available for a series
+     */
+    void peaksChanged(QXYSeries* series);
+
+private:
+    struct Entry {
+        QPointer<QXYSeries> series;
+        QVector<Peak> peaks;
+        bool dirty = true;
+    };
+
+    void invalidate(const QXYSeries* series);
+
+    QHash<const QXYSeries*, Entry> m_entries;
+    Options m_options;
+    AxisTransform m_x_transform, m_y_transform;
+    QTimer m_timer;
+};
@@ -0,0 +1,409 @@
+/*
+ * CuteCharts - Background render pipeline for chart series
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCore/QMetaObject>
+
+#include <QtGui/QPainter>
+
+#include <QtCharts/QLineSeries>
+#include <QtCharts/QScatterSeries>
+
+#include <cmath>
+
+#include "densitymap.h"
+#include "markeratlas.h"
+#include "parallel.h"
+#include "series.h"
+
+#include "renderpipeline.h"
+
+std::optional<SeriesSnapshot> SeriesSnapshot::fromSeries(QAbstractSeries* series)
+{
+    SeriesSnapshot snapshot;
+    snapshot.key = reinterpret_cast<quintptr>(series);
+
+    if (auto density = qobject_cast<ScatterSeries*>(series); density && density->densityMode()) {
+        snapshot.kind = Kind::Density;
+        snapshot.points = density->points();
+        snapshot.colorMap = static_cast<int>(density->colorMap());
+        snapshot.logDensity = density->logDensity();
+        return snapshot;
+    }
+    if (auto scatter = qobject_cast<QScatterSeries*>(series)) {
+        snapshot.kind = Kind::Scatter;
+        snapshot.points = scatter->points();
+        snapshot.color = scatter->color();
+        snapshot.pen = scatter->pen();
+        snapshot.borderColor = scatter->borderColor();
+        snapshot.markerSize = scatter->markerSize();
+        snapshot.markerShape = scatter->markerShape();
+        return snapshot;
+    }
+    if (auto line = qobject_cast<QLineSeries*>(series)) {
+        snapshot.kind = Kind::Line;
+        snapshot.points = line->points();
+        snapshot.pen = line->pen();
+        snapshot.color = line->color();
+        return snapshot;
+    }
+    return std::nullopt;
+}
+
+RenderPipeline::RenderPipeline(QObject* parent)
+    : QObject(parent)
+{
+    // One frame at a time, parallelism happens inside renderFrame()
+    m_pool.setMaxThreadCount(1);
+}
+
+RenderPipeline::~RenderPipeline()
+{
+    m_pending.reset();
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void RenderPipeline::render(RenderRequest request)
+{
+    m_pending = std::move(request);
+    if (!m_busy)
+        startNext();
+}
+
+void RenderPipeline::startNext()
+{
+    if (!m_pending)
+        return;
+
+    RenderRequest request = std::move(*m_pending);
+    m_pending.reset();
+    m_busy = true;
+
+    m_pool.start([this, request]() {
+        QImage frame = renderFrame(request, &m_cache);
+        RenderTransform transform = request.transform;
+        // Queued events to a deleted receiver are discarded, the destructor waits for this job
+        QMetaObject::invokeMethod(
+            this, [this, frame, transform]() {
+                m_busy = false;
+                emit frameReady(frame, transform);
+                startNext();
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+/**
+ * @brief Pixel rectangle touched by a series, padded by pen width or marker size
+ */
+static QRect pixelBounds(const SeriesSnapshot& series, const RenderTransform& transform)
+{
+    const qsizetype count = series.points.size();
+    if (count == 0)
+        return QRect();
+
+    // Density maps are binned over the whole frame
+    if (series.kind == SeriesSnapshot::Kind::Density)
+        return QRect(QPoint(0, 0), transform.imageSize());
+
+    qreal xmin = series.points.first().x(), xmax = xmin;
+    qreal ymin = series.points.first().y(), ymax = ymin;
+    for (const QPointF& point : series.points) {
+        xmin = qMin(xmin, point.x());
+        xmax = qMax(xmax, point.x());
+        ymin = qMin(ymin, point.y());
+        ymax = qMax(ymax, point.y());
+    }
+
+    const qreal pad = (series.kind == SeriesSnapshot::Kind::Line ? qMax<qreal>(1, series.pen.widthF()) : series.markerSize)
+            * transform.devicePixelRatio
+        + 2;
+    const QRectF bounds(QPointF((xmin - transform.xMin) * transform.scaleX() - pad, (transform.yMax - ymax) * transform.scaleY() - pad),
+        QPointF((xmax - transform.xMin) * transform.scaleX() + pad, (transform.yMax - ymin) * transform.scaleY() + pad));
+
+    return bounds.toAlignedRect().intersected(QRect(QPoint(0, 0), transform.imageSize()));
+}
+
+const LayerCache::Layer* LayerCache::find(const SeriesSnapshot& series, const RenderTransform& transform, bool antialiasing) const
+{
+    auto it = layers.constFind(series.key);
+    if (it == layers.constEnd() || it->revision != series.revision || it->transform != transform || it->antialiasing != antialiasing)
+        return nullptr;
+    return &it.value();
+}
+
+void LayerCache::trim(const QSet<quintptr>& keep)
+{
+    qsizetype used = 0;
+    for (const Layer& layer : qAsConst(layers))
+        used += layer.image.sizeInBytes();
+
+    for (auto it = layers.begin(); it != layers.end() && used > budget;) {
+        if (!keep.contains(it.key())) {
+            used -= it->image.sizeInBytes();
+            it = layers.erase(it);
+        } else
+            ++it;
+    }
+}
+
+/**
+ * @brief Stamp the pre-rasterized marker sprite of a scatter series into its layer
+ */
+static void stampScatter(QImage* image, const QPoint& offset, const SeriesSnapshot& series, const RenderTransform& transform)
+{
+    MarkerAtlas::Key key;
+    key.shape = series.markerShape;
+    key.size = series.markerSize;
+    key.fill = series.color.rgba();
+    key.border = series.borderColor.rgba();
+    key.borderWidth = series.pen.style() == Qt::NoPen ? 0 : series.pen.widthF();
+    key.devicePixelRatio = transform.devicePixelRatio;
+    const QImage sprite = MarkerAtlas::instance().sprite(key);
+
+    const qreal sx = transform.scaleX();
+    const qreal sy = transform.scaleY();
+    const qreal dx = transform.xMin * sx + offset.x() - 0.5;
+    const qreal dy = -transform.yMax * sy + offset.y() - 0.5;
+    const QPointF* points = series.points.constData();
+    QVector<QPoint> centers(series.points.size());
+    QPoint* center_data = centers.data();
+
+    ChartTools::ParallelFor(centers.size(), [points, center_data, sx, sy, dx, dy](qsizetype begin, qsizetype end, int worker) {
+        Q_UNUSED(worker)
+        for (qsizetype i = begin; i < end; ++i)
+            center_data[i] = QPoint(int(qBound(-1e6, std::floor(points[i].x() * sx - dx), 1e6)),
+                int(qBound(-1e6, std::floor(-points[i].y() * sy - dy), 1e6)));
+    });
+
+    MarkerAtlas::stamp(image, sprite, centers.constData(), centers.size());
+}
+
+LayerCache::Layer RenderPipeline::renderLayer(const SeriesSnapshot& series, const RenderTransform& transform, bool antialiasing)
+{
+    LayerCache::Layer layer;
+    layer.revision = series.revision;
+    layer.transform = transform;
+    layer.antialiasing = antialiasing;
+
+    const QRect bounds = pixelBounds(series, transform);
+    if (bounds.isEmpty())
+        return layer;
+
+    layer.offset = bounds.topLeft();
+    layer.image = QImage(bounds.size(), QImage::Format_ARGB32_Premultiplied);
+    layer.image.fill(Qt::transparent);
+
+    if (series.kind == SeriesSnapshot::Kind::Scatter) {
+        stampScatter(&layer.image, layer.offset, series, transform);
+        return layer;
+    }
+
+    QPainter painter(&layer.image);
+    painter.setRenderHint(QPainter::Antialiasing, antialiasing);
+    painter.translate(-layer.offset);
+    paintSeries(&painter, series, transform);
+    return layer;
+}
+
+QImage RenderPipeline::renderFrame(const RenderRequest& request, LayerCache* cache)
+{
+    const RenderTransform& transform = request.transform;
+    if (!transform.isValid())
+        return QImage();
+
+    // Reuse what is still valid, collect the rest
+    const qsizetype count = request.series.size();
+    QVector<const LayerCache::Layer*> layers(count, nullptr);
+    QVector<qsizetype> dirty;
+    for (qsizetype i = 0; i < count; ++i) {
+        if (cache)
+            layers[i] = cache->find(request.series[i], transform, request.antialiasing);
+        if (!layers[i])
+            dirty << i;
+    }
+
+    // Only the changed series are rasterized, one layer per series
+    QVector<LayerCache::Layer> rendered(dirty.size());
+    LayerCache::Layer* rendered_data = rendered.data();
+    const qsizetype* dirty_data = dirty.constData();
+    ChartTools::ParallelFor(
+        dirty.size(), [&request, &transform, rendered_data, dirty_data](qsizetype begin, qsizetype end, int worker) {
+            Q_UNUSED(worker)
+            for (qsizetype i = begin; i < end; ++i)
+                rendered_data[i] = renderLayer(request.series[dirty_data[i]], transform, request.antialiasing);
+        },
+        1);
+
+    if (cache) {
+        for (qsizetype i = 0; i < dirty.size(); ++i)
+            cache->layers.insert(request.series[dirty[i]].key, std::move(rendered[i]));
+        // Inserting may rehash, so resolve all pointers afterwards
+        for (qsizetype i = 0; i < count; ++i)
+            layers[i] = &cache->layers[request.series[i].key];
+    } else {
+        for (qsizetype i = 0; i < dirty.size(); ++i)
+            layers[dirty[i]] = &rendered[i];
+    }
+
+    QImage frame(transform.imageSize(), QImage::Format_ARGB32_Premultiplied);
+    frame.fill(Qt::transparent);
+    QPainter painter(&frame);
+    for (const LayerCache::Layer* layer : qAsConst(layers)) {
+        if (!layer->image.isNull())
+            painter.drawImage(layer->offset, layer->image);
+    }
+    painter.end();
+
+    if (cache) {
+        QSet<quintptr> keep;
+        for (const SeriesSnapshot& series : request.series)
+            keep.insert(series.key);
+        cache->trim(keep);
+    }
+
+    frame.setDevicePixelRatio(transform.devicePixelRatio);
+    return frame;
+}
+
+void RenderPipeline::paintSeries(QPainter* painter, const SeriesSnapshot& series, const RenderTransform& transform)
+{
+    const qreal sx = transform.scaleX();
+    const qreal sy = transform.scaleY();
+    const qreal x0 = transform.xMin;
+    const qreal y1 = transform.yMax;
+    const qreal dpr = transform.devicePixelRatio;
+    const int width = transform.imageSize().width();
+    const QPointF* points = series.points.constData();
+    const qsizetype count = series.points.size();
+
+    if (series.kind == SeriesSnapshot::Kind::Density) {
+        const QRectF range(QPointF(transform.xMin, transform.yMin), QPointF(transform.xMax, transform.yMax));
+        const DensityMap density = DensityMap::bin(points, count, range, transform.imageSize());
+        painter->drawImage(0, 0, density.toImage(static_cast<ColorMap>(series.colorMap), series.logDensity));
+    } else if (series.kind == SeriesSnapshot::Kind::Line) {
+        QPen pen = series.pen;
+        pen.setWidthF(qMax<qreal>(1, pen.widthF()) * dpr);
+        painter->setPen(pen);
+        painter->setBrush(Qt::NoBrush);
+
+        QPolygonF polyline;
+        polyline.reserve(qMin<qsizetype>(count, 4 * qsizetype(width) + 12));
+
+        // Per pixel column keep first, min, max and last point, which is visually lossless for a polyline.
+        // Everything left of the image shares column -1 and everything right of it column width: segments
+        // between such points are invisible, only the last and first one connect to the visible columns.
+        bool started = false;
+        qsizetype column = 0;
+        QPointF first, last, low, high;
+        auto flush = [&polyline, &first, &last, &low, &high]() {
+            polyline << first;
+            if (low.x() <= high.x())
+                polyline << low << high;
+            else
+                polyline << high << low;
+            polyline << last;
+        };
+
+        for (qsizetype i = 0; i < count; ++i) {
+            const QPointF pixel((points[i].x() - x0) * sx, (y1 - points[i].y()) * sy);
+            if (!std::isfinite(pixel.x()) || !std::isfinite(pixel.y()))
+                continue;
+            // Clamped as floating point, the conversion of huge values would be undefined
+            const qsizetype current = qsizetype(qBound<qreal>(-1, std::floor(pixel.x()), width));
+            if (!started || current != column) {
+                if (started)
+                    flush();
+                started = true;
+                column = current;
+                first = last = low = high = pixel;
+                continue;
+            }
+            last = pixel;
+            if (pixel.y() < low.y())
+                low = pixel;
+            if (pixel.y() > high.y())
+                high = pixel;
+        }
+        if (started)
+            flush();
+
+        painter->drawPolyline(polyline);
+    } else {
+        const qreal size = series.markerSize * dpr;
+        const qreal half = size / 2.0;
+        const QRectF bounds = QRectF(QPointF(0, 0), transform.imageSize()).adjusted(-size, -size, size, size);
+
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(series.color);
+        for (qsizetype i = 0; i < count; ++i) {
+            const QPointF pixel((points[i].x() - x0) * sx, (y1 - points[i].y()) * sy);
+            if (!bounds.contains(pixel))
+                continue;
+            const QRectF marker(pixel.x() - half, pixel.y() - half, size, size);
+            if (series.markerShape == QScatterSeries::MarkerShapeRectangle)
+                painter->drawRect(marker);
+            else
+                painter->drawEllipse(marker);
+        }
+    }
+}
+
+RenderFrameItem::RenderFrameItem(QGraphicsItem* parent)
+    : QGraphicsItem(parent)
+{
+    setAcceptedMouseButtons(Qt::NoButton);
+}
+
+void RenderFrameItem::setFrame(const QImage& frame, const RenderTransform& transform)
+{
+    m_frame = frame;
+    m_transform = transform;
+    setTargetRect(transform.plotArea, transform.plotArea);
+}
+
+void RenderFrameItem::setTargetRect(const QRectF& target, const QRectF& clip)
+{
+    prepareGeometryChange();
+    m_target = target.normalized();
+    m_clip = clip;
+    update();
+}
+
+void RenderFrameItem::clear()
+{
+    prepareGeometryChange();
+    m_frame = QImage();
+    m_transform = RenderTransform();
+    m_target = m_clip = QRectF();
+}
+
+void RenderFrameItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+
+    if (m_frame.isNull())
+        return;
+
+    painter->save();
+    painter->setClipRect(m_clip);
+    painter->drawImage(m_target, m_frame);
+    painter->restore();
+}
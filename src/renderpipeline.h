@@ -0,0 +1,255 @@
+/*
+ * CuteCharts - Background render pipeline for chart series
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include <QtGui/QPen>
+
+#include <QtWidgets/QGraphicsItem>
+
+#include <optional>
+
+class QAbstractSeries;
+
+/**
+ * @brief Immutable copy of everything needed to draw one series
+ *
+ * The point list is an implicitly shared QList, taking a snapshot therefore
+ * only bumps a reference count on the GUI thread.
+ */
+struct SeriesSnapshot {
+    enum class Kind {
+        Line = 0,
+        Scatter = 1,
+        Density = 2
+    };
+
+    quintptr key = 0;
+    quint64 revision = 0;
+    Kind kind = Kind::Line;
+    QList<QPointF> points;
+    QPen pen;
+    QColor color;
+    QColor borderColor;
+    qreal markerSize = 8;
+    int markerShape = 0;
+    int colorMap = 0;
+    bool logDensity = true;
+
+    /**
+     * @brief Take a snapshot of a line or scatter series
+     * @param series Series to copy
+     * @return The snapshot, or nothing if the series type is not supported
+     */
+    static std::optional<SeriesSnapshot> fromSeries(QAbstractSeries* series);
+};
+
+/**
+ * @brief Mapping from chart values to pixels of the rendered frame
+ */
+struct RenderTransform {
+    QRectF plotArea;
+    qreal xMin = 0, xMax = 1, yMin = 0, yMax = 1;
+    qreal devicePixelRatio = 1;
+
+    QSize imageSize() const { return (plotArea.size() * devicePixelRatio).toSize(); }
+    qreal scaleX() const { return imageSize().width() / (xMax - xMin); }
+    qreal scaleY() const { return imageSize().height() / (yMax - yMin); }
+    bool isValid() const { return !plotArea.isEmpty() && xMax > xMin && yMax > yMin; }
+
+    bool operator==(const RenderTransform& other) const
+    {
+        return plotArea == other.plotArea && xMin == other.xMin && xMax == other.xMax
+            && yMin == other.yMin && yMax == other.yMax && devicePixelRatio == other.devicePixelRatio;
+    }
+    bool operator!=(const RenderTransform& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Raster layers of individual series, reused while series, transform and antialiasing are unchanged
+ *
+ * A layer covers only the pixel bounds of its series. Layers of hidden series
+ * are kept as long as the memory budget allows, so toggling visibility back on
+ * costs a single blit.
+ */
+struct LayerCache {
+    struct Layer {
+        quint64 revision = 0;
+        RenderTransform transform;
+        bool antialiasing = true;
+        QPoint offset;
+        QImage image;
+    };
+
+    QHash<quintptr, Layer> layers;
+    qsizetype budget = qsizetype(256) * 1024 * 1024;
+
+    /**
+     * @brief Get a layer if it is still valid
+     * @param series Snapshot the layer has to match
+     * @param transform Transform of the frame
+     * @param antialiasing Render hint of the frame
+     * @return Pointer to the layer or nullptr
+     */
+    const Layer* find(const SeriesSnapshot& series, const RenderTransform& transform, bool antialiasing) const;
+
+    /**
+     * @brief Drop layers of series not in the keep set until the cache fits the budget
+     * @param keep Keys of the series in the current frame
+     */
+    void trim(const QSet<quintptr>& keep);
+};
+
+/**
+ * @brief One unit of work for the render pipeline
+ */
+struct RenderRequest {
+    QVector<SeriesSnapshot> series;
+    RenderTransform transform;
+    bool antialiasing = true;
+};
+
+/**
+ * @brief Rasterizes series snapshots into a QImage off the GUI thread
+ *
+ * Frames are produced on a private single-thread pool so that at most one
+ * frame is in flight; requests arriving meanwhile are coalesced and only the
+ * latest one is rendered. Only series whose revision or the transform changed
+ * are re-rasterized, in parallel on the global thread pool, each into its own
+ * cached layer; the frame is then recomposited from the layers in series
+ * order. The finished frame is delivered on the thread the pipeline lives in
+ * via frameReady().
+ */
+class RenderPipeline : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RenderPipeline(QObject* parent = nullptr);
+    ~RenderPipeline() override;
+
+    /**
+     * @brief Queue a frame, replacing any request not yet started
+     * @param request Snapshot of series and transform
+     */
+    void render(RenderRequest request);
+
+    /**
+     * @brief Check whether a frame is currently being rendered
+     * @return True while a worker is busy
+     */
+    bool isBusy() const { return m_busy; }
+
+    /**
+     * @brief Render a request synchronously on the calling thread
+     * @param request Snapshot of series and transform
+     * @param cache Layer cache to reuse and update, may be nullptr
+     * @return The composited frame
+     */
+    static QImage renderFrame(const RenderRequest& request, LayerCache* cache = nullptr);
+
+    /**
+     * @brief Rasterize a single series into a layer cropped to its pixel bounds
+     * @param series Series to draw
+     * @param transform Value to pixel mapping
+     * @param antialiasing Whether to antialias
+     * @return The layer, with a null image if the series is outside of the frame
+     */
+    static LayerCache::Layer renderLayer(const SeriesSnapshot& series, const RenderTransform& transform, bool antialiasing);
+
+    /**
+     * @brief Draw a single series snapshot with the given painter
+     * @param painter Painter on a frame-sized device
+     * @param series Series to draw
+     * @param transform Value to pixel mapping
+     */
+    static void paintSeries(QPainter* painter, const SeriesSnapshot& series, const RenderTransform& transform);
+
+signals:
+    /**
+     * @brief Emitted when a frame has been rendered
+     * @param frame The finished frame, sized to the plot area
+     * @param transform Transform the frame was rendered with
+     */
+    void frameReady(const QImage& frame, const RenderTransform& transform);
+
+private:
+    void startNext();
+
+    QThreadPool m_pool;
+    LayerCache m_cache; ///< Only touched by the render job
+    std::optional<RenderRequest> m_pending;
+    bool m_busy = false;
+};
+
+/**
+ * @brief Graphics item that blits the last finished frame into the plot area
+ *
+ * Until a new frame arrives after a zoom, the previous one is stretched to
+ * where its value range now lies, so the view follows the input immediately.
+ */
+class RenderFrameItem : public QGraphicsItem {
+public:
+    explicit RenderFrameItem(QGraphicsItem* parent = nullptr);
+
+    /**
+     * @brief Replace the displayed frame
+     * @param frame Frame rendered by the pipeline
+     * @param transform Transform the frame was rendered with
+     */
+    void setFrame(const QImage& frame, const RenderTransform& transform);
+
+    /**
+     * @brief Get the transform of the displayed frame
+     * @return Transform the current frame was rendered with
+     */
+    const RenderTransform& frameTransform() const { return m_transform; }
+
+    /**
+     * @brief Place the frame in chart coordinates
+     * @param target Rectangle the frame value range maps to
+     * @param clip Plot area outside of which nothing is drawn
+     */
+    void setTargetRect(const QRectF& target, const QRectF& clip);
+
+    /**
+     * @brief Drop the current frame
+     */
+    void clear();
+
+    QRectF boundingRect() const override { return m_clip; }
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    QImage m_frame;
+    RenderTransform m_transform;
+    QRectF m_target, m_clip;
+};
+
+Q_DECLARE_METATYPE(RenderTransform)
@@ -0,0 +1,282 @@
+/*
+ * CuteCharts - Compact float32 sample storage with min/max decimation
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+#include "samplestore.h"
+
+namespace {
+/**
+ * @brief Indices of the lowest and highest value in [from, to), the first of equal values wins
+ */
+template <typename T>
+std::pair<qsizetype, qsizetype> extremes(const T* values, qsizetype from, qsizetype to)
+{
+    qsizetype low = from, high = from;
+    for (qsizetype i = from + 1; i < to; ++i) {
+        if (values[i] < values[low])
+            low = i;
+        if (values[i] > values[high])
+            high = i;
+    }
+    return { low, high };
+}
+}
+
+SampleStore SampleStore::fromPoints(const QList<QPointF>& points)
+{
+    SampleStore store;
+    const qsizetype count = points.size();
+    store.m_uniform = false;
+    store.m_y.resize(count);
+    store.m_offset.resize(count);
+    store.m_base.resize((count + BlockSize - 1) / BlockSize);
+
+    const QPointF* source = points.constData();
+    float* y = store.m_y.data();
+    float* offset = store.m_offset.data();
+    double* base = store.m_base.data();
+    ChartTools::ParallelFor(store.m_base.size(), [source, y, offset, base, count](qsizetype begin, qsizetype end, int) {
+        for (qsizetype block = begin; block < end; ++block) {
+            const qsizetype first = block * BlockSize;
+            const qsizetype last = qMin(count, first + BlockSize);
+            // The first finite x is the base, non-finite values stay non-finite offsets
+            double origin = 0;
+            for (qsizetype i = first; i < last; ++i) {
+                if (std::isfinite(source[i].x())) {
+                    origin = source[i].x();
+                    break;
+                }
+            }
+            base[block] = origin;
+            for (qsizetype i = first; i < last; ++i) {
+                offset[i] = float(source[i].x() - origin);
+                y[i] = float(source[i].y());
+            }
+        }
+    },
+        16);
+
+    store.update();
+    return store;
+}
+
+SampleStore SampleStore::uniform(double start, double step, const QVector<double>& values, Precision precision)
+{
+    SampleStore store;
+    store.m_start = start;
+    store.m_step = step;
+    if (precision == Precision::Double) {
+        store.m_double = true;
+        store.m_y_double = values;
+        store.update();
+        return store;
+    }
+
+    store.m_y.resize(values.size());
+
+    const double* source = values.constData();
+    float* y = store.m_y.data();
+    ChartTools::ParallelFor(values.size(), [source, y](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            y[i] = float(source[i]);
+    },
+        65536);
+
+    store.update();
+    return store;
+}
+
+SampleStore SampleStore::uniform(double start, double step, const float* values, qsizetype count)
+{
+    SampleStore store;
+    store.m_start = start;
+    store.m_step = step;
+    store.m_y.resize(qMax<qsizetype>(0, count));
+    if (count > 0)
+        std::memcpy(store.m_y.data(), values, size_t(count) * sizeof(float));
+
+    store.update();
+    return store;
+}
+
+void SampleStore::update()
+{
+    const qsizetype count = size();
+    m_x_min = m_x_max = m_y_min = m_y_max = 0;
+    m_sorted = !m_uniform || m_step >= 0;
+    if (count == 0)
+        return;
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    const size_t workers = size_t(ChartTools::WorkerCount());
+    std::vector<std::array<double, 4>> bounds(workers, { infinity, -infinity, infinity, -infinity });
+    std::vector<char> unsorted(workers, 0);
+
+    ChartTools::ParallelFor(count, [this, &bounds, &unsorted](qsizetype begin, qsizetype end, int worker) {
+        std::array<double, 4> local = bounds[size_t(worker)];
+        for (qsizetype i = begin; i < end; ++i) {
+            const double value = y(i);
+            if (!std::isfinite(value))
+                continue;
+            local[2] = std::min(local[2], value);
+            local[3] = std::max(local[3], value);
+        }
+        if (!m_uniform) {
+            bool ascending = true;
+            for (qsizetype i = begin; i < end; ++i) {
+                const double value = x(i);
+                // NaN fails the comparison as well, such a trace cannot be searched
+                if (i > 0 && !(value >= x(i - 1)))
+                    ascending = false;
+                if (!std::isfinite(value))
+                    continue;
+                local[0] = std::min(local[0], value);
+                local[1] = std::max(local[1], value);
+            }
+            if (!ascending)
+                unsorted[size_t(worker)] = 1;
+        }
+        bounds[size_t(worker)] = local;
+    },
+        65536);
+
+    std::array<double, 4> total = { infinity, -infinity, infinity, -infinity };
+    for (const std::array<double, 4>& local : bounds) {
+        total[0] = std::min(total[0], local[0]);
+        total[1] = std::max(total[1], local[1]);
+        total[2] = std::min(total[2], local[2]);
+        total[3] = std::max(total[3], local[3]);
+    }
+    if (m_uniform) {
+        total[0] = std::min(m_start, x(count - 1));
+        total[1] = std::max(m_start, x(count - 1));
+    } else {
+        m_sorted = std::none_of(unsorted.cbegin(), unsorted.cend(), [](char flag) { return flag; });
+    }
+
+    if (total[1] >= total[0]) {
+        m_x_min = total[0];
+        m_x_max = total[1];
+    }
+    if (total[3] >= total[2]) {
+        m_y_min = total[2];
+        m_y_max = total[3];
+    }
+}
+
+qsizetype SampleStore::lowerBound(double value) const
+{
+    const qsizetype count = size();
+    if (!m_sorted || count == 0 || std::isnan(value))
+        return 0;
+
+    if (m_uniform) {
+        if (m_step <= 0)
+            return value <= m_start ? 0 : count;
+        const double index = std::ceil((value - m_start) / m_step);
+        return qsizetype(qBound(0.0, index, double(count)));
+    }
+
+    qsizetype low = 0, high = count;
+    while (low < high) {
+        const qsizetype middle = low + (high - low) / 2;
+        if (x(middle) < value)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+QList<QPointF> SampleStore::points() const
+{
+    QList<QPointF> result(size());
+    QPointF* target = result.data();
+    ChartTools::ParallelFor(size(), [this, target](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            target[i] = point(i);
+    },
+        65536);
+    return result;
+}
+
+QList<QPointF> SampleStore::decimate(double min, double max, int columns) const
+{
+    QList<QPointF> result;
+    if (isEmpty() || columns < 1 || !(max > min))
+        return result;
+    if (!m_sorted)
+        return points();
+
+    // One sample beyond either end keeps the line running to the border
+    const qsizetype inside = lowerBound(min);
+    const qsizetype beyond = lowerBound(max);
+    const qsizetype first = qMax<qsizetype>(0, inside - 1);
+    const qsizetype last = qMin(size(), beyond + 1);
+
+    if (last - first <= 4 * qsizetype(columns)) {
+        result.reserve(last - first);
+        for (qsizetype i = first; i < last; ++i)
+            result << point(i);
+        return result;
+    }
+
+    std::vector<std::array<qsizetype, 4>> kept(static_cast<size_t>(columns));
+    std::vector<int> counts(size_t(columns), 0);
+    const double width = (max - min) / columns;
+    ChartTools::ParallelFor(columns, [&](qsizetype begin, qsizetype end, int) {
+        for (qsizetype column = begin; column < end; ++column) {
+            const qsizetype from = column == 0 ? inside : qMax(inside, lowerBound(min + column * width));
+            const qsizetype to = column + 1 == columns ? beyond : qMin(beyond, lowerBound(min + (column + 1) * width));
+            if (from >= to)
+                continue;
+
+            const auto [low, high] = m_double ? extremes(m_y_double.constData(), from, to) : extremes(m_y.constData(), from, to);
+            std::array<qsizetype, 4>& indices = kept[size_t(column)];
+            indices = { from, qMin(low, high), qMax(low, high), to - 1 };
+            counts[size_t(column)] = int(std::unique(indices.begin(), indices.end()) - indices.begin());
+        }
+    },
+        64);
+
+    result.reserve(4 * qsizetype(columns) + 2);
+    if (first < inside)
+        result << point(first);
+    for (int column = 0; column < columns; ++column) {
+        for (int i = 0; i < counts[size_t(column)]; ++i)
+            result << point(kept[size_t(column)][size_t(i)]);
+    }
+    if (beyond < last)
+        result << point(beyond);
+    return result;
+}
+
+qsizetype SampleStore::memoryUsage() const
+{
+    return m_y.size() * qsizetype(sizeof(float)) + m_y_double.size() * qsizetype(sizeof(double)) + m_offset.size() * qsizetype(sizeof(float)) + m_base.size() * qsizetype(sizeof(double));
+}
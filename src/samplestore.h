@@ -0,0 +1,142 @@
+/*
+ * CuteCharts - Compact float32 sample storage with min/max decimation
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QList>
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
+/**
+ * @brief Samples of a trace in float32, a quarter of the size of a QPointF list
+ *
+ * Y values are stored as float, or as double for uniform data that asks for
+ * Precision::Double. X values are either implicit, start + i * step
+ * for uniformly sampled data, or a double base per block of BlockSize samples
+ * plus a float offset per sample; the offsets only span one block, so the
+ * precision follows the spacing of the samples, not the magnitude of x.
+ * A uniform trace of 10M samples takes 40 MB.
+ *
+ * Bounds and whether x ascends are computed once. For ascending x the visible
+ * range is found by binary search, or by index arithmetic when uniform, and
+ * decimate() reduces it to the first, lowest, highest and last sample of each
+ * pixel column, which draws the same line as all samples would.
+ *
+ * Containers are implicitly shared, copies are cheap.
+ */
+class SampleStore {
+public:
+    static constexpr qsizetype BlockSize = 4096;
+
+    enum class Precision {
+        Float,
+        Double
+    };
+
+    SampleStore() = default;
+
+    /**
+     * @brief Convert points, x is stored as block base plus offset
+     */
+    static SampleStore fromPoints(const QList<QPointF>& points);
+
+    /**
+     * @brief Uniformly sampled values, x is implicit
+     * @param start X of the first sample
+     * @param step Distance of two samples in x
+     * @param values Y values
+     * @param precision Double shares values instead of converting them
+     */
+    static SampleStore uniform(double start, double step, const QVector<double>& values, Precision precision = Precision::Float);
+
+    /**
+     * @brief Uniformly sampled float32 values, copied without conversion
+     */
+    static SampleStore uniform(double start, double step, const float* values, qsizetype count);
+
+    inline qsizetype size() const { return m_double ? m_y_double.size() : m_y.size(); }
+    inline bool isEmpty() const { return size() == 0; }
+    inline bool isUniform() const { return m_uniform; }
+    inline Precision precision() const { return m_double ? Precision::Double : Precision::Float; }
+    inline double start() const { return m_start; }
+    inline double step() const { return m_step; }
+
+    /**
+     * @brief Whether x never decreases, needed for range lookup and decimation
+     */
+    inline bool isSorted() const { return m_sorted; }
+
+    inline double x(qsizetype index) const
+    {
+        return m_uniform ? m_start + index * m_step : m_base[index / BlockSize] + m_offset[index];
+    }
+    inline double y(qsizetype index) const { return m_double ? m_y_double[index] : m_y[index]; }
+    inline QPointF point(qsizetype index) const { return QPointF(x(index), y(index)); }
+
+    /**
+     * @brief Bounds of the finite values, all zero for an empty store
+     */
+    inline double xMin() const { return m_x_min; }
+    inline double xMax() const { return m_x_max; }
+    inline double yMin() const { return m_y_min; }
+    inline double yMax() const { return m_y_max; }
+
+    /**
+     * @brief First index whose x is not below value
+     *
+     * Index arithmetic when uniform, binary search otherwise; 0 if x is not sorted.
+     */
+    qsizetype lowerBound(double value) const;
+
+    /**
+     * @brief All samples as points, for export
+     */
+    QList<QPointF> points() const;
+
+    /**
+     * @brief Points that draw the samples in a range at a given resolution
+     *
+     * Every column keeps its first, lowest, highest and last sample in their
+     * original order, plus one sample on either side of the range so the line
+     * runs to the border. Ranges with few samples are returned completely,
+     * unsorted stores as well.
+     * @param min Lower end of the visible x range
+     * @param max Upper end of the visible x range
+     * @param columns Pixel columns of the range
+     */
+    QList<QPointF> decimate(double min, double max, int columns) const;
+
+    /**
+     * @brief Bytes held by the samples
+     */
+    qsizetype memoryUsage() const;
+
+private:
+    void update();
+
+    QVector<float> m_y;
+    QVector<double> m_y_double;
+    QVector<float> m_offset;
+    QVector<double> m_base;
+    double m_start = 0, m_step = 1;
+    double m_x_min = 0, m_x_max = 0, m_y_min = 0, m_y_max = 0;
+    bool m_uniform = true;
+    bool m_sorted = true;
+    bool m_double = false;
+};
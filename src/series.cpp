@@ -28,6 +28,13 @@
 
 #include <QtWidgets/QListWidgetItem>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "parallel.h"
+
 #include "series.h"
 
 // Factory implementation
@@ -96,6 +103,111 @@ void LineSeries::setName(const QString& str)
     QLineSeries::setName(str);
 }
 
+namespace {
+// Revisions are unique across series, a new series at a reused address never matches an old one
+quint64 nextSamplesRevision = 0;
+
+void widenViewport(double& min, double& max)
+{
+    if (!(max > min)) {
+        // A single x value or an empty store, widen so the samples are still found
+        min -= 0.5;
+        max += 0.5;
+    }
+}
+}
+
+void LineSeries::setSamples(const SampleStore& samples)
+{
+    m_samples = samples;
+    m_samples_revision = ++nextSamplesRevision;
+    m_compact = true;
+    // Until a view asks for its range, the whole trace at a typical screen width
+    m_view_columns = 0;
+    setViewport(m_samples.xMin(), m_samples.xMax(), 2048);
+    emit samplesChanged();
+}
+
+void LineSeries::setCompactStorage(bool compact)
+{
+    if (compact == m_compact)
+        return;
+    if (compact) {
+        emit aboutToCompact();
+        setSamples(SampleStore::fromPoints(points()));
+        return;
+    }
+    const QList<QPointF> data = m_samples.points();
+    m_samples = SampleStore();
+    m_view_points.clear();
+    m_compact = false;
+    replace(data);
+    emit samplesChanged();
+}
+
+QList<QPointF> LineSeries::dataPoints() const
+{
+    return m_compact ? m_samples.points() : points();
+}
+
+void LineSeries::setViewport(double min, double max, int columns)
+{
+    if (!m_compact)
+        return;
+    widenViewport(min, max);
+    if (min == m_view_min && max == m_view_max && columns == m_view_columns)
+        return;
+    setViewport(min, max, columns, m_samples.decimate(min, max, columns));
+}
+
+void LineSeries::setViewport(double min, double max, int columns, const QList<QPointF>& decimated)
+{
+    if (!m_compact)
+        return;
+    widenViewport(min, max);
+    if (min == m_view_min && max == m_view_max && columns == m_view_columns)
+        return;
+    m_view_min = min;
+    m_view_max = max;
+    m_view_columns = columns;
+    m_view_points = decimated;
+    replace(decimated);
+}
+
+// === UniformLineSeries Implementation ===
+
+UniformLineSeries::UniformLineSeries()
+{
+    setData(0, 1, QVector<double>());
+}
+
+UniformLineSeries::UniformLineSeries(double x0, double dx, const QVector<double>& values)
+{
+    setData(x0, dx, values);
+}
+
+void UniformLineSeries::setData(double x0, double dx, const QVector<double>& values)
+{
+    m_x0 = x0;
+    m_dx = dx;
+    m_values = values;
+    setSamples(SampleStore::uniform(x0, dx, values, SampleStore::Precision::Double));
+}
+
+void UniformLineSeries::setCompactStorage(bool compact)
+{
+    Q_UNUSED(compact)
+}
+
+QPair<qsizetype, qsizetype> UniformLineSeries::indexRange(double min, double max) const
+{
+    const SampleStore& store = samples();
+    // Past the last sample at max, not before it
+    const qsizetype end = store.lowerBound(std::nextafter(max, std::numeric_limits<double>::infinity()));
+    const qsizetype first = store.lowerBound(min);
+    return qMakePair(first, qMax(first, end));
+}
+
 // Line Series State Implementation
 void LineSeriesState::saveState(QAbstractSeries* series)
 {
@@ -147,6 +259,30 @@ void ScatterSeries::showLine(int state)
     emit visibilityChanged(state);
 }
 
+void ScatterSeries::setDensityMode(bool density)
+{
+    if (m_density_mode == density)
+        return;
+    m_density_mode = density;
+    emit densityChanged();
+}
+
+void ScatterSeries::setColorMap(ColorMap map)
+{
+    if (m_color_map == map)
+        return;
+    m_color_map = map;
+    emit densityChanged();
+}
+
+void ScatterSeries::setLogDensity(bool logarithmic)
+{
+    if (m_log_density == logarithmic)
+        return;
+    m_log_density = logarithmic;
+    emit densityChanged();
+}
+
 // Scatter Series State Implementation
 void ScatterSeriesState::saveState(QAbstractSeries* series)
 {
@@ -170,42 +306,103 @@ void ScatterSeriesState::restoreState(QAbstractSeries* series)
 
 // === BoxPlotSeries Implementation ===
 
+BoxPlotSeries::BoxPlotSeries()
+    : m_outliers(new QScatterSeries(this))
+{
+    m_outliers->setMarkerSize(6);
+    m_outliers->setColor(color());
+    m_outliers->setBorderColor(color());
+    connect(this, &QAbstractSeries::visibleChanged, m_outliers, [this]() {
+        m_outliers->setVisible(isVisible());
+    });
+}
+
 BoxPlotSeries::BoxPlotSeries(const BoxWhisker& boxwhisker)
-    : m_boxwhisker(boxwhisker)
+    : BoxPlotSeries()
 {
-    loadBoxWhisker();
+    addBox(boxwhisker);
 }
 
-void BoxPlotSeries::loadBoxWhisker()
+BoxPlotSeries::~BoxPlotSeries()
 {
-    QBoxSet* box = new QBoxSet;
-    box->setValue(QBoxSet::LowerExtreme, m_boxwhisker.lower_whisker);
-    box->setValue(QBoxSet::UpperExtreme, m_boxwhisker.upper_whisker);
-    box->setValue(QBoxSet::Median, m_boxwhisker.median);
-    box->setValue(QBoxSet::LowerQuartile, m_boxwhisker.lower_quantile);
-    box->setValue(QBoxSet::UpperQuartile, m_boxwhisker.upper_quantile);
-    append(box);
+    // The chart owns the outlier series once it is added, it must not outlive the boxes;
+    // Qt Charts refuses to destroy a series that is still bound to a chart
+    if (m_outliers && m_outliers->parent() != this) {
+        if (QChart* chart = m_outliers->chart())
+            chart->removeSeries(m_outliers);
+        m_outliers->deleteLater();
+    }
 }
 
-void BoxPlotSeries::setVisible(bool visible)
+QBoxSet* BoxPlotSeries::createBoxSet(const BoxWhisker& boxwhisker, const QString& label)
 {
-    if (m_visible == visible)
-        return;
+    QBoxSet* box = new QBoxSet(label);
+    box->setValue(QBoxSet::LowerExtreme, boxwhisker.lower_whisker);
+    box->setValue(QBoxSet::UpperExtreme, boxwhisker.upper_whisker);
+    box->setValue(QBoxSet::Median, boxwhisker.median);
+    box->setValue(QBoxSet::LowerQuartile, boxwhisker.lower_quantile);
+    box->setValue(QBoxSet::UpperQuartile, boxwhisker.upper_quantile);
+    return box;
+}
+
+QList<QPointF> BoxPlotSeries::outlierPoints(const BoxWhisker& boxwhisker, int index)
+{
+    QList<QPointF> points;
+    points.reserve(boxwhisker.mild_outliers.size() + boxwhisker.extreme_outliers.size());
+    for (qreal value : boxwhisker.mild_outliers)
+        points << QPointF(index, value);
+    for (qreal value : boxwhisker.extreme_outliers)
+        points << QPointF(index, value);
+    return points;
+}
 
-    if (visible)
-        loadBoxWhisker();
-    else
-        clear();
+void BoxPlotSeries::addBox(const BoxWhisker& boxwhisker, const QString& label)
+{
+    const int index = m_boxes.size();
+    m_boxes << boxwhisker;
+    append(createBoxSet(boxwhisker, label));
 
-    m_visible = visible;
+    const QList<QPointF> points = outlierPoints(boxwhisker, index);
+    if (m_outliers && !points.isEmpty())
+        m_outliers->append(points);
+}
+
+void BoxPlotSeries::setBoxes(const QList<BoxWhisker>& boxes, const QStringList& labels)
+{
+    clear();
+    m_boxes = boxes;
+
+    QList<QBoxSet*> sets;
+    QList<QPointF> points;
+    sets.reserve(boxes.size());
+    for (int i = 0; i < boxes.size(); ++i) {
+        sets << createBoxSet(boxes[i], labels.value(i));
+        points << outlierPoints(boxes[i], i);
+    }
+    append(sets);
+    if (m_outliers)
+        m_outliers->replace(points);
+}
+
+void BoxPlotSeries::setVisible(bool visible)
+{
+    // Qt Charts does not hide the box items with the series, fading them out
+    // keeps all box sets alive instead of clearing and rebuilding them
+    setOpacity(visible ? 1.0 : 0.0);
     QBoxPlotSeries::setVisible(visible);
 }
 
 void BoxPlotSeries::setColor(const QColor& color)
 {
+    // Box sets have no brush of their own, the series brush covers all of them
     QBrush brush = this->brush();
     brush.setColor(color);
     setBrush(brush);
+
+    if (m_outliers) {
+        m_outliers->setColor(color);
+        m_outliers->setBorderColor(color);
+    }
 }
 
 // Box Plot Series State Implementation
@@ -227,6 +424,226 @@ void BoxPlotSeriesState::restoreState(QAbstractSeries* series)
     }
 }
 
+// === ViolinSeries Implementation ===
+
+ViolinSeries::ViolinSeries(const QVector<qreal>& samples, qreal position, Style style)
+    : m_samples(samples)
+    , m_boxwhisker(BoxWhiskerBuilder::compute(samples))
+    , m_position(position)
+    , m_style(style)
+    , m_upper(new QLineSeries(this))
+    , m_lower(new QLineSeries(this))
+{
+    bool first = true;
+    for (qreal sample : m_samples) {
+        if (!std::isfinite(sample))
+            continue;
+        m_min = first ? sample : qMin(m_min, sample);
+        m_max = first ? sample : qMax(m_max, sample);
+        first = false;
+    }
+
+    setUpperSeries(m_upper);
+    setLowerSeries(m_lower);
+    updateOutline();
+}
+
+KernelDensity ViolinSeries::computeDensity(qreal bandwidth) const
+{
+    const qreal h = bandwidth > 0 ? bandwidth : KernelDensity::silvermanBandwidth(m_boxwhisker);
+    // Three bandwidths beyond the extremes, the tails are practically zero there
+    return KernelDensity::estimate(m_samples.constData(), m_samples.size(), m_min - 3 * h, m_max + 3 * h, 512, h);
+}
+
+void ViolinSeries::estimate(const QList<ViolinSeries*>& series, qreal bandwidth)
+{
+    QList<ViolinSeries*> missing;
+    for (ViolinSeries* serie : series) {
+        if (serie && !serie->m_density_cache.contains(bandwidth))
+            missing << serie;
+    }
+
+    // One distribution per task, every estimate parallelizes its binning on top
+    std::vector<KernelDensity> densities(size_t(missing.size()));
+    ChartTools::ParallelFor(missing.size(), [&missing, &densities, bandwidth](qsizetype begin, qsizetype end, int) {
+        for (qsizetype i = begin; i < end; ++i)
+            densities[size_t(i)] = missing[i]->computeDensity(bandwidth);
+    },
+        1);
+
+    for (qsizetype i = 0; i < missing.size(); ++i)
+        missing[i]->m_density_cache.insert(bandwidth, densities[size_t(i)]);
+    for (ViolinSeries* serie : series) {
+        if (serie)
+            serie->setBandwidth(bandwidth);
+    }
+}
+
+void ViolinSeries::setBandwidth(qreal bandwidth)
+{
+    m_bandwidth = qMax<qreal>(0, bandwidth);
+    updateOutline();
+}
+
+void ViolinSeries::setPosition(qreal position)
+{
+    if (position == m_position)
+        return;
+    m_position = position;
+    updateOutline();
+}
+
+void ViolinSeries::setStyle(Style style)
+{
+    if (style == m_style)
+        return;
+    m_style = style;
+    updateOutline();
+}
+
+void ViolinSeries::setColor(const QColor& color)
+{
+    QBrush brush = this->brush();
+    brush.setColor(color);
+    setBrush(brush);
+
+    QPen pen = this->pen();
+    pen.setColor(color.darker());
+    setPen(pen);
+}
+
+void ViolinSeries::updateOutline()
+{
+    auto it = m_density_cache.constFind(m_bandwidth);
+    if (it == m_density_cache.constEnd())
+        it = m_density_cache.insert(m_bandwidth, computeDensity(m_bandwidth));
+    const KernelDensity& kde = it.value();
+
+    qreal peak = 0;
+    for (qreal value : kde.density)
+        peak = qMax(peak, value);
+
+    // Violins get a half width of 0.4 boxes, ridges a height of 0.9
+    const qreal scale = peak > 0 ? (m_style == Style::Violin ? 0.4 : 0.9) / peak : 0;
+    const qreal step = kde.step();
+
+    QList<QPointF> upper, lower;
+    upper.reserve(kde.density.size());
+    lower.reserve(kde.density.size());
+    for (int i = 0; i < kde.density.size(); ++i) {
+        const qreal value = kde.min + i * step;
+        const qreal extent = kde.density[i] * scale;
+        if (m_style == Style::Violin) {
+            upper << QPointF(m_position + extent, value);
+            lower << QPointF(m_position - extent, value);
+        } else {
+            upper << QPointF(value, m_position + extent);
+            lower << QPointF(value, m_position);
+        }
+    }
+    m_upper->replace(upper);
+    m_lower->replace(lower);
+}
+
+// === HistogramSeries Implementation ===
+
+HistogramSeries::HistogramSeries(int bins, qreal min, qreal max, bool autoExpand)
+    : m_histogram(bins, min, max, autoExpand)
+    , m_outline(new QLineSeries(this))
+{
+    setUpperSeries(m_outline);
+
+    // About one update per frame, however fast samples come in
+    m_update_timer.setSingleShot(true);
+    m_update_timer.setInterval(16);
+    connect(&m_update_timer, &QTimer::timeout, this, &HistogramSeries::updateOutline);
+    updateOutline();
+}
+
+void HistogramSeries::addSample(qreal sample)
+{
+    m_histogram.addSample(sample);
+    scheduleUpdate();
+}
+
+void HistogramSeries::addSamples(const qreal* samples, qsizetype count)
+{
+    m_histogram.addSamples(samples, count);
+    scheduleUpdate();
+}
+
+void HistogramSeries::addSamples(const QVector<qreal>& samples)
+{
+    addSamples(samples.constData(), samples.size());
+}
+
+void HistogramSeries::reset(qreal min, qreal max)
+{
+    m_histogram.reset(min, max);
+    scheduleUpdate();
+}
+
+void HistogramSeries::setDisplayBins(int bins)
+{
+    if (bins < 1 || bins == m_display_bins)
+        return;
+    m_display_bins = bins;
+    scheduleUpdate();
+}
+
+void HistogramSeries::setViewRange(qreal min, qreal max)
+{
+    if (!(max > min))
+        return;
+    if (m_has_view && min == m_view_min && max == m_view_max)
+        return;
+    m_view_min = min;
+    m_view_max = max;
+    m_has_view = true;
+    scheduleUpdate();
+}
+
+qreal HistogramSeries::maximumCount() const
+{
+    const QVector<qreal> counts = m_histogram.rebin(m_histogram.minimum(), m_histogram.maximum(), m_display_bins);
+    return counts.isEmpty() ? 0 : *std::max_element(counts.cbegin(), counts.cend());
+}
+
+void HistogramSeries::setColor(const QColor& color)
+{
+    QBrush brush = this->brush();
+    brush.setColor(color);
+    setBrush(brush);
+
+    QPen pen = this->pen();
+    pen.setColor(color.darker());
+    setPen(pen);
+}
+
+void HistogramSeries::scheduleUpdate()
+{
+    if (!m_update_timer.isActive())
+        m_update_timer.start();
+}
+
+void HistogramSeries::updateOutline()
+{
+    const qreal min = m_has_view ? m_view_min : m_histogram.minimum();
+    const qreal max = m_has_view ? m_view_max : m_histogram.maximum();
+    const QVector<qreal> counts = m_histogram.rebin(min, max, m_display_bins);
+    const qreal width = (max - min) / m_display_bins;
+
+    QList<QPointF> points;
+    points.reserve(2 * counts.size() + 2);
+    points << QPointF(min, 0);
+    for (int i = 0; i < counts.size(); ++i) {
+        points << QPointF(min + i * width, counts[i]);
+        points << QPointF(min + (i + 1) * width, counts[i]);
+    }
+    points << QPointF(max, 0);
+    m_outline->replace(points);
+}
+
 // Helper function for ListChart
 void updateSeriesColor(QListWidgetItem* item, QAbstractSeries* series, const QColor& color)
 {
@@ -234,6 +651,13 @@ void updateSeriesColor(QListWidgetItem* item, QAbstractSeries* series, const QCo
         return;
 
     item->setBackground(color);
+    updateSeriesColor(series, color);
+}
+
+void updateSeriesColor(QAbstractSeries* series, const QColor& color)
+{
+    if (!series || !color.isValid())
+        return;
 
     if (auto xySeries = qobject_cast<QXYSeries*>(series)) {
         xySeries->setColor(color);
@@ -243,6 +667,10 @@ void updateSeriesColor(QListWidgetItem* item, QAbstractSeries* series, const QCo
         }
     } else if (auto boxPlotSeries = qobject_cast<BoxPlotSeries*>(series)) {
         boxPlotSeries->setColor(color);
+    } else if (auto histogramSeries = qobject_cast<HistogramSeries*>(series)) {
+        histogramSeries->setColor(color);
+    } else if (auto violinSeries = qobject_cast<ViolinSeries*>(series)) {
+        violinSeries->setColor(color);
     }
 }
 
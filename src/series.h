@@ -22,9 +22,11 @@
 #include <QtCore/QList>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
+#include <QtCore/QTimer>
 
 #include <QtCharts>
 
+#include <QtCharts/QAreaSeries>
 #include <QtCharts/QBoxPlotSeries>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QScatterSeries>
@@ -32,6 +34,10 @@
 #include <QtCharts/QXYSeries>
 
 #include "boxwhisker.h"
+#include "densitymap.h"
+#include "histogram.h"
+#include "kerneldensity.h"
+#include "samplestore.h"
 
 #include <memory>
 
@@ -73,6 +79,11 @@ public:
 
 /**
  * @brief Enhanced line series with additional styling options
+ *
+ * With compact storage the series keeps its data in a SampleStore and the
+ * point list Qt Charts sees only holds the decimated samples of the visible
+ * range; ChartView updates them whenever the view changes. samples() and
+ * dataPoints() give the complete data.
  */
 class LineSeries : public QLineSeries {
     Q_OBJECT
@@ -115,6 +126,54 @@ public:
      */
     QColor color() const override { return m_color; }
 
+    /**
+     * @brief Replace the data by float32 samples and switch to compact storage
+     * @param samples The samples, shared and not copied
+     */
+    void setSamples(const SampleStore& samples);
+
+    /**
+     * @brief Move the current data into compact storage or back into the point list
+     * @param compact True for float32 samples
+     */
+    virtual void setCompactStorage(bool compact);
+
+    inline bool hasCompactStorage() const { return m_compact; }
+
+    /**
+     * @brief Samples of compact storage, empty otherwise
+     */
+    inline const SampleStore& samples() const { return m_samples; }
+
+    /**
+     * @brief All data points, expanded from the samples in compact storage
+     */
+    QList<QPointF> dataPoints() const;
+
+    /**
+     * @brief Decimate the samples for a visible range, nothing happens without compact storage
+     * @param min Lower end of the visible x range in data values
+     * @param max Upper end of the visible x range in data values
+     * @param columns Pixel columns of the plot area
+     */
+    void setViewport(double min, double max, int columns);
+
+    /**
+     * @brief Show points decimated earlier from the same samples for the same viewport
+     * @param decimated Points taken from viewportPoints() at that time
+     */
+    void setViewport(double min, double max, int columns, const QList<QPointF>& decimated);
+
+    /**
+     * @brief Decimated points of the current viewport in data values, empty without compact storage
+     */
+    inline const QList<QPointF>& viewportPoints() const { return m_view_points; }
+
+    /**
+     * @brief Changes whenever the samples are replaced, unique across all series
+     */
+    inline quint64 samplesRevision() const { return m_samples_revision; }
+
 public slots:
     void setColor(const QColor& color) override;
 
@@ -159,12 +218,33 @@ private:
     double m_size = 2;
     QColor m_color;
 
+    // Compact storage and the viewport its points were decimated for
+    SampleStore m_samples;
+    bool m_compact = false;
+    double m_view_min = 0, m_view_max = 0;
+    int m_view_columns = 0;
+    QList<QPointF> m_view_points;
+    quint64 m_samples_revision = 0;
+
 signals:
     /**
      * @brief Signal emitted when legend visibility changes
      * @param legend Whether series should show in legend
      */
     void legendChanged(bool legend);
+
+    /**
+     * @brief Signal emitted when the samples of compact storage have been replaced
+     */
+    void samplesChanged();
+
+    /**
+     * @brief Signal emitted before the point list moves into compact storage
+     *
+     * A view that maps the points for an axis transform puts the data values
+     * back in place, those are what the samples are built from.
+     */
+    void aboutToCompact();
 };
 
 /**
@@ -181,6 +261,58 @@ private:
     bool m_dashDot = false;
 };
 
+/**
+ * @brief Line series of uniformly sampled values with implicit x
+ *
+ * Only the values are kept, in double, together with the x of the first
+ * sample and the sampling interval; half the memory of a point list, and the
+ * x bounds follow from the sample count. The series is always in compact
+ * storage: the visible range is found by index arithmetic and decimated per
+ * pixel column, so it is added to a ChartView like any other LineSeries.
+ */
+class UniformLineSeries : public LineSeries {
+    Q_OBJECT
+
+public:
+    UniformLineSeries();
+
+    /**
+     * @param x0 X of the first sample
+     * @param dx Sampling interval
+     * @param values Y values, shared and not copied
+     */
+    UniformLineSeries(double x0, double dx, const QVector<double>& values);
+    ~UniformLineSeries() override = default;
+
+    /**
+     * @brief Replace the samples
+     * @param x0 X of the first sample
+     * @param dx Sampling interval
+     * @param values Y values, shared and not copied
+     */
+    void setData(double x0, double dx, const QVector<double>& values);
+
+    /**
+     * @brief Does nothing, the series has no point list to fall back to
+     */
+    void setCompactStorage(bool compact) override;
+
+    inline double x0() const { return m_x0; }
+    inline double dx() const { return m_dx; }
+    inline const QVector<double>& values() const { return m_values; }
+    inline double xAt(qsizetype index) const { return m_x0 + index * m_dx; }
+
+    /**
+     * @brief Samples whose x lies within [min, max], as first index and end index
+     */
+    QPair<qsizetype, qsizetype> indexRange(double min, double max) const;
+
+private:
+    double m_x0 = 0;
+    double m_dx = 1;
+    QVector<double> m_values;
+};
+
 /**
  * @brief Enhanced scatter series with additional features
  */
@@ -207,6 +339,24 @@ public:
         emit legendChanged(legend);
     }
 
+    /**
+     * @brief Check if the series is drawn as density map
+     * @return True if density mode is active
+     */
+    bool densityMode() const { return m_density_mode; }
+
+    /**
+     * @brief Get the colour map used in density mode
+     * @return Current colour map
+     */
+    ColorMap colorMap() const { return m_color_map; }
+
+    /**
+     * @brief Check if densities are scaled logarithmically
+     * @return True for log(1 + count) scaling
+     */
+    bool logDensity() const { return m_log_density; }
+
 public slots:
     void setColor(const QColor& color) override;
 
@@ -216,8 +366,32 @@ public slots:
      */
     void showLine(int state);
 
+    /**
+     * @brief Draw the series as screen resolution density map instead of markers
+     *
+     * The points are re-binned whenever the view changes. Density mode is drawn
+     * by the threaded render backend, ChartView switches to it when needed.
+     * @param density True to enable density mode
+     */
+    void setDensityMode(bool density);
+
+    /**
+     * @brief Set the colour map used in density mode
+     * @param map Colour map
+     */
+    void setColorMap(ColorMap map);
+
+    /**
+     * @brief Scale densities logarithmically
+     * @param logarithmic True for log(1 + count) scaling
+     */
+    void setLogDensity(bool logarithmic);
+
 private:
     bool m_show_in_legend = false;
+    bool m_density_mode = false;
+    bool m_log_density = true;
+    ColorMap m_color_map = ColorMap::Viridis;
 
 signals:
     /**
@@ -237,6 +411,11 @@ signals:
      * @param legend Whether series should show in legend
      */
     void legendChanged(bool legend);
+
+    /**
+     * @brief Signal emitted when density mode, colour map or scaling changes
+     */
+    void densityChanged();
 };
 
 /**
@@ -255,16 +434,24 @@ private:
 
 /**
  * @brief Enhanced box plot series for statistical visualizations
+ *
+ * A series holds any number of boxes, box i is placed at x = i. The outliers
+ * of all boxes are collected into one scatter series that ChartView adds next
+ * to the box plot. Box sets are created once; hiding the series keeps them
+ * and colours are set on the series, not per box.
  */
 class BoxPlotSeries : public QBoxPlotSeries {
     Q_OBJECT
 
 public:
+    BoxPlotSeries();
+
     /**
      * @brief Constructor with boxwhisker data
      * @param boxwhisker The boxwhisker data to display
      */
     explicit BoxPlotSeries(const BoxWhisker& boxwhisker);
+    ~BoxPlotSeries() override;
 
     /**
      * @brief Get the series color
@@ -272,6 +459,32 @@ public:
      */
     QColor color() const { return brush().color(); }
 
+    /**
+     * @brief Get the statistics of all boxes
+     * @return One BoxWhisker per box
+     */
+    const QList<BoxWhisker>& boxes() const { return m_boxes; }
+
+    /**
+     * @brief Get the series drawing the outliers of all boxes
+     * @return Scatter series, owned by this series until it is added to a chart
+     */
+    QScatterSeries* outlierSeries() const { return m_outliers; }
+
+    /**
+     * @brief Append a box
+     * @param boxwhisker Statistics of the box
+     * @param label Category label
+     */
+    void addBox(const BoxWhisker& boxwhisker, const QString& label = QString());
+
+    /**
+     * @brief Replace all boxes in one go
+     * @param boxes Statistics, one per box
+     * @param labels Category labels, may be shorter than boxes
+     */
+    void setBoxes(const QList<BoxWhisker>& boxes, const QStringList& labels = QStringList());
+
 public slots:
     /**
      * @brief Set the series color
@@ -287,12 +500,17 @@ public slots:
 
 private:
     /**
-     * @brief Load boxwhisker data into series
+     * @brief Create the box set for one box
      */
-    void loadBoxWhisker();
+    static QBoxSet* createBoxSet(const BoxWhisker& boxwhisker, const QString& label);
 
-    BoxWhisker m_boxwhisker;
-    bool m_visible = true;
+    /**
+     * @brief Outlier points of one box
+     */
+    static QList<QPointF> outlierPoints(const BoxWhisker& boxwhisker, int index);
+
+    QList<BoxWhisker> m_boxes;
+    QPointer<QScatterSeries> m_outliers;
 };
 
 /**
@@ -308,6 +526,225 @@ private:
     bool m_visible = true;
 };
 
+/**
+ * @brief Kernel density of one sample set, drawn as violin or ridge line
+ *
+ * A violin is centered at x = position like box number position of a
+ * BoxPlotSeries, a ridge lies on the baseline y = position. The summary of
+ * the samples is kept as BoxWhisker, so a BoxPlotSeries built from boxWhisker()
+ * overlays the quartiles. Densities are cached per bandwidth; estimate()
+ * computes many series at once in parallel.
+ */
+class ViolinSeries : public QAreaSeries {
+    Q_OBJECT
+
+public:
+    enum class Style {
+        Violin = 0,
+        Ridge = 1
+    };
+
+    /**
+     * @brief Constructor
+     * @param samples Raw samples, implicitly shared
+     * @param position Box index for violins, baseline for ridges
+     * @param style Violin or ridge line
+     */
+    explicit ViolinSeries(const QVector<qreal>& samples, qreal position = 0, Style style = Style::Violin);
+
+    /**
+     * @brief Get the summary of the samples
+     * @return Quartiles, whiskers and outliers
+     */
+    const BoxWhisker& boxWhisker() const { return m_boxwhisker; }
+
+    /**
+     * @brief Get the requested bandwidth
+     * @return Bandwidth, 0 means Silverman's rule
+     */
+    qreal bandwidth() const { return m_bandwidth; }
+
+    /**
+     * @brief Get the bandwidth actually used
+     * @return Bandwidth of the drawn density
+     */
+    qreal effectiveBandwidth() const { return m_bandwidth > 0 ? m_bandwidth : KernelDensity::silvermanBandwidth(m_boxwhisker); }
+
+    qreal position() const { return m_position; }
+    Style style() const { return m_style; }
+
+    /**
+     * @brief Get the series color
+     * @return Current color
+     */
+    QColor color() const { return brush().color(); }
+
+    /**
+     * @brief Set the bandwidth of many series, estimating missing densities in parallel
+     * @param series Series to update
+     * @param bandwidth Bandwidth, 0 for Silverman's rule per series
+     */
+    static void estimate(const QList<ViolinSeries*>& series, qreal bandwidth);
+
+public slots:
+    /**
+     * @brief Set the kernel bandwidth
+     * @param bandwidth Bandwidth, 0 for Silverman's rule
+     */
+    void setBandwidth(qreal bandwidth);
+
+    /**
+     * @brief Set box index or baseline
+     * @param position New position
+     */
+    void setPosition(qreal position);
+
+    /**
+     * @brief Switch between violin and ridge line
+     * @param style New style
+     */
+    void setStyle(Style style);
+
+    /**
+     * @brief Set the series color
+     * @param color New color
+     */
+    void setColor(const QColor& color);
+
+private:
+    /**
+     * @brief Compute the density for a bandwidth, thread safe
+     */
+    KernelDensity computeDensity(qreal bandwidth) const;
+
+    /**
+     * @brief Rebuild the outline from the cached density of the current bandwidth
+     */
+    void updateOutline();
+
+    QVector<qreal> m_samples;
+    BoxWhisker m_boxwhisker;
+    qreal m_min = 0, m_max = 0;
+    qreal m_bandwidth = 0;
+    qreal m_position = 0;
+    Style m_style = Style::Violin;
+    QHash<qreal, KernelDensity> m_density_cache;
+    QLineSeries* m_upper;
+    QLineSeries* m_lower;
+};
+
+/**
+ * @brief Histogram series that is fed with raw samples
+ *
+ * Samples are counted into a fine base Histogram and the bars are derived
+ * from it, so zooming re-bins without touching the samples again. All bars
+ * form a single step outline that is filled as one area. Incoming samples only
+ * update counts, the outline is rebuilt at most once per frame.
+ */
+class HistogramSeries : public QAreaSeries {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param bins Number of base bins
+     * @param min Lower edge of the initial range
+     * @param max Upper edge of the initial range
+     * @param autoExpand Grow the range to samples outside of it
+     */
+    explicit HistogramSeries(int bins = 4096, qreal min = 0, qreal max = 1, bool autoExpand = true);
+
+    /**
+     * @brief Get the underlying histogram
+     * @return Base histogram
+     */
+    const Histogram& histogram() const { return m_histogram; }
+
+    /**
+     * @brief Get the number of bars across the visible range
+     * @return Number of bars
+     */
+    int displayBins() const { return m_display_bins; }
+
+    /**
+     * @brief Get the highest bar with the whole histogram in view
+     * @return Largest count of the display bins spread over the full range
+     */
+    qreal maximumCount() const;
+
+    /**
+     * @brief Get the series color
+     * @return Current color
+     */
+    QColor color() const { return brush().color(); }
+
+    /**
+     * @brief Count a batch of samples
+     * @param samples Values
+     * @param count Number of values
+     */
+    void addSamples(const qreal* samples, qsizetype count);
+
+public slots:
+    /**
+     * @brief Count a single sample
+     * @param sample Value
+     */
+    void addSample(qreal sample);
+
+    /**
+     * @brief Count a batch of samples
+     * @param samples Values
+     */
+    void addSamples(const QVector<qreal>& samples);
+
+    /**
+     * @brief Drop all counts and set a new range
+     * @param min Lower edge
+     * @param max Upper edge
+     */
+    void reset(qreal min, qreal max);
+
+    /**
+     * @brief Set the number of bars across the visible range
+     * @param bins Number of bars
+     */
+    void setDisplayBins(int bins);
+
+    /**
+     * @brief Set the visible range the bars are spread over
+     *
+     * ChartView connects this to the range of the x axis.
+     * @param min Lower edge
+     * @param max Upper edge
+     */
+    void setViewRange(qreal min, qreal max);
+
+    /**
+     * @brief Set the series color
+     * @param color New color
+     */
+    void setColor(const QColor& color);
+
+private:
+    /**
+     * @brief Rebuild the outline on the next frame
+     */
+    void scheduleUpdate();
+
+    /**
+     * @brief Rebin and replace the outline in one go
+     */
+    void updateOutline();
+
+    Histogram m_histogram;
+    QLineSeries* m_outline;
+    QTimer m_update_timer;
+    int m_display_bins = 100;
+    qreal m_view_min = 0, m_view_max = 0;
+    bool m_has_view = false;
+};
+
 /**
  * @brief Update series and list item color in ListChart
  *
@@ -316,3 +753,11 @@ private:
  * @param color New color to apply
  */
 void updateSeriesColor(QListWidgetItem* item, QAbstractSeries* series, const QColor& color);
+
+/**
+ * @brief Update the color of a series of any supported type
+ *
+ * @param series Series to update
+ * @param color New color to apply
+ */
+void updateSeriesColor(QAbstractSeries* series, const QColor& color);
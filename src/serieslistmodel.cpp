@@ -0,0 +1,246 @@
+/*
+ * CuteCharts - Model and delegate for the ListChart series lists
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtGui/QPainter>
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QStyle>
+
+#include "serieslistmodel.h"
+
+SeriesListModel::SeriesListModel(bool editable, QObject* parent)
+    : QAbstractListModel(parent)
+    , m_editable(editable)
+{
+    m_change_timer.setSingleShot(true);
+    m_change_timer.setInterval(0);
+    connect(&m_change_timer, &QTimer::timeout, this, &SeriesListModel::flushChanges);
+}
+
+int SeriesListModel::append(const Entry& entry)
+{
+    const int row = m_entries.size();
+    // Rows past what the view has asked for wait for fetchMore()
+    const bool visible = row < m_limit;
+    if (visible)
+        beginInsertRows(QModelIndex(), row, row);
+
+    m_entries.append(entry);
+    if (!m_group_rows.contains(entry.group))
+        m_group_rows.insert(entry.group, row);
+    m_name_rows.insert(entry.name, row);
+
+    if (visible) {
+        m_loaded = row + 1;
+        endInsertRows();
+    }
+    return row;
+}
+
+void SeriesListModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_group_rows.clear();
+    m_name_rows.clear();
+    m_loaded = 0;
+    m_limit = FetchBatch;
+    m_changed_first = m_changed_last = -1;
+    m_change_timer.stop();
+    endResetModel();
+}
+
+void SeriesListModel::setColor(int row, const QColor& color)
+{
+    if (row < 0 || row >= m_entries.size() || m_entries[row].color == color)
+        return;
+    m_entries[row].color = color;
+    markChanged(row);
+}
+
+void SeriesListModel::setName(int row, const QString& name)
+{
+    if (row < 0 || row >= m_entries.size() || m_entries[row].name == name)
+        return;
+
+    m_name_rows.remove(m_entries[row].name, row);
+    m_name_rows.insert(name, row);
+    m_entries[row].name = name;
+    markChanged(row);
+}
+
+void SeriesListModel::setGroupColor(int group, const QColor& color)
+{
+    setColor(rowOfGroup(group), color);
+}
+
+int SeriesListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_loaded;
+}
+
+QVariant SeriesListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_loaded)
+        return QVariant();
+
+    const Entry& entry = m_entries[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        return entry.name;
+    case Qt::BackgroundRole:
+        return entry.color.isValid() ? QVariant(entry.color) : QVariant();
+    case GroupRole:
+        return entry.group;
+    case SeriesRole:
+        return QVariant::fromValue(entry.series.data());
+    default:
+        return QVariant();
+    }
+}
+
+bool SeriesListModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!m_editable || role != Qt::EditRole || !index.isValid() || index.row() >= m_loaded)
+        return false;
+
+    const QString name = value.toString();
+    if (name == m_entries[index.row()].name)
+        return false;
+
+    setName(index.row(), name);
+    emit nameEdited(m_entries[index.row()].group, name);
+    return true;
+}
+
+Qt::ItemFlags SeriesListModel::flags(const QModelIndex& index) const
+{
+    Qt::ItemFlags flags = QAbstractListModel::flags(index);
+    if (m_editable && index.isValid())
+        flags |= Qt::ItemIsEditable;
+    return flags;
+}
+
+bool SeriesListModel::canFetchMore(const QModelIndex& parent) const
+{
+    return !parent.isValid() && m_loaded < m_entries.size();
+}
+
+void SeriesListModel::fetchMore(const QModelIndex& parent)
+{
+    if (parent.isValid() || m_loaded >= m_entries.size())
+        return;
+
+    m_limit = m_loaded + FetchBatch;
+    const int last = qMin(m_limit, int(m_entries.size())) - 1;
+    beginInsertRows(QModelIndex(), m_loaded, last);
+    m_loaded = last + 1;
+    endInsertRows();
+}
+
+void SeriesListModel::markChanged(int row)
+{
+    // Rows the view does not know yet are read fresh once fetched
+    if (row >= m_loaded)
+        return;
+
+    if (m_changed_first < 0) {
+        m_changed_first = m_changed_last = row;
+    } else {
+        m_changed_first = qMin(m_changed_first, row);
+        m_changed_last = qMax(m_changed_last, row);
+    }
+    if (!m_change_timer.isActive())
+        m_change_timer.start();
+}
+
+void SeriesListModel::flushChanges()
+{
+    if (m_changed_first < 0)
+        return;
+
+    const int first = m_changed_first;
+    const int last = qMin(m_changed_last, m_loaded - 1);
+    m_changed_first = m_changed_last = -1;
+    if (first <= last)
+        emit dataChanged(index(first), index(last), { Qt::DisplayRole, Qt::EditRole, Qt::BackgroundRole });
+}
+
+SeriesListDelegate::SeriesListDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+const SeriesListDelegate::Layout& SeriesListDelegate::layout(const QString& name, const QColor& background, const QFont& font) const
+{
+    if (font != m_font) {
+        m_cache.clear();
+        m_font = font;
+    }
+
+    const QPair<QString, QRgb> key(name, background.rgba());
+    auto it = m_cache.find(key);
+    if (it != m_cache.end())
+        return it.value();
+
+    if (m_cache.size() >= CacheLimit)
+        m_cache.clear();
+
+    Layout entry;
+    entry.text.setText(name);
+    entry.text.setTextFormat(Qt::AutoText);
+    entry.text.setPerformanceHint(QStaticText::AggressiveCaching);
+    entry.text.prepare(QTransform(), font);
+    // Dark series colours get light text to stay readable
+    entry.pen = background.isValid() && background.alpha() > 0 && background.lightnessF() < 0.45 ? QColor(Qt::white) : QColor(Qt::black);
+    return m_cache.insert(key, entry).value();
+}
+
+void SeriesListDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    QStyleOptionViewItem options = option;
+    initStyleOption(&options, index);
+
+    const QString name = options.text;
+    const QColor background = index.data(Qt::BackgroundRole).value<QColor>();
+
+    painter->save();
+
+    options.text = QString();
+    const QStyle* style = options.widget ? options.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &options, painter, options.widget);
+
+    const Layout& text = layout(name, background, options.font);
+    const QRect rect = options.rect.adjusted(4, 0, -4, 0);
+    const QSizeF size = text.text.size();
+    painter->setClipRect(rect);
+    painter->setFont(options.font);
+    painter->setPen(options.state.testFlag(QStyle::State_Selected) ? options.palette.color(QPalette::HighlightedText) : text.pen);
+    painter->drawStaticText(QPointF(rect.left(), rect.top() + (rect.height() - size.height()) / 2.0), text.text);
+
+    painter->restore();
+}
+
+QSize SeriesListDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    Q_UNUSED(index)
+    // Uniform rows, the text is not measured
+    return QSize(150, option.fontMetrics.height() * 1.5);
+}
@@ -0,0 +1,171 @@
+/*
+ * CuteCharts - Model and delegate for the ListChart series lists
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCharts/QAbstractSeries>
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+
+#include <QtGui/QColor>
+#include <QtGui/QStaticText>
+
+#include <QtWidgets/QStyledItemDelegate>
+
+/**
+ * @brief Flat list of series names and colours for a QListView
+ *
+ * Rows are handed to the view in batches through canFetchMore()/fetchMore(),
+ * so adding thousands of series only inserts what the view asks for. Colour
+ * and name changes are collected and reported as one dataChanged() range on
+ * the next event loop pass.
+ */
+class SeriesListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        GroupRole = Qt::UserRole, ///< Index passed to ListChart::addSeries(), -1 for plain names
+        SeriesRole ///< QAbstractSeries* of the row, may be null
+    };
+
+    static constexpr int FetchBatch = 256;
+
+    struct Entry {
+        QString name;
+        QColor color;
+        int group = -1;
+        QPointer<QAbstractSeries> series;
+    };
+
+    /**
+     * @brief Constructor
+     * @param editable Whether names can be edited in the view
+     * @param parent Parent object
+     */
+    explicit SeriesListModel(bool editable, QObject* parent = nullptr);
+
+    /**
+     * @brief Append an entry, it becomes a row once the view fetches that far
+     * @param entry Entry to add
+     * @return Position of the entry
+     */
+    int append(const Entry& entry);
+
+    void clear();
+
+    /**
+     * @brief Number of entries, including those not fetched yet
+     */
+    inline int entryCount() const { return m_entries.size(); }
+    inline const Entry& entry(int row) const { return m_entries[row]; }
+
+    /**
+     * @brief Position of the first entry of a group
+     * @return Position or -1
+     */
+    inline int rowOfGroup(int group) const { return m_group_rows.value(group, -1); }
+
+    /**
+     * @brief Positions of all entries with that name
+     */
+    inline QList<int> rowsOfName(const QString& name) const { return m_name_rows.values(name); }
+    inline bool contains(const QString& name) const { return m_name_rows.contains(name); }
+
+    void setColor(int row, const QColor& color);
+    void setName(int row, const QString& name);
+
+    /**
+     * @brief Set the colour of the first entry of a group
+     */
+    void setGroupColor(int group, const QColor& color);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+signals:
+    /**
+     * @brief A name was edited in the view
+     * @param group Group of the edited row
+     * @param name New name
+     */
+    void nameEdited(int group, const QString& name);
+
+private:
+    /**
+     * @brief Widen the pending dataChanged() range by a row
+     */
+    void markChanged(int row);
+
+    void flushChanges();
+
+    QVector<Entry> m_entries;
+    QHash<int, int> m_group_rows;
+    QMultiHash<QString, int> m_name_rows;
+    int m_loaded = 0, m_limit = FetchBatch;
+    int m_changed_first = -1, m_changed_last = -1;
+    QTimer m_change_timer;
+    bool m_editable;
+};
+
+/**
+ * @brief Paints the series list rows from cached text layouts
+ *
+ * Names may contain the HTML subset understood by QStaticText. The layout of
+ * each name is built once per name and background colour and reused on
+ * every repaint; all rows share one height, which lets the view skip asking
+ * for size hints of rows it does not show.
+ */
+class SeriesListDelegate : public QStyledItemDelegate {
+public:
+    /**
+     * @brief Constructor
+     * @param parent Parent object
+     */
+    explicit SeriesListDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    struct Layout {
+        QStaticText text;
+        QColor pen;
+    };
+
+    /**
+     * @brief Cached layout of a name drawn on a background
+     */
+    const Layout& layout(const QString& name, const QColor& background, const QFont& font) const;
+
+    static constexpr int CacheLimit = 4096;
+
+    mutable QHash<QPair<QString, QRgb>, Layout> m_cache;
+    mutable QFont m_font;
+};
@@ -0,0 +1,149 @@
+/*
+ * CuteCharts - Indexed registry of series groups
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "seriesregistry.h"
+
+SeriesRegistry::Id SeriesRegistry::add(QAbstractSeries* series, int group, const QString& name, const QColor& color)
+{
+    if (!series)
+        return 0;
+    if (Id existing = id(series))
+        return existing;
+
+    const Id id = m_next_id++;
+    m_entries.insert(id, Entry{ series, series, group });
+    m_ids.insert(series, id);
+
+    auto it = m_groups.find(group);
+    if (it == m_groups.end()) {
+        Group created;
+        created.index = group;
+        created.name = name;
+        created.color = color;
+        it = m_groups.insert(group, created);
+        m_names[name].append(group);
+        m_order.append(group);
+    }
+    it->members.append(id);
+    return id;
+}
+
+void SeriesRegistry::remove(Id id)
+{
+    auto entry = m_entries.find(id);
+    if (entry == m_entries.end())
+        return;
+
+    const int index = entry->group;
+    m_ids.remove(entry->key);
+    m_entries.erase(entry);
+
+    auto group = m_groups.find(index);
+    if (group == m_groups.end())
+        return;
+    group->members.removeOne(id);
+    if (!group->members.isEmpty())
+        return;
+
+    QVector<int>& named = m_names[group->name];
+    named.removeOne(index);
+    if (named.isEmpty())
+        m_names.remove(group->name);
+    m_order.removeOne(index);
+    m_groups.erase(group);
+}
+
+void SeriesRegistry::clear()
+{
+    m_entries.clear();
+    m_ids.clear();
+    m_groups.clear();
+    m_names.clear();
+    m_order.clear();
+}
+
+QAbstractSeries* SeriesRegistry::series(Id id) const
+{
+    auto it = m_entries.constFind(id);
+    return it == m_entries.cend() ? nullptr : it->series.data();
+}
+
+int SeriesRegistry::groupOf(const QAbstractSeries* series) const
+{
+    auto it = m_entries.constFind(id(series));
+    return it == m_entries.cend() ? -1 : it->group;
+}
+
+QVector<int> SeriesRegistry::groupsWhere(const std::function<bool(const Group&)>& predicate) const
+{
+    QVector<int> result;
+    for (int index : m_order) {
+        if (predicate(m_groups.find(index).value()))
+            result.append(index);
+    }
+    return result;
+}
+
+QList<QAbstractSeries*> SeriesRegistry::groupSeries(int group) const
+{
+    QList<QAbstractSeries*> result;
+    auto it = m_groups.constFind(group);
+    if (it == m_groups.cend())
+        return result;
+
+    result.reserve(it->members.size());
+    for (Id id : it->members) {
+        if (QAbstractSeries* series = this->series(id))
+            result.append(series);
+    }
+    return result;
+}
+
+bool SeriesRegistry::setVisible(int group, bool visible)
+{
+    auto it = m_groups.find(group);
+    if (it == m_groups.end() || it->visible == visible)
+        return false;
+    it->visible = visible;
+    return true;
+}
+
+bool SeriesRegistry::setColor(int group, const QColor& color)
+{
+    auto it = m_groups.find(group);
+    if (it == m_groups.end() || it->color == color)
+        return false;
+    it->color = color;
+    return true;
+}
+
+bool SeriesRegistry::setName(int group, const QString& name)
+{
+    auto it = m_groups.find(group);
+    if (it == m_groups.end() || it->name == name)
+        return false;
+
+    QVector<int>& named = m_names[it->name];
+    named.removeOne(group);
+    if (named.isEmpty())
+        m_names.remove(it->name);
+    m_names[name].append(group);
+    it->name = name;
+    return true;
+}
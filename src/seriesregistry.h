@@ -0,0 +1,134 @@
+/*
+ * CuteCharts - Indexed registry of series groups
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCharts/QAbstractSeries>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPointer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <QtGui/QColor>
+
+#include <functional>
+
+/**
+ * @brief Series of a ListChart organised in groups
+ *
+ * Every series gets an id that stays valid until it is removed. Groups are
+ * found by index, by name and from any of their series through hash lookups,
+ * so toggling or recolouring a group does not depend on the number of
+ * series in the chart. Groups keep the order in which they were added.
+ */
+class SeriesRegistry {
+public:
+    using Id = quint64;
+
+    struct Group {
+        int index = -1; ///< Index passed to ListChart::addSeries()
+        QString name;
+        QColor color;
+        bool visible = true;
+        QVector<Id> members;
+    };
+
+    /**
+     * @brief Register a series
+     * @param series Series to add
+     * @param group Group index
+     * @param name Name of the group if it is new
+     * @param color Colour of the group if it is new
+     * @return Id of the series, an already registered series keeps its id
+     */
+    Id add(QAbstractSeries* series, int group, const QString& name, const QColor& color = QColor());
+
+    /**
+     * @brief Forget a series, a group without series is removed as well
+     */
+    void remove(Id id);
+
+    void clear();
+
+    /**
+     * @brief Id of a series
+     * @return Id or 0 if the series is not registered
+     */
+    inline Id id(const QAbstractSeries* series) const { return m_ids.value(series, 0); }
+
+    QAbstractSeries* series(Id id) const;
+
+    /**
+     * @brief Group index of a series
+     * @return Group index or -1
+     */
+    int groupOf(const QAbstractSeries* series) const;
+
+    inline bool contains(int group) const { return m_groups.contains(group); }
+
+    /**
+     * @brief Group by index, must exist
+     */
+    inline const Group& group(int index) const { return m_groups.find(index).value(); }
+
+    /**
+     * @brief Group indices in insertion order
+     */
+    inline const QVector<int>& groups() const { return m_order; }
+
+    /**
+     * @brief Groups whose name matches exactly
+     */
+    inline QVector<int> groupsNamed(const QString& name) const { return m_names.value(name); }
+
+    /**
+     * @brief Groups accepted by a predicate
+     * @param predicate Called once per group in insertion order
+     */
+    QVector<int> groupsWhere(const std::function<bool(const Group&)>& predicate) const;
+
+    /**
+     * @brief Series of a group that still exist
+     */
+    QList<QAbstractSeries*> groupSeries(int group) const;
+
+    /**
+     * @brief Update the stored state of a group
+     * @return True if the value changed
+     */
+    bool setVisible(int group, bool visible);
+    bool setColor(int group, const QColor& color);
+    bool setName(int group, const QString& name);
+
+private:
+    struct Entry {
+        QPointer<QAbstractSeries> series;
+        const QAbstractSeries* key = nullptr; ///< Reverse lookup key, survives the series
+        int group = -1;
+    };
+
+    QHash<Id, Entry> m_entries;
+    QHash<const QAbstractSeries*, Id> m_ids;
+    QHash<int, Group> m_groups;
+    QHash<QString, QVector<int>> m_names;
+    QVector<int> m_order;
+    Id m_next_id = 1;
+};
@@ -0,0 +1,207 @@
+/*
+ * CuteCharts - Closed-form tick generation for value axes
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QtCharts/QValueAxis>
+
+#include <QtGui/QFontMetricsF>
+
+#include <cmath>
+#include <utility>
+
+#include "tickengine.h"
+
+namespace {
+// Interval candidates per decade with the minor ticks between two majors and
+// the decimals they add to the decade exponent
+constexpr int MantissaCount = 5;
+constexpr double NiceMantissa[MantissaCount] = { 1, 2, 2.5, 5, 10 };
+constexpr int MinorTicks[MantissaCount] = { 4, 3, 4, 4, 4 };
+constexpr int ExtraDecimals[MantissaCount] = { 0, 0, 1, 0, -1 };
+
+constexpr int PowerOffset = 22;
+constexpr double PowersOfTen[] = {
+    1e-22, 1e-21, 1e-20, 1e-19, 1e-18, 1e-17, 1e-16, 1e-15,
+    1e-14, 1e-13, 1e-12, 1e-11, 1e-10, 1e-9, 1e-8, 1e-7,
+    1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1,
+    1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+    1e18, 1e19, 1e20, 1e21, 1e22
+};
+constexpr int PowerCount = int(sizeof(PowersOfTen) / sizeof(PowersOfTen[0]));
+
+// Free space between two horizontal labels, in pixels
+constexpr qreal LabelGap = 8;
+
+/**
+ * @brief Exact power of ten where the table has it
+ */
+double powerOfTen(int exponent)
+{
+    const int index = exponent + PowerOffset;
+    if (index >= 0 && index < PowerCount)
+        return PowersOfTen[index];
+    return std::pow(10.0, exponent);
+}
+
+/**
+ * @brief Decimal exponent of a positive value, corrected where log10 rounds across a power
+ */
+int decade(double value)
+{
+    int exponent = int(std::floor(std::log10(value)));
+    if (value >= powerOfTen(exponent + 1))
+        ++exponent;
+    else if (value < powerOfTen(exponent))
+        --exponent;
+    return exponent;
+}
+}
+
+QVector<double> TickLayout::ticks() const
+{
+    QVector<double> result(count);
+    for (int i = 0; i < count; ++i)
+        result[i] = anchor + i * interval;
+    return result;
+}
+
+QString TickLayout::label(double value) const
+{
+    return QString::number(value, scientific ? 'e' : 'f', decimals);
+}
+
+TickLayout TickEngine::compute(double min, double max, int maxTicks)
+{
+    TickLayout layout;
+    layout.format = QStringLiteral("%.2f");
+    layout.decimals = 2;
+    if (!std::isfinite(min) || !std::isfinite(max))
+        return layout;
+    if (max < min)
+        std::swap(min, max);
+
+    double span = max - min;
+    if (span <= 0)
+        span = min != 0 ? std::abs(min) / 10 : 1;
+
+    const double wanted = span / qMax(1, maxTicks - 1);
+    const int exponent = decade(wanted);
+    const double power = powerOfTen(exponent);
+    int index = 0;
+    while (index < MantissaCount - 1 && NiceMantissa[index] * power < wanted * (1 - 1e-12))
+        ++index;
+
+    // Ticks are the integer multiples of the interval inside the range
+    const double interval = NiceMantissa[index] * power;
+    const double first = std::ceil(min / interval - 1e-9);
+    const double last = std::floor(max / interval + 1e-9);
+    layout.interval = interval;
+    layout.anchor = first * interval + 0.0; // no negative zero
+    layout.count = int(qBound(0.0, last - first + 1, 1e6));
+    layout.minorCount = MinorTicks[index];
+
+    // Exponent notation once fixed labels would get long
+    const double largest = qMax(std::abs(min), std::abs(max));
+    const int magnitude = largest > 0 ? decade(largest) : 0;
+    layout.scientific = magnitude >= 6 || magnitude <= -4;
+    if (layout.scientific)
+        layout.decimals = qBound(0, magnitude - exponent + ExtraDecimals[index], 6);
+    else
+        layout.decimals = qMax(0, -exponent + ExtraDecimals[index]);
+    layout.format = QStringLiteral("%.%1%2").arg(layout.decimals).arg(layout.scientific ? 'e' : 'f');
+    return layout;
+}
+
+TickLayout TickEngine::layout(double min, double max, qreal pixels, const QFont& font, Qt::Orientation orientation)
+{
+    const Key key{ min, max, int(std::lround(pixels)), font.key(), int(orientation) };
+    auto it = m_layouts.constFind(key);
+    if (it != m_layouts.cend())
+        return it.value();
+
+    const Glyphs& glyph = glyphs(font);
+    TickLayout result;
+    if (orientation == Qt::Vertical || !(max > min) || pixels <= 0) {
+        // Stacked labels only need their line height
+        result = compute(min, max, qMax(2, int(pixels / (2 * glyph.height)) + 1));
+    } else {
+        // Guess from a six digit label, then shrink until the widest label fits between two ticks
+        int maxTicks = qMax(2, int(pixels / (6 * glyph.advance['0'] + LabelGap)) + 1);
+        for (int pass = 0; pass < 3; ++pass) {
+            result = compute(min, max, maxTicks);
+            const double last = result.anchor + (result.count - 1) * result.interval;
+            const qreal widest = qMax(labelWidth(result.label(result.anchor), font), labelWidth(result.label(last), font)) + LabelGap;
+            if (pixels * result.interval / (max - min) >= widest || maxTicks == 2)
+                break;
+            maxTicks = qBound(2, int(pixels / widest) + 1, maxTicks - 1);
+        }
+    }
+
+    if (m_layouts.size() > 1024)
+        m_layouts.clear();
+    m_layouts.insert(key, result);
+    return result;
+}
+
+qreal TickEngine::labelWidth(const QString& text, const QFont& font)
+{
+    const Glyphs& glyph = glyphs(font);
+    qreal width = 0;
+    for (const QChar& character : text) {
+        const ushort code = character.unicode();
+        width += size_t(code) < glyph.advance.size() ? glyph.advance[code] : glyph.fallback;
+    }
+    return width;
+}
+
+bool TickEngine::apply(QValueAxis* axis, const TickLayout& layout, bool format)
+{
+    // Fixed tick counts are a choice of the user
+    if (!axis || layout.count == 0 || axis->tickType() != QValueAxis::TicksDynamic)
+        return false;
+
+    axis->setTickAnchor(layout.anchor);
+    axis->setTickInterval(layout.interval);
+    axis->setMinorTickCount(layout.minorCount);
+    if (format)
+        axis->setLabelFormat(layout.format);
+    return true;
+}
+
+void TickEngine::clear()
+{
+    m_layouts.clear();
+    m_glyphs.clear();
+}
+
+const TickEngine::Glyphs& TickEngine::glyphs(const QFont& font)
+{
+    const QString key = font.key();
+    auto it = m_glyphs.constFind(key);
+    if (it != m_glyphs.cend())
+        return it.value();
+
+    Glyphs glyph;
+    const QFontMetricsF metrics(font);
+    for (int code = 32; code < int(glyph.advance.size()); ++code)
+        glyph.advance[size_t(code)] = metrics.horizontalAdvance(QChar(code));
+    glyph.fallback = metrics.averageCharWidth();
+    glyph.height = metrics.height();
+    return m_glyphs.insert(key, glyph).value();
+}
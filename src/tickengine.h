@@ -0,0 +1,135 @@
+/*
+ * CuteCharts - Closed-form tick generation for value axes
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <QtGui/QFont>
+
+#include <array>
+
+class QValueAxis;
+
+/**
+ * @brief Major and minor ticks of an axis range
+ */
+struct TickLayout {
+    double anchor = 0; ///< First major tick inside the range
+    double interval = 1; ///< Distance of the major ticks
+    int count = 0; ///< Major ticks inside the range
+    int minorCount = 0; ///< Minor ticks between two major ticks
+    int decimals = 0; ///< Decimals the labels need, of the mantissa in exponent notation
+    bool scientific = false; ///< Labels in exponent notation
+    QString format; ///< printf format for QValueAxis::setLabelFormat()
+
+    /**
+     * @brief Positions of the major ticks
+     */
+    QVector<double> ticks() const;
+
+    /**
+     * @brief Label text of a value, as the format prints it
+     */
+    QString label(double value) const;
+};
+
+/**
+ * @brief Nice ticks without search loops
+ *
+ * The interval is the smallest of 1, 2, 2.5 and 5 times a power of ten that
+ * covers the range with the wanted number of intervals; the exponent comes
+ * from one logarithm and the ticks are integer multiples of the interval, so
+ * a layout costs the same for any range. Minor tick counts and decimals per
+ * mantissa come from constant tables.
+ *
+ * layout() also fits the tick count to the axis length: labels are measured
+ * with advance widths cached per font, and the count shrinks until the widest
+ * label fits between two ticks. Results are cached by range, length and font.
+ */
+class TickEngine {
+public:
+    /**
+     * @brief Ticks for a range
+     * @param min Lower end of the range
+     * @param max Upper end of the range
+     * @param maxTicks Highest number of major ticks wanted
+     */
+    static TickLayout compute(double min, double max, int maxTicks);
+
+    /**
+     * @brief Ticks for a range whose labels do not overlap
+     * @param min Lower end of the range
+     * @param max Upper end of the range
+     * @param pixels Length of the axis
+     * @param font Font of the tick labels
+     * @param orientation Qt::Horizontal for labels side by side
+     */
+    TickLayout layout(double min, double max, qreal pixels, const QFont& font, Qt::Orientation orientation);
+
+    /**
+     * @brief Width of a label, from the cached advances of its characters
+     */
+    qreal labelWidth(const QString& text, const QFont& font);
+
+    /**
+     * @brief Set anchor, interval and minor ticks of an axis with dynamic ticks
+     * @param axis The axis
+     * @param layout Ticks for its current range
+     * @param format Also set the label format; its decimals only fit the layout's own ticks,
+     *        so axes with fixed ticks keep their format
+     * @return True if the ticks were applied
+     */
+    static bool apply(QValueAxis* axis, const TickLayout& layout, bool format);
+
+    void clear();
+
+private:
+    struct Key {
+        double min, max;
+        int pixels;
+        QString font;
+        int orientation;
+
+        bool operator==(const Key& other) const
+        {
+            return min == other.min && max == other.max && pixels == other.pixels && orientation == other.orientation && font == other.font;
+        }
+        friend size_t qHash(const Key& key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.min, key.max, key.pixels, key.font, key.orientation);
+        }
+    };
+
+    /**
+     * @brief Advances of the characters printf produces for numbers, and the line height
+     */
+    struct Glyphs {
+        std::array<qreal, 128> advance{};
+        qreal fallback = 0;
+        qreal height = 0;
+    };
+
+    const Glyphs& glyphs(const QFont& font);
+
+    QHash<Key, TickLayout> m_layouts;
+    QHash<QString, Glyphs> m_glyphs;
+};
@@ -35,22 +35,18 @@ namespace ChartTools {
 inline qreal ScaleToNormalizedRange(qreal value, qreal& pow)
 {
     pow = 1.0;
-    if (value == 0.0) {
-        return 0.0;
+    if (value == 0.0 || !std::isfinite(value)) {
+        return value;
     }
 
-    if (qAbs(value) < 1.0) {
-        while (qAbs(value) < 1.0) {
-            pow /= 10.0;
-            value *= 10.0;
-        }
-    } else if (qAbs(value) >= 10.0) {
-        while (qAbs(value) >= 10.0) {
-            pow *= 10.0;
-            value /= 10.0;
-        }
+    // One logarithm instead of repeated division, corrected where log10 rounds across a power
+    pow = std::pow(10.0, std::floor(std::log10(qAbs(value))));
+    if (qAbs(value) / pow >= 10.0) {
+        pow *= 10.0;
+    } else if (qAbs(value) / pow < 1.0) {
+        pow /= 10.0;
     }
-    return value;
+    return value / pow;
 }
 
 /**
@@ -202,12 +198,8 @@ inline void IdealInterval(qreal& min, qreal& max, qreal& start, qreal& step)
 
     start = min;
 
-    // Adjust max to align with step
-    qreal adjustedMax = start;
-    while (adjustedMax < max) {
-        adjustedMax += step;
-    }
-    max = adjustedMax;
+    // Align max to the next step in closed form
+    max = max > start ? start + std::ceil((max - start) / step) * step : start;
 }
 
 /**
@@ -0,0 +1,125 @@
+/*
+ * CuteCharts - Undo and redo of viewports with their cached derived state
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdlib>
+
+#include "zoomhistory.h"
+
+void ZoomFrame::setPlotArea(const QRectF& area)
+{
+    if (area == plotArea)
+        return;
+    plotArea = area;
+    xTicks = Ticks();
+    yTicks = Ticks();
+    image = QImage();
+    imageTransform = RenderTransform();
+    imageKey = 0;
+    labels = CalloutLayout::Placement();
+    decimations.clear();
+}
+
+bool ZoomHistory::record(double x_min, double x_max, double y_min, double y_max)
+{
+    if (m_index >= 0 && m_frames[m_index].matches(x_min, x_max, y_min, y_max))
+        return false;
+
+    m_frames.resize(m_index + 1);
+    ZoomFrame frame;
+    frame.xMin = x_min;
+    frame.xMax = x_max;
+    frame.yMin = y_min;
+    frame.yMax = y_max;
+    m_frames.append(frame);
+    if (m_frames.size() > m_limit)
+        m_frames.remove(0, m_frames.size() - m_limit);
+    m_index = m_frames.size() - 1;
+    return true;
+}
+
+const ZoomFrame* ZoomHistory::back()
+{
+    if (!canGoBack())
+        return nullptr;
+    return &m_frames[--m_index];
+}
+
+const ZoomFrame* ZoomHistory::forward()
+{
+    if (!canGoForward())
+        return nullptr;
+    return &m_frames[++m_index];
+}
+
+ZoomFrame* ZoomHistory::current(double x_min, double x_max, double y_min, double y_max)
+{
+    if (m_index < 0 || !m_frames[m_index].matches(x_min, x_max, y_min, y_max))
+        return nullptr;
+    return &m_frames[m_index];
+}
+
+void ZoomHistory::storeImage(ZoomFrame* frame, const QImage& image, const RenderTransform& transform, quint64 key)
+{
+    if (!frame)
+        return;
+    frame->image = image;
+    frame->imageTransform = transform;
+    frame->imageKey = key;
+    trimImages();
+}
+
+void ZoomHistory::setLimit(int limit)
+{
+    m_limit = qMax(1, limit);
+    if (m_frames.size() <= m_limit)
+        return;
+
+    // Keep the frames around the current one
+    const int first = qBound(0, m_index - m_limit / 2, int(m_frames.size()) - m_limit);
+    m_frames = m_frames.mid(first, m_limit);
+    m_index -= first;
+}
+
+void ZoomHistory::clear()
+{
+    m_frames.clear();
+    m_index = -1;
+}
+
+void ZoomHistory::trimImages()
+{
+    qsizetype used = 0;
+    for (const ZoomFrame& frame : qAsConst(m_frames))
+        used += frame.image.sizeInBytes();
+
+    while (used > m_image_budget) {
+        int furthest = -1;
+        for (int i = 0; i < m_frames.size(); ++i) {
+            if (i == m_index || m_frames[i].image.isNull())
+                continue;
+            if (furthest < 0 || std::abs(i - m_index) > std::abs(furthest - m_index))
+                furthest = i;
+        }
+        if (furthest < 0)
+            break;
+        used -= m_frames[furthest].image.sizeInBytes();
+        m_frames[furthest].image = QImage();
+        m_frames[furthest].imageKey = 0;
+    }
+}
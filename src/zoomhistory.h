@@ -0,0 +1,145 @@
+/*
+ * CuteCharts - Undo and redo of viewports with their cached derived state
+ * Copyright (C) 2023 Conrad Hübler <Conrad.Huebler@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include <QtGui/QImage>
+
+#include "calloutlayout.h"
+#include "renderpipeline.h"
+#include "tickengine.h"
+
+/**
+ * @brief One viewport of the zoom history
+ *
+ * Besides the axis ranges a frame keeps what was derived from them: the tick
+ * layouts, the rendered series frame of the threaded backend, the decimated
+ * points of series in compact storage and the callout placement. Those are
+ * filled in as they get computed and are only valid for the plot area they
+ * were computed with; the plot area changing drops them.
+ */
+struct ZoomFrame {
+    struct Ticks {
+        TickLayout layout;
+        QString font; ///< QFont::key() of the tick labels
+        bool valid = false;
+    };
+
+    /**
+     * @brief Points a series in compact storage was decimated to for this viewport
+     */
+    struct Decimation {
+        quint64 revision = 0; ///< LineSeries::samplesRevision() of the samples
+        double min = 0, max = 0; ///< Visible x range in data values
+        int columns = 0;
+        QList<QPointF> points;
+
+        inline bool matches(quint64 samples, double x_min, double x_max, int pixels) const
+        {
+            return revision == samples && min == x_min && max == x_max && columns == pixels;
+        }
+    };
+
+    double xMin = 0, xMax = 0, yMin = 0, yMax = 0;
+
+    QRectF plotArea;
+    Ticks xTicks, yTicks;
+    QImage image;
+    RenderTransform imageTransform;
+    quint64 imageKey = 0; ///< Visible series and their revisions the image shows
+    CalloutLayout::Placement labels;
+    QHash<const QObject*, Decimation> decimations; ///< Keyed by series
+
+    inline bool matches(double x_min, double x_max, double y_min, double y_max) const
+    {
+        return xMin == x_min && xMax == x_max && yMin == y_min && yMax == y_max;
+    }
+
+    /**
+     * @brief Drop the derived state unless it belongs to area
+     */
+    void setPlotArea(const QRectF& area);
+};
+
+/**
+ * @brief Back and forward navigation through the viewports of a chart
+ *
+ * Recording a viewport drops everything ahead of the current frame, as in a
+ * browser history; recording the current viewport again does nothing, so
+ * restoring a frame does not add one. Rendered images are the only large
+ * part of a frame, they are kept within a memory budget, those furthest from
+ * the current frame go first.
+ */
+class ZoomHistory {
+public:
+    /**
+     * @brief Make a viewport the current frame
+     * @return True if a frame was added
+     */
+    bool record(double x_min, double x_max, double y_min, double y_max);
+
+    /**
+     * @brief Step back
+     * @return The frame to restore, or nullptr at the start of the history
+     */
+    const ZoomFrame* back();
+
+    /**
+     * @brief Step forward
+     * @return The frame to restore, or nullptr at the end of the history
+     */
+    const ZoomFrame* forward();
+
+    /**
+     * @brief Current frame if it shows the given ranges
+     */
+    ZoomFrame* current(double x_min, double x_max, double y_min, double y_max);
+
+    inline bool canGoBack() const { return m_index > 0; }
+    inline bool canGoForward() const { return m_index + 1 < m_frames.size(); }
+    inline int size() const { return int(m_frames.size()); }
+
+    /**
+     * @brief Keep a rendered image in a frame, trimming images to the budget
+     */
+    void storeImage(ZoomFrame* frame, const QImage& image, const RenderTransform& transform, quint64 key);
+
+    /**
+     * @brief Highest number of frames, the oldest go first
+     */
+    void setLimit(int limit);
+    inline int limit() const { return m_limit; }
+
+    void clear();
+
+private:
+    void trimImages();
+
+    QVector<ZoomFrame> m_frames;
+    int m_index = -1;
+    int m_limit = 64;
+    qsizetype m_image_budget = qsizetype(128) * 1024 * 1024;
+};